@@ -2,6 +2,10 @@
 #include "glad/glad.h"
 #include <iostream>
 
+// size of the window (and of the headless render target)
+static const int WindowWidth = 800;
+static const int WindowHeight = 800;
+
 
 GLFWApplication::~GLFWApplication() = default;
 
@@ -11,17 +15,48 @@ GLFWApplication::GLFWApplication(const std::string& name, const std::string& ver
 }
 
 unsigned int GLFWApplication::Init() {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    // the null platform needs no display server; the context is created by OSMesa/EGL
+    // (or, for the software backend, not at all)
+    if (IsHeadless() || IsSoftware()) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+#else
+    if (IsHeadless() || IsSoftware()) {
+        std::cerr << "The headless and software backends require GLFW 3.4 or newer" << std::endl;
+        return EXIT_FAILURE;
+    }
+#endif
     // Initialize GLFW (Graphics Lbrary Framework)
     if (glfwInit() == GLFW_FALSE) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return EXIT_FAILURE;
     }
+
+    // the software renderer only needs the window for its size and events, no GL context
+    if (IsSoftware()) {
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(WindowWidth, WindowHeight, "Software Renderer", nullptr, nullptr);
+        if (!window) {
+            std::cerr << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return EXIT_FAILURE;
+        }
+        std::cout << "Software rendering on the CPU" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
     // GLFW window hints
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_SAMPLES, 16 );
-    // Create a GLFW window
-    window = glfwCreateWindow(800, 800, "OpenGL Application", nullptr, nullptr);
+    if (IsHeadless()) {
+        window = CreateHeadlessWindow();
+    }
+    else {
+        // Create a GLFW window
+        window = glfwCreateWindow(WindowWidth, WindowHeight, "OpenGL Application", nullptr, nullptr);
+    }
     if (!window) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -41,10 +76,83 @@ unsigned int GLFWApplication::Init() {
     // printing currently used openGL version
     std::cout << glGetString(GL_VERSION) << std::endl;
 
+    // the headless context has no visible framebuffer to present, so everything
+    // (Run() included) draws into an offscreen framebuffer object instead
+    if (IsHeadless()) {
+        std::cout << "Headless rendering on " << glGetString(GL_RENDERER) << std::endl;
+        if (!CreateRenderTarget()) {
+            glfwTerminate();
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
 
+GLFWwindow* GLFWApplication::CreateHeadlessWindow() {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    // Mesa only exposes OpenGL 4.3 through core profile contexts
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    // prefer OSMesa and fall back to a surfaceless EGL context
+    for (int contextApi : { GLFW_OSMESA_CONTEXT_API, GLFW_EGL_CONTEXT_API }) {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextApi);
+        GLFWwindow* headlessWindow = glfwCreateWindow(WindowWidth, WindowHeight, "OpenGL Application", nullptr, nullptr);
+        if (headlessWindow) {
+            return headlessWindow;
+        }
+    }
+#endif
+    std::cerr << "Failed to create an OSMesa or EGL context" << std::endl;
+    return nullptr;
+}
+
+bool GLFWApplication::CreateRenderTarget() {
+    glGenRenderbuffers(1, &renderTargetColor);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderTargetColor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WindowWidth, WindowHeight);
+
+    glGenRenderbuffers(1, &renderTargetDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderTargetDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, WindowWidth, WindowHeight);
+
+    glGenFramebuffers(1, &renderTarget);
+    glBindFramebuffer(GL_FRAMEBUFFER, renderTarget);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderTargetColor);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderTargetDepth);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Headless render target is incomplete" << std::endl;
+        return false;
+    }
+
+    // stays bound: the application renders into it as if it were the window
+    glViewport(0, 0, WindowWidth, WindowHeight);
+    return true;
+}
+
+bool GLFWApplication::ReadPixels(std::vector<unsigned char>& pixels) const {
+    if (!window || IsSoftware()) {
+        return false;
+    }
+    pixels.resize(static_cast<size_t>(WindowWidth) * WindowHeight * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, renderTarget);
+    if (!renderTarget) {
+        glReadBuffer(GL_BACK);
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, WindowWidth, WindowHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return glGetError() == GL_NO_ERROR;
+}
+
 unsigned int GLFWApplication::stop() {
+    if (renderTarget) {
+        glDeleteFramebuffers(1, &renderTarget);
+        glDeleteRenderbuffers(1, &renderTargetColor);
+        glDeleteRenderbuffers(1, &renderTargetDepth);
+        renderTarget = 0;
+    }
     glfwDestroyWindow(window);
     glfwTerminate();
 
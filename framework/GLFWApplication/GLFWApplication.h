@@ -7,6 +7,19 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+
+// Where the OpenGL context comes from.
+// Window: a visible GLFW window (single sampled; applications anti-alias in their own render targets).
+// Headless: an offscreen OSMesa (or EGL) context without a display, e.g. Mesa llvmpipe
+// on CI machines. Everything is rendered into a framebuffer object of the window size.
+// Software: no OpenGL context at all (GLFW_NO_API on the null platform); the application
+// draws with the CPU renderer of SoftwareRendering instead, e.g. on machines without a GPU.
+enum class ContextBackend {
+    Window,
+    Headless,
+    Software
+};
 
 class GLFWApplication
 {
@@ -31,6 +44,15 @@ public:
     //
     virtual unsigned stop();
 
+    // Select the context backend. Has to be called before Init().
+    void SetContextBackend(ContextBackend backend) { contextBackend = backend; }
+    bool IsHeadless() const { return contextBackend == ContextBackend::Headless; }
+    bool IsSoftware() const { return contextBackend == ContextBackend::Software; }
+
+    // Read the current frame (RGBA8, bottom row first) from the render target,
+    // e.g. to compare headless frames against reference images.
+    bool ReadPixels(std::vector<unsigned char>& pixels) const;
+
 protected:
     //...other functions...
     const std::string &name;
@@ -39,6 +61,16 @@ protected:
     GLuint program;
     unsigned width;
     unsigned height;
+
+    ContextBackend contextBackend = ContextBackend::Window;
+    // offscreen render target of the headless backend (0 = default framebuffer)
+    GLuint renderTarget = 0;
+    GLuint renderTargetColor = 0;
+    GLuint renderTargetDepth = 0;
+
+private:
+    GLFWwindow* CreateHeadlessWindow();
+    bool CreateRenderTarget();
 };
 
 
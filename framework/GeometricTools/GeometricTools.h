@@ -5,10 +5,11 @@
 #include <vector>
 #include <iostream>
 #include "../../external/glm/glm/ext/matrix_transform.hpp"
+#include "MeshGeneration.h"
 
 namespace GeometricTools {
 
-    std::vector<float> WarehouseGeometry(const unsigned int divisions) {
+    inline std::vector<float> WarehouseGeometry(const unsigned int divisions) {
         std::vector<float> vertices;
         int count = 0;
 
@@ -50,7 +51,7 @@ namespace GeometricTools {
         -0.5f, 0.5f, 0.0f, 0.0f, 1.0f
     };
 
-    auto UnitSquare2DDivider(const unsigned int divisions) {
+    inline auto UnitSquare2DDivider(const unsigned int divisions) {
         // Divide each value of UnitSquare2D by the value in divisions
         auto square = UnitSquare2D;
         std::vector<float> newSquare;
@@ -65,58 +66,25 @@ namespace GeometricTools {
     constexpr std::array<unsigned int, 6> TopologySquare2D = {0, 1, 2, 0, 2, 3}; // [6]
 
 
-    /* generate dynamic grid with 9 attributes: 3 positions, 4 colors, 2 texture coordinates */
-    auto UnitGridGeometry2DWTCoords(const unsigned int divisions) {
+    /* generate dynamic grid with 9 attributes: 3 positions, 4 colors, 2 texture coordinates
+       (the GridVertexPCT layout of MeshGeneration.h, flattened to floats); empty if divisions is 0 */
+    inline std::vector<float> UnitGridGeometry2DWTCoords(const unsigned int divisions) {
         std::vector<float> vertices;
-        int count = 0;
-        for (int i = 0; i <= divisions; ++i) {
-            float xPos = (i / static_cast<float>(divisions)) * 2 - 1.0f;
-            xPos = static_cast<float>(std::round(xPos * 100.0)) / 100.0f;
-            for (int j = 0; j <= divisions; ++j) {
-                float yPos = (j / static_cast<float>(divisions)) * 2 - 1.0f;
-                yPos = static_cast<float>(std::round(yPos * 100.0)) / 100.0f;
-                vertices.push_back(xPos);
-                vertices.push_back(yPos);
-                vertices.push_back(0.0f); // Set z-coordinate to 0 for a 2D grid
-                //put the color in rgba format
-                vertices.push_back(1.0);
-                vertices.push_back(1.0);
-                vertices.push_back(1.0);
-                vertices.push_back(1.0);
-                // texCoords
-                vertices.push_back((xPos + 1) / 2);
-                vertices.push_back((yPos + 1) / 2);
-                count++;
-                //std::cout << xPos << ", " << yPos << ", 1.0, 1.0, 1.0, 1.0, 1.0" << std::endl;
-            }
+        std::vector<GridVertexPCT> grid(GridVertexCount(divisions));
+        if (!GenerateGridVertices(divisions, grid.data(), grid.size())) {
+            return vertices;
         }
-        for (int i = 0; i <= divisions; ++i) {
-            float xPos = (i / static_cast<float>(divisions)) * 2 - 1.0f;
-            xPos = static_cast<float>(std::round(xPos * 100.0)) / 100.0f;
-            for (int j = 0; j <= divisions; ++j) {
-                float yPos = (j / static_cast<float>(divisions)) * 2 - 1.0f;
-                yPos = static_cast<float>(std::round(yPos * 100.0)) / 100.0f;
-                vertices.push_back(xPos);
-                vertices.push_back(yPos);
-                vertices.push_back(0.0f); // Set z-coordinate to 0 for a 2D grid
-                //put the color in rgba format
-                vertices.push_back(0.0);
-                vertices.push_back(0.0);
-                vertices.push_back(0.0);
-                vertices.push_back(1.0);
-                //texCoords
-                vertices.push_back((xPos + 1) / 2);
-                vertices.push_back((yPos + 1) / 2);
-                count++;
-                //std::cout << xPos << ", " << yPos << ", 1.0, 1.0, 1.0, 1.0, 1.0" << std::endl;
-            }
+        vertices.reserve(grid.size() * 9);
+        for (const GridVertexPCT& vertex : grid) {
+            vertices.insert(vertices.end(), std::begin(vertex.Position), std::end(vertex.Position));
+            vertices.insert(vertices.end(), std::begin(vertex.Color), std::end(vertex.Color));
+            vertices.insert(vertices.end(), std::begin(vertex.TexCoords), std::end(vertex.TexCoords));
         }
-        //convert grid to std array
         return vertices;
     }
 
 
-    auto UnitGrid2D(const unsigned int divisions) {
+    inline auto UnitGrid2D(const unsigned int divisions) {
         //Create a std vector of float with size of 3*divisions*divisions
         std::vector<float> vertices;
         for (int i = 0; i <= divisions; ++i) {
@@ -134,7 +102,7 @@ namespace GeometricTools {
 
     }
 
-    auto UnitGrid2DWithColor(const unsigned int divisions) {
+    inline auto UnitGrid2DWithColor(const unsigned int divisions) {
         std::vector<float> vertices;
         int count = 0;
         for (int i = 0; i <= divisions; ++i) {
@@ -173,42 +141,16 @@ namespace GeometricTools {
         return vertices;
     }
 
-    auto UnitGrid2DTopology(const unsigned int divisions) {
-
-        std::vector<unsigned int> indices;
-
-        // Generate indices for triangles that form the grid
-        bool isWhite;
-        int offset = (divisions + 1) * (divisions + 1);
-        for (unsigned int i = 0; i < divisions; i++) {
-            for (unsigned int j = 0; j < divisions; j++) {
-                //(divisions+1) * (divisions+1)
-                // Calculate the indices for the four vertices of each quad
-                isWhite = (i%2==j%2);
-
-                unsigned int topLeft = i * (divisions + 1) + j;
-                unsigned int topRight = topLeft + 1;
-                unsigned int bottomLeft = (i + 1) * (divisions + 1) + j;
-                unsigned int bottomRight = bottomLeft + 1;
-
-                // Define two triangles for each quad
-                // Triangle 1: top left -> top right -> bottom left
-                indices.push_back(topLeft+ (isWhite ? offset : 0));
-                indices.push_back(topRight+ (isWhite ? offset : 0));
-                indices.push_back(bottomLeft+ (isWhite ? offset : 0));
-
-                // Triangle 2: top right -> bottom right -> bottom left
-                indices.push_back(topRight+ (isWhite ? offset : 0));
-                indices.push_back(bottomRight+ (isWhite ? offset : 0));
-                indices.push_back(bottomLeft+ (isWhite ? offset : 0));
-                //std::cout << topLeft << " " << topRight << " " << bottomLeft << " " << topRight << " " << bottomRight << " " << bottomLeft << std::endl;
-            }
+    /* indices of UnitGridGeometry2DWTCoords, see GenerateGridTopology; empty if divisions is 0 */
+    inline std::vector<unsigned int> UnitGrid2DTopology(const unsigned int divisions) {
+        std::vector<unsigned int> indices(GridIndexCount(divisions));
+        if (!GenerateGridTopology(divisions, indices.data(), indices.size())) {
+            indices.clear();
         }
-
         return indices;
     }
 
-    auto UnitGrid2DTopologyLab4(const unsigned int divisions) {
+    inline auto UnitGrid2DTopologyLab4(const unsigned int divisions) {
 
         std::vector<unsigned int> indices;
 
@@ -281,90 +223,46 @@ namespace GeometricTools {
         30, 31, 32,  33, 34, 35
     };
 
-    /* rotating a cube that has 7 attributes (3 of which being positions) */
-    auto rotateCube(std::vector<float> cube, float angleX, float rotationAngleY, float rotationAngleZ) {
-
-        std::vector<float> newCube;
-
+    /* rotation about x, then y, then z (degrees) */
+    inline glm::mat4 rotationMatrixXYZ(float angleX, float angleY, float angleZ) {
         glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(angleX), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotationMatrix = glm::rotate(rotationMatrix, glm::radians(rotationAngleY), glm::vec3(0.0f, 1.0f, 0.0f));
-        rotationMatrix = glm::rotate(rotationMatrix, glm::radians(rotationAngleZ), glm::vec3(0.0f, 0.0f, 1.0f));
-
-        for (int i = 0; i < cube.size(); i+=7) {
-            glm::vec4 vertex = glm::vec4(cube[i], cube[i+1], cube[i+2], 1.0f);
-            vertex = rotationMatrix * vertex;
-            newCube.push_back(vertex.x);
-            newCube.push_back(vertex.y);
-            newCube.push_back(vertex.z);
-            newCube.push_back(cube[i+3]);
-            newCube.push_back(cube[i+4]);
-            newCube.push_back(cube[i+5]);
-            newCube.push_back(cube[i+6]);
+        rotationMatrix = glm::rotate(rotationMatrix, glm::radians(angleY), glm::vec3(0.0f, 1.0f, 0.0f));
+        return glm::rotate(rotationMatrix, glm::radians(angleZ), glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+
+    /* transform the positions (the first 3 of numberOfAttributes floats per vertex) in place;
+       for big meshes with a BufferLayout use the SIMD kernels of VertexStreams (Rendering) */
+    inline void transformPositions(std::vector<float>& vertices, const glm::mat4& matrix, unsigned int numberOfAttributes) {
+        for (size_t i = 0; i + 2 < vertices.size(); i += numberOfAttributes) {
+            glm::vec4 vertex = matrix * glm::vec4(vertices[i], vertices[i + 1], vertices[i + 2], 1.0f);
+            vertices[i] = vertex.x;
+            vertices[i + 1] = vertex.y;
+            vertices[i + 2] = vertex.z;
         }
+    }
 
-        return newCube;
+    /* rotating a cube that has 7 attributes (3 of which being positions) */
+    inline auto rotateCube(std::vector<float> cube, float angleX, float rotationAngleY, float rotationAngleZ) {
+        transformPositions(cube, rotationMatrixXYZ(angleX, rotationAngleY, rotationAngleZ), 7);
+        return cube;
     }
 
     /* rotate a cube (number of attributes not hardcoded) */
-    auto rotateCubeGeneric(std::vector<float> cube, float angleX, float rotationAngleY, float rotationAngleZ, unsigned int numberOfAttributes) {
-
-        std::vector<float> newCube;
-
-        glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(angleX), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotationMatrix = glm::rotate(rotationMatrix, glm::radians(rotationAngleY), glm::vec3(0.0f, 1.0f, 0.0f));
-        rotationMatrix = glm::rotate(rotationMatrix, glm::radians(rotationAngleZ), glm::vec3(0.0f, 0.0f, 1.0f));
-
-        for (int i = 0; i < cube.size(); i += numberOfAttributes) {
-            glm::vec4 vertex = glm::vec4(cube[i], cube[i + 1], cube[i + 2], 1.0f);
-            vertex = rotationMatrix * vertex;
-            newCube.push_back(vertex.x); // attribute position 0
-            newCube.push_back(vertex.y); // attribute position 1
-            newCube.push_back(vertex.z); // attribute position 2
-            unsigned int attributePosition = 3;
-            while (attributePosition < numberOfAttributes) {
-                newCube.push_back(cube[i + attributePosition]);
-                attributePosition += 1;
-            }
-        }
-
-        return newCube;
+    inline auto rotateCubeGeneric(std::vector<float> cube, float angleX, float rotationAngleY, float rotationAngleZ, unsigned int numberOfAttributes) {
+        transformPositions(cube, rotationMatrixXYZ(angleX, rotationAngleY, rotationAngleZ), numberOfAttributes);
+        return cube;
     }
 
     /* translate a cube that has 7 attributes (3 of which being positions) */
-    std::vector<float> translateCube(std::vector<float> cube, float x, float y, float z) {
-        glm::mat4 translationMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z));
-        std::vector<float> newCube;
-        for (int i = 0; i < cube.size(); i+=7) {
-            glm::vec4 vertex = glm::vec4(cube[i], cube[i+1], cube[i+2], 1.0f);
-            vertex = translationMatrix * vertex;
-            newCube.push_back(vertex.x);
-            newCube.push_back(vertex.y);
-            newCube.push_back(vertex.z);
-            newCube.push_back(cube[i+3]);
-            newCube.push_back(cube[i+4]);
-            newCube.push_back(cube[i+5]);
-            newCube.push_back(cube[i+6]);
-        }
-        return newCube;
+    inline std::vector<float> translateCube(std::vector<float> cube, float x, float y, float z) {
+        transformPositions(cube, glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z)), 7);
+        return cube;
     }
 
     /* translate a cube (number of attributes not hardcoded) */
-    std::vector<float> translateCubeGeneric(std::vector<float> cube, float x, float y, float z, unsigned int numberOfAttributes) {
-        glm::mat4 translationMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z));
-        std::vector<float> newCube;
-        for (int i = 0; i < cube.size(); i += numberOfAttributes) {
-            glm::vec4 vertex = glm::vec4(cube[i], cube[i + 1], cube[i + 2], 1.0f);
-            vertex = translationMatrix * vertex;
-            newCube.push_back(vertex.x);
-            newCube.push_back(vertex.y);
-            newCube.push_back(vertex.z);
-            unsigned int attributePosition = 3;
-            while (attributePosition < numberOfAttributes) { 
-                newCube.push_back(cube[i + attributePosition]); 
-                attributePosition += 1; 
-            }
-        }
-        return newCube;
+    inline std::vector<float> translateCubeGeneric(std::vector<float> cube, float x, float y, float z, unsigned int numberOfAttributes) {
+        transformPositions(cube, glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z)), numberOfAttributes);
+        return cube;
     }
 }
 
@@ -0,0 +1,219 @@
+#ifndef PROG2002_MESHGENERATION_H
+#define PROG2002_MESHGENERATION_H
+
+#include "VertexQuantization.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+/*
+ * Allocation free generation of the checkerboard grid, templated on the vertex layout.
+ *
+ *   fixed size:   constexpr auto vertices = GridVertices<GridVertexPCT, 10>();
+ *                 constexpr auto indices = GridTopology<unsigned short, 10>();
+ *   runtime size: GenerateGridVertices(divisions, vertices, GridVertexCount(divisions));
+ *                 GenerateGridTopology(divisions, indices, GridIndexCount(divisions));
+ *
+ * The grid has (divisions + 1)^2 white vertices followed by the same lattice in black;
+ * each quad uses one of the two copies, alternating like a checkerboard. Positions
+ * span [-1, 1] in x and y (z = 0), texture coordinates [0, 1].
+ *
+ * The runtime versions write into caller supplied memory and split large grids into
+ * chunks of lattice columns that are filled on separate threads.
+ */
+namespace GeometricTools {
+
+    // everything a vertex layout can take from a grid vertex
+    struct GridPoint {
+        float x, y, z;
+        float shade; // 1 = white, 0 = black (alpha is always 1)
+        float u, v;
+    };
+
+    // 9 floats: 3 positions, 4 colors, 2 texture coordinates (the layout of UnitGridGeometry2DWTCoords)
+    struct GridVertexPCT {
+        float Position[3];
+        float Color[4];
+        float TexCoords[2];
+    };
+    static_assert(sizeof(GridVertexPCT) == 9 * sizeof(float), "GridVertexPCT must be tightly packed");
+
+    // Builds a Vertex from a GridPoint; specialised for every layout the grid can be generated in.
+    template<typename Vertex>
+    struct GridVertexTraits;
+
+    template<>
+    struct GridVertexTraits<GridVertexPCT> {
+        static constexpr GridVertexPCT Make(const GridPoint& point) {
+            return { { point.x, point.y, point.z }, { point.shade, point.shade, point.shade, 1.0f }, { point.u, point.v } };
+        }
+    };
+
+    // quantized directly, without the float mesh in between (not usable at compile time)
+    template<>
+    struct GridVertexTraits<CompactVertexPCT> {
+        static CompactVertexPCT Make(const GridPoint& point) {
+            uint8_t shade = PackUNorm8(point.shade);
+            return { { FloatToHalf(point.x), FloatToHalf(point.y), FloatToHalf(point.z), FloatToHalf(1.0f) },
+                     { shade, shade, shade, 255 },
+                     { FloatToHalf(point.u), FloatToHalf(point.v) } };
+        }
+    };
+
+    constexpr size_t GridVertexCount(unsigned int divisions) {
+        return 2 * static_cast<size_t>(divisions + 1) * (divisions + 1);
+    }
+
+    constexpr size_t GridIndexCount(unsigned int divisions) {
+        return 6 * static_cast<size_t>(divisions) * divisions;
+    }
+
+    namespace Detail {
+        // below this many vertices (or indices) a grid is filled on the calling thread
+        constexpr size_t ParallelGridMinElements = size_t(1) << 20;
+
+        // Vertices of the lattice columns [firstColumn, endColumn) of both copies.
+        // (2 * i - divisions) / divisions is exact up to the final rounding, so the
+        // coordinates of a 10x10 grid are the nearest floats of -1.0, -0.8, ..., 1.0.
+        template<typename Vertex>
+        constexpr void WriteGridColumns(unsigned int divisions, Vertex* vertices, unsigned int firstColumn, unsigned int endColumn) {
+            const size_t latticeSize = static_cast<size_t>(divisions + 1) * (divisions + 1);
+            const float size = static_cast<float>(divisions);
+            for (unsigned int i = firstColumn; i < endColumn; ++i) {
+                float x = static_cast<float>(2 * static_cast<int64_t>(i) - divisions) / size;
+                float u = static_cast<float>(i) / size;
+                for (unsigned int j = 0; j <= divisions; ++j) {
+                    float y = static_cast<float>(2 * static_cast<int64_t>(j) - divisions) / size;
+                    float v = static_cast<float>(j) / size;
+                    size_t vertex = static_cast<size_t>(i) * (divisions + 1) + j;
+                    vertices[vertex] = GridVertexTraits<Vertex>::Make({ x, y, 0.0f, 1.0f, u, v });
+                    vertices[latticeSize + vertex] = GridVertexTraits<Vertex>::Make({ x, y, 0.0f, 0.0f, u, v });
+                }
+            }
+        }
+
+        // two triangles per quad of the columns [firstColumn, endColumn)
+        template<typename Index>
+        constexpr void WriteGridTopologyColumns(unsigned int divisions, Index* indices, unsigned int firstColumn, unsigned int endColumn) {
+            const size_t latticeSize = static_cast<size_t>(divisions + 1) * (divisions + 1);
+            size_t index = static_cast<size_t>(firstColumn) * divisions * 6;
+            for (unsigned int i = firstColumn; i < endColumn; ++i) {
+                for (unsigned int j = 0; j < divisions; ++j) {
+                    // quads with i and j of the same parity use the black copy
+                    size_t offset = (i % 2 == j % 2) ? latticeSize : 0;
+                    size_t topLeft = static_cast<size_t>(i) * (divisions + 1) + j + offset;
+                    size_t topRight = topLeft + 1;
+                    size_t bottomLeft = topLeft + divisions + 1;
+                    size_t bottomRight = bottomLeft + 1;
+
+                    // Triangle 1: top left -> top right -> bottom left
+                    indices[index++] = static_cast<Index>(topLeft);
+                    indices[index++] = static_cast<Index>(topRight);
+                    indices[index++] = static_cast<Index>(bottomLeft);
+                    // Triangle 2: top right -> bottom right -> bottom left
+                    indices[index++] = static_cast<Index>(topRight);
+                    indices[index++] = static_cast<Index>(bottomRight);
+                    indices[index++] = static_cast<Index>(bottomLeft);
+                }
+            }
+        }
+
+        // run write(firstColumn, endColumn) over columns [0, columns), in parallel chunks if elements is large
+        template<typename Write>
+        void ForEachColumnChunk(unsigned int columns, size_t elements, Write write) {
+            size_t chunks = std::min<size_t>({ std::max(1u, std::thread::hardware_concurrency()), columns, elements / ParallelGridMinElements });
+            if (chunks <= 1) {
+                write(0u, columns);
+                return;
+            }
+            unsigned int columnsPerChunk = static_cast<unsigned int>((columns + chunks - 1) / chunks);
+            std::vector<std::future<void>> workers;
+            for (unsigned int first = columnsPerChunk; first < columns; first += columnsPerChunk) {
+                workers.push_back(std::async(std::launch::async, write, first, std::min(columns, first + columnsPerChunk)));
+            }
+            write(0u, std::min(columns, columnsPerChunk));
+            for (std::future<void>& worker : workers) {
+                worker.get();
+            }
+        }
+    }
+
+    /* grid vertices into vertices[0, GridVertexCount(divisions)); false if capacity is too small */
+    template<typename Vertex>
+    bool GenerateGridVertices(unsigned int divisions, Vertex* vertices, size_t capacity) {
+        if (divisions == 0 || capacity < GridVertexCount(divisions)) {
+            std::cerr << "Grid of " << divisions << " divisions needs room for " << GridVertexCount(divisions) << " vertices" << std::endl;
+            return false;
+        }
+        Detail::ForEachColumnChunk(divisions + 1, GridVertexCount(divisions), [=](unsigned int first, unsigned int end) {
+            Detail::WriteGridColumns(divisions, vertices, first, end);
+        });
+        return true;
+    }
+
+    /* grid indices into indices[0, GridIndexCount(divisions)); false if capacity is too small
+       or the vertices cannot be addressed with Index */
+    template<typename Index>
+    bool GenerateGridTopology(unsigned int divisions, Index* indices, size_t capacity) {
+        if (divisions == 0 || capacity < GridIndexCount(divisions)) {
+            std::cerr << "Grid of " << divisions << " divisions needs room for " << GridIndexCount(divisions) << " indices" << std::endl;
+            return false;
+        }
+        if (GridVertexCount(divisions) - 1 > std::numeric_limits<Index>::max()) {
+            std::cerr << "Grid of " << divisions << " divisions has too many vertices for " << sizeof(Index) << " byte indices" << std::endl;
+            return false;
+        }
+        Detail::ForEachColumnChunk(divisions, GridIndexCount(divisions), [=](unsigned int first, unsigned int end) {
+            Detail::WriteGridTopologyColumns(divisions, indices, first, end);
+        });
+        return true;
+    }
+
+    /* grid vertices of a fixed size, computed at compile time when used in a constant expression */
+    template<typename Vertex, unsigned int Divisions>
+    constexpr std::array<Vertex, GridVertexCount(Divisions)> GridVertices() {
+        static_assert(Divisions > 0, "a grid needs at least one division");
+        std::array<Vertex, GridVertexCount(Divisions)> vertices{};
+        Detail::WriteGridColumns(Divisions, vertices.data(), 0, Divisions + 1);
+        return vertices;
+    }
+
+    /* grid indices of a fixed size, computed at compile time when used in a constant expression */
+    template<typename Index, unsigned int Divisions>
+    constexpr std::array<Index, GridIndexCount(Divisions)> GridTopology() {
+        static_assert(Divisions > 0, "a grid needs at least one division");
+        static_assert(GridVertexCount(Divisions) - 1 <= std::numeric_limits<Index>::max(), "Index cannot address all grid vertices");
+        std::array<Index, GridIndexCount(Divisions)> indices{};
+        Detail::WriteGridTopologyColumns(Divisions, indices.data(), 0, Divisions);
+        return indices;
+    }
+
+    // the fixed size versions really are evaluated by the compiler: a 2x2 grid
+    namespace Detail {
+        constexpr auto SmallGridVertices = GridVertices<GridVertexPCT, 2>();
+        static_assert(SmallGridVertices.size() == 18, "2 x 3 x 3 grid vertices");
+        static_assert(SmallGridVertices[0].Position[0] == -1.0f && SmallGridVertices[0].Position[1] == -1.0f
+                      && SmallGridVertices[0].Color[0] == 1.0f, "the first vertex is the white corner at (-1, -1)");
+        static_assert(SmallGridVertices[9 + 4].Position[0] == 0.0f && SmallGridVertices[9 + 4].TexCoords[1] == 0.5f
+                      && SmallGridVertices[9 + 4].Color[0] == 0.0f, "the black copy follows the white one");
+
+        constexpr auto SmallGridTopology = GridTopology<unsigned short, 2>();
+        static_assert(SmallGridTopology.size() == 24, "2 triangles for each of the 2 x 2 quads");
+        static_assert(SmallGridTopology[0] == 9 && SmallGridTopology[1] == 10 && SmallGridTopology[2] == 12
+                      && SmallGridTopology[3] == 10 && SmallGridTopology[4] == 13 && SmallGridTopology[5] == 12,
+                      "the first quad uses the black copy");
+        static_assert(SmallGridTopology[6] == 1 && SmallGridTopology[7] == 2 && SmallGridTopology[8] == 4,
+                      "its neighbours use the white copy");
+        static_assert(SmallGridTopology[18] == 13 && SmallGridTopology[22] == 17 && SmallGridTopology[23] == 16,
+                      "the opposite corner is black again");
+    }
+}
+
+#endif //PROG2002_MESHGENERATION_H
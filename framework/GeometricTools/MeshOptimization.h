@@ -0,0 +1,201 @@
+#ifndef PROG2002_MESHOPTIMIZATION_H
+#define PROG2002_MESHOPTIMIZATION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Preparation of indexed triangle meshes for the GPU, in this order:
+ *
+ *   WeldVertices         one vertex per distinct value, an index per triangle corner
+ *   OptimizeVertexCache  triangle order that reuses recently transformed vertices (Tipsify)
+ *   OptimizeVertexFetch  vertices in the order the triangles first use them
+ *
+ * AverageCacheMissRatio measures the effect of the second step: transformed vertices
+ * per triangle with a FIFO post-transform cache (3 without any reuse, 0.5 at best).
+ */
+namespace GeometricTools {
+
+    // post-transform cache size assumed by OptimizeVertexCache and AverageCacheMissRatio
+    constexpr unsigned int DefaultVertexCacheSize = 16;
+
+    namespace Detail {
+        // 64-bit FNV-1a over the bytes of a vertex
+        inline uint64_t HashBytes(const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    }
+
+    /*
+     * Weld bit-identical vertices: corners holds one vertex per triangle corner, vertices
+     * receives each distinct vertex once (in order of first appearance) and indices one
+     * index per corner. Vertices are compared bytewise, so weld after quantization to merge
+     * corners that only differ below the precision of the vertex format.
+     */
+    template<typename Vertex>
+    void WeldVertices(const Vertex* corners, size_t cornerCount, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+        static_assert(std::has_unique_object_representations<Vertex>::value,
+                      "vertices are hashed and compared bytewise and must not contain padding");
+        vertices.clear();
+        indices.resize(cornerCount);
+
+        // open addressing with linear probing, at most half full; slots hold vertex index + 1
+        size_t tableSize = 16;
+        while (tableSize < 2 * cornerCount) tableSize *= 2;
+        std::vector<uint32_t> table(tableSize, 0);
+
+        for (size_t corner = 0; corner < cornerCount; ++corner) {
+            const Vertex& vertex = corners[corner];
+            size_t slot = static_cast<size_t>(Detail::HashBytes(&vertex, sizeof(Vertex))) & (tableSize - 1);
+            while (table[slot] != 0 && std::memcmp(&vertices[table[slot] - 1], &vertex, sizeof(Vertex)) != 0) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (table[slot] == 0) {
+                vertices.push_back(vertex);
+                table[slot] = static_cast<uint32_t>(vertices.size());
+            }
+            indices[corner] = table[slot] - 1;
+        }
+    }
+
+    /*
+     * Reorder the triangles of indices (in place) for the post-transform vertex cache with
+     * Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and
+     * Reduced Overdraw", 2007): fans of triangles are emitted around one vertex at a time and
+     * the next fan vertex is chosen among the ones still in the cache. Linear in the mesh size.
+     */
+    inline void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                    unsigned int cacheSize = DefaultVertexCacheSize) {
+        size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        // triangles around each vertex: adjacency[adjacencyStart[v], adjacencyStart[v + 1])
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            liveTriangles[indices[i]]++;
+        }
+        std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            adjacencyStart[v + 1] = adjacencyStart[v] + liveTriangles[v];
+        }
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int corner = 0; corner < 3; ++corner) {
+                adjacency[fill[indices[t * 3 + corner]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        // a vertex is in the cache while timestamp - cacheTime[v] <= cacheSize
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t timestamp = cacheSize + 1;
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnd;  // recently used vertices, to continue from when a fan runs dry
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve(triangleCount * 3);
+        size_t cursor = 0;              // vertices before it have no live triangles left
+
+        int64_t fan = indices[0];
+        while (fan >= 0) {
+            candidates.clear();
+            for (uint32_t a = adjacencyStart[fan]; a < adjacencyStart[fan + 1]; ++a) {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) continue;
+                emitted[t] = true;
+                for (int corner = 0; corner < 3; ++corner) {
+                    uint32_t v = indices[t * 3 + corner];
+                    output.push_back(v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    liveTriangles[v]--;
+                    if (timestamp - cacheTime[v] > cacheSize) {
+                        cacheTime[v] = timestamp++;
+                    }
+                }
+            }
+
+            // the candidate that stays in the cache while its remaining fan is emitted, oldest first
+            fan = -1;
+            int64_t best = -1;
+            for (uint32_t v : candidates) {
+                if (liveTriangles[v] == 0) continue;
+                int64_t priority = 0;
+                if (timestamp - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) {
+                    priority = timestamp - cacheTime[v];
+                }
+                if (priority > best) {
+                    best = priority;
+                    fan = v;
+                }
+            }
+            if (fan < 0) {
+                while (!deadEnd.empty() && fan < 0) {
+                    uint32_t v = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (liveTriangles[v] > 0) fan = v;
+                }
+                for (; fan < 0 && cursor < vertexCount; ++cursor) {
+                    if (liveTriangles[cursor] > 0) fan = static_cast<int64_t>(cursor);
+                }
+            }
+        }
+        std::memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+    }
+
+    /*
+     * Renumber the vertices in the order the indices first reference them and move them
+     * accordingly, so the vertex fetches of consecutive triangles stay close in memory.
+     * Vertices that no triangle uses are dropped. Returns the new vertex count.
+     */
+    template<typename Vertex>
+    size_t OptimizeVertexFetch(Vertex* vertices, size_t vertexCount, uint32_t* indices, size_t indexCount) {
+        constexpr uint32_t Unused = ~0u;
+        std::vector<uint32_t> remap(vertexCount, Unused);
+        std::vector<Vertex> reordered;
+        reordered.reserve(vertexCount);
+        for (size_t i = 0; i < indexCount; ++i) {
+            uint32_t& target = remap[indices[i]];
+            if (target == Unused) {
+                target = static_cast<uint32_t>(reordered.size());
+                reordered.push_back(vertices[indices[i]]);
+            }
+            indices[i] = target;
+        }
+        std::copy(reordered.begin(), reordered.end(), vertices);
+        return reordered.size();
+    }
+
+    // vertices transformed per triangle with a FIFO post-transform cache of cacheSize entries
+    inline float AverageCacheMissRatio(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                       unsigned int cacheSize = DefaultVertexCacheSize) {
+        if (indexCount < 3) {
+            return 0.0f;
+        }
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t timestamp = cacheSize + 1;
+        size_t misses = 0;
+        for (size_t i = 0; i < indexCount; ++i) {
+            uint32_t v = indices[i];
+            if (timestamp - cacheTime[v] > cacheSize) {
+                cacheTime[v] = timestamp++;
+                misses++;
+            }
+        }
+        return static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+    }
+}
+
+#endif //PROG2002_MESHOPTIMIZATION_H
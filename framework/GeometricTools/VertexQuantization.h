@@ -0,0 +1,150 @@
+#ifndef PROG2002_VERTEXQUANTIZATION_H
+#define PROG2002_VERTEXQUANTIZATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+/*
+ * Converters from the float meshes produced by GeometricTools into compact
+ * vertex formats. The matching BufferLayouts are:
+ *
+ *   CompactVertexPN  : {Half4 "position"}, {Int2101010Rev "normal", true}
+ *   CompactVertexPCT : {Half4 "position"}, {UByte4 "color", true}, {Half2 "texCoords"}
+ *
+ * Positions are stored as four halves (w = 1) to keep every attribute 4-byte aligned.
+ */
+namespace GeometricTools {
+
+    // 12 bytes instead of the 24 bytes of a position + normal float vertex
+    struct CompactVertexPN {
+        uint16_t Position[4];
+        uint32_t Normal;
+    };
+
+    // 16 bytes instead of the 36 bytes of a position + color + texCoords float vertex
+    struct CompactVertexPCT {
+        uint16_t Position[4];
+        uint8_t Color[4];
+        uint16_t TexCoords[2];
+    };
+
+    static_assert(sizeof(CompactVertexPN) == 12, "CompactVertexPN must be tightly packed");
+    static_assert(sizeof(CompactVertexPCT) == 16, "CompactVertexPCT must be tightly packed");
+
+    /* IEEE 754 single to half precision, rounding to nearest even */
+    inline uint16_t FloatToHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        uint32_t rawExponent = (bits >> 23) & 0xFFu;
+        uint32_t mantissa = bits & 0x7FFFFFu;
+
+        // infinity and NaN
+        if (rawExponent == 0xFFu) {
+            return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+        }
+
+        int32_t exponent = static_cast<int32_t>(rawExponent) - 127 + 15;
+        // too large for a half: clamp to infinity
+        if (exponent >= 31) {
+            return static_cast<uint16_t>(sign | 0x7C00u);
+        }
+        // subnormal half (or zero)
+        if (exponent <= 0) {
+            if (exponent < -10) {
+                return static_cast<uint16_t>(sign);
+            }
+            mantissa |= 0x800000u;
+            uint32_t shift = static_cast<uint32_t>(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1u);
+            uint32_t halfway = 1u << (shift - 1u);
+            if (remainder > halfway || (remainder == halfway && (half & 1u))) half++;
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1FFFu;
+        // a carry out of the mantissa correctly bumps the exponent
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) half++;
+        return static_cast<uint16_t>(half);
+    }
+
+    /* pack a (unit) vector into GL_INT_2_10_10_10_REV, to be read back as a normalized attribute */
+    inline uint32_t PackInt2101010Rev(float x, float y, float z, float w = 0.0f) {
+        auto pack = [](float value, float scale, uint32_t mask) {
+            int32_t quantized = static_cast<int32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * scale));
+            return static_cast<uint32_t>(quantized) & mask;
+        };
+        return pack(x, 511.0f, 0x3FFu)
+             | (pack(y, 511.0f, 0x3FFu) << 10)
+             | (pack(z, 511.0f, 0x3FFu) << 20)
+             | (pack(w, 1.0f, 0x3u) << 30);
+    }
+
+    /* quantize a [0,1] channel to an 8-bit normalized value */
+    inline uint8_t PackUNorm8(float value) {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    /* quantize a cube with 6 attributes (3 positions, 3 normals), e.g. unitCubeGeometry() */
+    inline std::vector<CompactVertexPN> QuantizePositionNormal(const std::vector<float>& vertices) {
+        std::vector<CompactVertexPN> compact(vertices.size() / 6);
+        for (size_t v = 0; v < compact.size(); ++v) {
+            const float* src = &vertices[v * 6];
+            CompactVertexPN& dst = compact[v];
+            dst.Position[0] = FloatToHalf(src[0]);
+            dst.Position[1] = FloatToHalf(src[1]);
+            dst.Position[2] = FloatToHalf(src[2]);
+            dst.Position[3] = FloatToHalf(1.0f);
+            dst.Normal = PackInt2101010Rev(src[3], src[4], src[5]);
+        }
+        return compact;
+    }
+
+    /* quantize a grid with 9 attributes (3 positions, 4 colors, 2 texture coordinates), e.g. UnitGridGeometry2DWTCoords() */
+    inline std::vector<CompactVertexPCT> QuantizePositionColorTexCoords(const std::vector<float>& vertices) {
+        std::vector<CompactVertexPCT> compact(vertices.size() / 9);
+        for (size_t v = 0; v < compact.size(); ++v) {
+            const float* src = &vertices[v * 9];
+            CompactVertexPCT& dst = compact[v];
+            dst.Position[0] = FloatToHalf(src[0]);
+            dst.Position[1] = FloatToHalf(src[1]);
+            dst.Position[2] = FloatToHalf(src[2]);
+            dst.Position[3] = FloatToHalf(1.0f);
+            for (int c = 0; c < 4; ++c) {
+                dst.Color[c] = PackUNorm8(src[3 + c]);
+            }
+            dst.TexCoords[0] = FloatToHalf(src[7]);
+            dst.TexCoords[1] = FloatToHalf(src[8]);
+        }
+        return compact;
+    }
+
+    /* true if every index of the topology fits into IndexType */
+    template<typename IndexType, typename Container>
+    bool IndicesFitIn(const Container& indices) {
+        for (auto index : indices) {
+            if (index > std::numeric_limits<IndexType>::max()) return false;
+        }
+        return true;
+    }
+
+    /* narrow a 32-bit topology to 16 or 8 bit indices. Check IndicesFitIn first. */
+    template<typename IndexType, typename Container>
+    std::vector<IndexType> NarrowIndices(const Container& indices) {
+        std::vector<IndexType> narrowed;
+        narrowed.reserve(indices.size());
+        for (auto index : indices) {
+            narrowed.push_back(static_cast<IndexType>(index));
+        }
+        return narrowed;
+    }
+}
+
+#endif //PROG2002_VERTEXQUANTIZATION_H
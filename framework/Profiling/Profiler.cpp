@@ -0,0 +1,284 @@
+#include "Profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        uint64_t start;    // ns since the profiler epoch
+        uint64_t duration; // ns
+    };
+
+    // The fields of an event, stored atomically so the trace can be read while the
+    // owning thread records (relaxed: the order is given by the counters of the buffer).
+    struct EventSlot
+    {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<uint64_t> start{ 0 };
+        std::atomic<uint64_t> duration{ 0 };
+    };
+
+    // Single producer ring buffer: only the owning thread pushes, the writer of the
+    // trace reads a snapshot. Old events are overwritten once it is full.
+    //
+    // Push() claims an event before it overwrites the slot and publishes it once it is
+    // written, so the reader copies the published events and then drops those that
+    // were claimed again while it copied (see Snapshot()).
+    struct ThreadBuffer
+    {
+        static constexpr uint64_t Capacity = 1u << 16;
+
+        std::vector<EventSlot> events = std::vector<EventSlot>(Capacity);
+        std::atomic<uint64_t> claimed{ 0 };
+        std::atomic<uint64_t> written{ 0 };
+        uint32_t id = 0;
+        std::string name;
+
+        void Push(const Event& event)
+        {
+            uint64_t count = written.load(std::memory_order_relaxed);
+            claimed.store(count + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            EventSlot& slot = events[count & (Capacity - 1)];
+            slot.name.store(event.name, std::memory_order_relaxed);
+            slot.start.store(event.start, std::memory_order_relaxed);
+            slot.duration.store(event.duration, std::memory_order_relaxed);
+            written.store(count + 1, std::memory_order_release);
+        }
+
+        // the newest events that were complete and not overwritten while they were copied
+        std::vector<Event> Snapshot() const
+        {
+            uint64_t end = written.load(std::memory_order_acquire);
+            uint64_t begin = end > Capacity ? end - Capacity : 0;
+            std::vector<Event> copy;
+            copy.reserve(static_cast<size_t>(end - begin));
+            for (uint64_t i = begin; i < end; ++i) {
+                const EventSlot& slot = events[i & (Capacity - 1)];
+                copy.push_back({ slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                                 slot.duration.load(std::memory_order_relaxed) });
+            }
+            // a slot read above that holds a newer event was claimed before it was written,
+            // so the claim is seen here and the event is dropped
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t claimedAfter = claimed.load(std::memory_order_relaxed);
+            uint64_t valid = claimedAfter > Capacity ? claimedAfter - Capacity : 0;
+            size_t skip = valid > begin ? static_cast<size_t>(std::min<uint64_t>(valid - begin, copy.size())) : 0;
+            copy.erase(copy.begin(), copy.begin() + static_cast<std::ptrdiff_t>(skip));
+            return copy;
+        }
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    };
+
+    Registry& GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    std::shared_ptr<ThreadBuffer> RegisterBuffer(const std::string& name)
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->id = static_cast<uint32_t>(registry.buffers.size() + 1);
+        buffer->name = name.empty() ? "Thread " + std::to_string(buffer->id) : name;
+        registry.buffers.push_back(buffer);
+        return buffer;
+    }
+
+    // The buffer stays registered (and readable) after its thread exits.
+    ThreadBuffer& LocalBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = RegisterBuffer("");
+        return *buffer;
+    }
+
+    uint64_t Now()
+    {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    // Two query pools: one records the current frame while the other, recorded a frame
+    // earlier, is read back. Each zone uses a begin and an end GL_TIMESTAMP query.
+    struct GpuFrame
+    {
+        std::vector<GLuint> queries;
+        std::vector<const char*> names;
+        size_t count = 0;
+        GLuint lastQuery = 0; // issued last; nested zones end after the zones begun inside them
+    };
+
+    struct GpuState
+    {
+        GpuFrame frames[2];
+        int current = 0;
+        bool calibrated = false;
+        int64_t offset = 0; // CPU epoch time - GPU timestamp
+        std::atomic<uint64_t> dropped{ 0 }; // read by the writer of the trace
+        std::shared_ptr<ThreadBuffer> track;
+    };
+
+    GpuState& GpuStateInstance()
+    {
+        static GpuState state;
+        return state;
+    }
+
+    // GL thread only
+    GpuState& GetGpuState()
+    {
+        GpuState& state = GpuStateInstance();
+        if (!state.calibrated) {
+            // a one time synchronous query to map GPU timestamps onto the CPU timeline
+            GLint64 gpuNow = 0;
+            glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+            state.offset = static_cast<int64_t>(Now()) - static_cast<int64_t>(gpuNow);
+            state.track = RegisterBuffer("GPU");
+            state.calibrated = true;
+        }
+        return state;
+    }
+
+    void Resolve(GpuState& state, GpuFrame& frame)
+    {
+        if (frame.count == 0) {
+            return;
+        }
+        // the last issued query finishes last: if it is not available the frame is dropped
+        // rather than waiting for the GPU
+        GLint available = 0;
+        glGetQueryObjectiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            state.dropped += frame.count;
+            return;
+        }
+        for (size_t zone = 0; zone < frame.count; ++zone) {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(frame.queries[2 * zone], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(frame.queries[2 * zone + 1], GL_QUERY_RESULT, &end);
+            int64_t start = static_cast<int64_t>(begin) + state.offset;
+            state.track->Push({ frame.names[zone], static_cast<uint64_t>(start > 0 ? start : 0),
+                                end > begin ? end - begin : 0 });
+        }
+    }
+
+    void WriteEscaped(std::ofstream& file, const std::string& text)
+    {
+        for (char c : text) {
+            if (c == '"' || c == '\\') file << '\\';
+            file << c;
+        }
+    }
+}
+
+Profiler::CpuZone::CpuZone(const char* name) : Name(name), Start(Now())
+{
+}
+
+Profiler::CpuZone::~CpuZone()
+{
+    LocalBuffer().Push({ this->Name, this->Start, Now() - this->Start });
+}
+
+Profiler::GpuZone::GpuZone(const char* name)
+{
+    GpuState& state = GetGpuState();
+    GpuFrame& frame = state.frames[state.current];
+    this->Index = frame.count++;
+    if (frame.queries.size() < 2 * frame.count) {
+        frame.queries.resize(2 * frame.count);
+        frame.names.resize(frame.count);
+        glGenQueries(2, &frame.queries[2 * this->Index]);
+    }
+    frame.names[this->Index] = name;
+    frame.lastQuery = frame.queries[2 * this->Index];
+    glQueryCounter(frame.lastQuery, GL_TIMESTAMP);
+}
+
+Profiler::GpuZone::~GpuZone()
+{
+    GpuState& state = GetGpuState();
+    GpuFrame& frame = state.frames[state.current];
+    frame.lastQuery = frame.queries[2 * this->Index + 1];
+    glQueryCounter(frame.lastQuery, GL_TIMESTAMP);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    ThreadBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+    buffer.name = name;
+}
+
+void Profiler::EndFrame()
+{
+    GpuState& state = GetGpuState();
+    int next = 1 - state.current;
+    Resolve(state, state.frames[next]);
+    state.frames[next].count = 0;
+    state.current = next;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filePath)
+{
+    std::ofstream file(filePath);
+    if (!file) {
+        std::cerr << "Failed to write profiler trace " << filePath << std::endl;
+        return false;
+    }
+
+    Registry& registry = GetRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buffer : registry.buffers) {
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+             << ",\"args\":{\"name\":\"";
+        WriteEscaped(file, buffer->name);
+        file << "\"}}";
+        first = false;
+
+        for (const Event& event : buffer->Snapshot()) {
+            file << ",\n{\"name\":\"";
+            WriteEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                 << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+                 << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0 << "}";
+        }
+    }
+    file << "\n]}\n";
+    lock.unlock();
+
+    uint64_t dropped = GpuStateInstance().dropped.load();
+    if (dropped > 0) {
+        std::cout << "Profiler: " << dropped << " GPU zones were not ready in time and were dropped" << std::endl;
+    }
+    return static_cast<bool>(file);
+}
+
+#endif
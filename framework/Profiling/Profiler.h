@@ -0,0 +1,91 @@
+#ifndef PROG2002_PROFILER_H
+#define PROG2002_PROFILER_H
+
+/*
+ * Scoped CPU and GPU timing zones with Chrome trace export (chrome://tracing, Perfetto).
+ *
+ *   PROFILE_CPU_ZONE("name")  time the enclosing scope on the CPU
+ *   PROFILE_GPU_ZONE("name")  time the GL commands issued in the enclosing scope
+ *   PROFILE_ZONE("name")      both of the above
+ *   PROFILE_END_FRAME()       once per frame on the GL thread, collects finished GPU zones
+ *   PROFILE_THREAD_NAME("name")
+ *   PROFILE_WRITE_TRACE("trace.json")
+ *
+ * Without PROFILER_ENABLED (CMake option of the same name) the macros expand to nothing.
+ * Zone names have to be string literals (or otherwise outlive the profiler).
+ */
+
+#ifdef PROFILER_ENABLED
+
+#include <glad/glad.h>
+
+#include <string>
+
+namespace Profiler
+{
+    // Records [construction, destruction) into the ring buffer of the calling thread.
+    // Recording takes no lock; only the first zone of a new thread registers its buffer.
+    class CpuZone
+    {
+    public:
+        explicit CpuZone(const char* name);
+        ~CpuZone();
+
+        CpuZone(const CpuZone&) = delete;
+        CpuZone& operator=(const CpuZone&) = delete;
+
+    private:
+        const char* Name;
+        unsigned long long Start;
+    };
+
+    // Brackets the GL commands of the scope with GL_TIMESTAMP queries. The results are
+    // read one frame later from a double-buffered query pool, so the GPU is never waited on.
+    // Only valid on the thread that owns the GL context.
+    class GpuZone
+    {
+    public:
+        explicit GpuZone(const char* name);
+        ~GpuZone();
+
+        GpuZone(const GpuZone&) = delete;
+        GpuZone& operator=(const GpuZone&) = delete;
+
+    private:
+        size_t Index;
+    };
+
+    // Name the calling thread in the trace.
+    void SetThreadName(const char* name);
+
+    // Collect the GPU zones of the previous frame (if the GPU finished them) and
+    // start a new frame of queries. Call once per frame from the GL thread.
+    void EndFrame();
+
+    // Write all zones still held by the ring buffers as Chrome trace event JSON. May be
+    // called while other threads record; zones they overwrite meanwhile are left out.
+    bool WriteChromeTrace(const std::string& filePath);
+}
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+
+#define PROFILE_CPU_ZONE(name) Profiler::CpuZone PROFILER_CONCAT(profilerCpuZone, __LINE__)(name)
+#define PROFILE_GPU_ZONE(name) Profiler::GpuZone PROFILER_CONCAT(profilerGpuZone, __LINE__)(name)
+#define PROFILE_ZONE(name) PROFILE_CPU_ZONE(name); PROFILE_GPU_ZONE(name)
+#define PROFILE_END_FRAME() Profiler::EndFrame()
+#define PROFILE_THREAD_NAME(name) Profiler::SetThreadName(name)
+#define PROFILE_WRITE_TRACE(filePath) Profiler::WriteChromeTrace(filePath)
+
+#else
+
+#define PROFILE_CPU_ZONE(name)
+#define PROFILE_GPU_ZONE(name)
+#define PROFILE_ZONE(name)
+#define PROFILE_END_FRAME()
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_WRITE_TRACE(filePath)
+
+#endif
+
+#endif //PROG2002_PROFILER_H
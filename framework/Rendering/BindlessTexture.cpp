@@ -0,0 +1,62 @@
+#include "BindlessTexture.h"
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+namespace
+{
+    typedef GLuint64 (APIENTRYP GetTextureHandleProc)(GLuint texture);
+    typedef void (APIENTRYP MakeTextureHandleResidentProc)(GLuint64 handle);
+    typedef void (APIENTRYP UniformHandleProc)(GLint location, GLuint64 value);
+
+    struct BindlessFunctions
+    {
+        bool loaded = false;
+        bool supported = false;
+        GetTextureHandleProc getTextureHandle = nullptr;
+        MakeTextureHandleResidentProc makeTextureHandleResident = nullptr;
+        UniformHandleProc uniformHandle = nullptr;
+    };
+
+    // Loaded on first use, from the thread that owns the context.
+    BindlessFunctions& Functions()
+    {
+        static BindlessFunctions functions;
+        if (!functions.loaded)
+        {
+            functions.loaded = true;
+            if (glfwExtensionSupported("GL_ARB_bindless_texture"))
+            {
+                functions.getTextureHandle = reinterpret_cast<GetTextureHandleProc>(glfwGetProcAddress("glGetTextureHandleARB"));
+                functions.makeTextureHandleResident = reinterpret_cast<MakeTextureHandleResidentProc>(glfwGetProcAddress("glMakeTextureHandleResidentARB"));
+                functions.uniformHandle = reinterpret_cast<UniformHandleProc>(glfwGetProcAddress("glUniformHandleui64ARB"));
+                functions.supported = functions.getTextureHandle && functions.makeTextureHandleResident && functions.uniformHandle;
+            }
+        }
+        return functions;
+    }
+}
+
+bool BindlessTexture::IsSupported()
+{
+    return Functions().supported;
+}
+
+GLuint64 BindlessTexture::CreateResidentHandle(GLuint texture)
+{
+    if (!IsSupported())
+    {
+        return 0;
+    }
+    GLuint64 handle = Functions().getTextureHandle(texture);
+    Functions().makeTextureHandleResident(handle);
+    return handle;
+}
+
+void BindlessTexture::UniformHandle(GLint location, GLuint64 handle)
+{
+    if (IsSupported())
+    {
+        Functions().uniformHandle(location, handle);
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef PROG2002_BINDLESSTEXTURE_H
+#define PROG2002_BINDLESSTEXTURE_H
+
+#include <glad/glad.h>
+
+// Thin wrapper around GL_ARB_bindless_texture. The entry points are looked up at
+// runtime, so the build does not depend on the extension being in the GL loader.
+namespace BindlessTexture
+{
+    // True if the current context exposes GL_ARB_bindless_texture.
+    bool IsSupported();
+
+    // Create a handle for the texture and make it resident. Returns 0 if unsupported.
+    // Note: the texture becomes immutable once a handle has been created.
+    GLuint64 CreateResidentHandle(GLuint texture);
+
+    // Set a sampler uniform (declared with layout(bindless_sampler)) of the bound program.
+    void UniformHandle(GLint location, GLuint64 handle);
+}
+
+#endif //PROG2002_BINDLESSTEXTURE_H
@@ -0,0 +1,74 @@
+#include "DepthSort.h"
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    constexpr unsigned int DigitBits = 11;
+    constexpr unsigned int DigitCount = 1u << DigitBits;
+    constexpr unsigned int Passes = 3; // 3 * 11 bits cover the 32-bit key
+
+    // Map a float to an unsigned key with the opposite order, so an ascending sort
+    // puts the largest depth first: flip all bits of negatives, only the sign of positives,
+    // then invert. -0 is mapped like +0, so the two tie as they do when compared as floats.
+    inline uint32_t DescendingKey(float depth)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        if (bits == 0x80000000u) {
+            bits = 0;
+        }
+        uint32_t mask = (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+        return ~(bits ^ mask);
+    }
+}
+
+const std::vector<uint32_t>& DepthSorter::SortBackToFront(const float* depths, size_t count)
+{
+    this->Keys.resize(count);
+    this->KeysScratch.resize(count);
+    this->Order.resize(count);
+    this->OrderScratch.resize(count);
+
+    // build the keys and the histograms of all passes in one sweep
+    std::array<std::array<uint32_t, DigitCount>, Passes> histograms{};
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t key = DescendingKey(depths[i]);
+        this->Keys[i] = key;
+        this->Order[i] = static_cast<uint32_t>(i);
+        for (unsigned int pass = 0; pass < Passes; ++pass) {
+            histograms[pass][(key >> (pass * DigitBits)) & (DigitCount - 1)]++;
+        }
+    }
+
+    for (unsigned int pass = 0; pass < Passes; ++pass) {
+        std::array<uint32_t, DigitCount>& histogram = histograms[pass];
+        unsigned int shift = pass * DigitBits;
+
+        // every key has the same digit: the pass would not change the order
+        if (count == 0 || histogram[(this->Keys[0] >> shift) & (DigitCount - 1)] == count) {
+            continue;
+        }
+
+        // exclusive prefix sum -> first output position of each digit
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t key = this->Keys[i];
+            uint32_t position = histogram[(key >> shift) & (DigitCount - 1)]++;
+            this->KeysScratch[position] = key;
+            this->OrderScratch[position] = this->Order[i];
+        }
+        std::swap(this->Keys, this->KeysScratch);
+        std::swap(this->Order, this->OrderScratch);
+    }
+
+    return this->Order;
+}
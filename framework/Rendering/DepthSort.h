@@ -0,0 +1,26 @@
+#ifndef PROG2002_DEPTHSORT_H
+#define PROG2002_DEPTHSORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Orders translucent objects by view depth with an LSD radix sort on the float keys
+ * (three 11-bit passes, O(n)). The floats are mapped to unsigned integers that sort
+ * in the same order, so negative depths are handled too. The sort is stable: equal depths
+ * (including -0 and +0) keep the order they were given in. Passes in which all keys
+ * share the same digit are skipped. The scratch buffers are kept between frames.
+ */
+class DepthSorter
+{
+public:
+    // Indices into depths, farthest first (back to front). Valid until the next call.
+    const std::vector<uint32_t>& SortBackToFront(const float* depths, size_t count);
+
+private:
+    std::vector<uint32_t> Keys, KeysScratch;
+    std::vector<uint32_t> Order, OrderScratch;
+};
+
+#endif //PROG2002_DEPTHSORT_H
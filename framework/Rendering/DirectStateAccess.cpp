@@ -0,0 +1,61 @@
+#include "DirectStateAccess.h"
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+namespace
+{
+    struct DirectStateAccessFunctions
+    {
+        bool loaded = false;
+        bool supported = false;
+        DirectStateAccess::Functions functions;
+    };
+
+    template<typename Proc>
+    bool Load(Proc &proc, const char *name)
+    {
+        proc = reinterpret_cast<Proc>(glfwGetProcAddress(name));
+        return proc != nullptr;
+    }
+
+    // Loaded on first use, from the thread that owns the context.
+    DirectStateAccessFunctions &Loaded()
+    {
+        static DirectStateAccessFunctions dsa;
+        if (!dsa.loaded)
+        {
+            dsa.loaded = true;
+            GLint major = 0, minor = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &major);
+            glGetIntegerv(GL_MINOR_VERSION, &minor);
+            if (major > 4 || (major == 4 && minor >= 5) || glfwExtensionSupported("GL_ARB_direct_state_access"))
+            {
+                DirectStateAccess::Functions &f = dsa.functions;
+                // the extension uses the core names, without an ARB suffix
+                dsa.supported = Load(f.CreateBuffers, "glCreateBuffers")
+                    && Load(f.NamedBufferData, "glNamedBufferData")
+                    && Load(f.NamedBufferSubData, "glNamedBufferSubData")
+                    && Load(f.CreateVertexArrays, "glCreateVertexArrays")
+                    && Load(f.VertexArrayVertexBuffer, "glVertexArrayVertexBuffer")
+                    && Load(f.VertexArrayElementBuffer, "glVertexArrayElementBuffer")
+                    && Load(f.VertexArrayAttribFormat, "glVertexArrayAttribFormat")
+                    && Load(f.VertexArrayAttribIFormat, "glVertexArrayAttribIFormat")
+                    && Load(f.VertexArrayAttribBinding, "glVertexArrayAttribBinding")
+                    && Load(f.EnableVertexArrayAttrib, "glEnableVertexArrayAttrib")
+                    && Load(f.VertexArrayBindingDivisor, "glVertexArrayBindingDivisor");
+            }
+        }
+        return dsa;
+    }
+}
+
+bool DirectStateAccess::IsSupported()
+{
+    return Loaded().supported;
+}
+
+const DirectStateAccess::Functions *DirectStateAccess::Get()
+{
+    return IsSupported() ? &Loaded().functions : nullptr;
+}
@@ -0,0 +1,45 @@
+#ifndef PROG2002_DIRECTSTATEACCESS_H
+#define PROG2002_DIRECTSTATEACCESS_H
+
+#include <glad/glad.h>
+
+// The GL 4.5 / GL_ARB_direct_state_access entry points used for buffers and vertex
+// arrays. They edit objects by name, so creating and updating them does not change
+// any binding. Like the bindless functions they are looked up at runtime: the context
+// is created as 4.3 and the loader does not have to contain them.
+namespace DirectStateAccess
+{
+    typedef void (APIENTRYP CreateObjectsProc)(GLsizei n, GLuint *objects);
+    typedef void (APIENTRYP NamedBufferDataProc)(GLuint buffer, GLsizeiptr size, const void *data, GLenum usage);
+    typedef void (APIENTRYP NamedBufferSubDataProc)(GLuint buffer, GLintptr offset, GLsizeiptr size, const void *data);
+    typedef void (APIENTRYP VertexArrayVertexBufferProc)(GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+    typedef void (APIENTRYP VertexArrayElementBufferProc)(GLuint vaobj, GLuint buffer);
+    typedef void (APIENTRYP VertexArrayAttribFormatProc)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+    typedef void (APIENTRYP VertexArrayAttribIFormatProc)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+    typedef void (APIENTRYP VertexArrayAttribBindingProc)(GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+    typedef void (APIENTRYP EnableVertexArrayAttribProc)(GLuint vaobj, GLuint index);
+    typedef void (APIENTRYP VertexArrayBindingDivisorProc)(GLuint vaobj, GLuint bindingindex, GLuint divisor);
+
+    struct Functions
+    {
+        CreateObjectsProc CreateBuffers = nullptr;
+        NamedBufferDataProc NamedBufferData = nullptr;
+        NamedBufferSubDataProc NamedBufferSubData = nullptr;
+        CreateObjectsProc CreateVertexArrays = nullptr;
+        VertexArrayVertexBufferProc VertexArrayVertexBuffer = nullptr;
+        VertexArrayElementBufferProc VertexArrayElementBuffer = nullptr;
+        VertexArrayAttribFormatProc VertexArrayAttribFormat = nullptr;
+        VertexArrayAttribIFormatProc VertexArrayAttribIFormat = nullptr;
+        VertexArrayAttribBindingProc VertexArrayAttribBinding = nullptr;
+        EnableVertexArrayAttribProc EnableVertexArrayAttrib = nullptr;
+        VertexArrayBindingDivisorProc VertexArrayBindingDivisor = nullptr;
+    };
+
+    // True if the current context is 4.5 or newer or exposes GL_ARB_direct_state_access.
+    bool IsSupported();
+
+    // The entry points, or nullptr if unsupported (callers then bind to edit).
+    const Functions *Get();
+}
+
+#endif //PROG2002_DIRECTSTATEACCESS_H
@@ -0,0 +1,92 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // smoothing of the measured GPU time (weight of the newest frame)
+    constexpr float TimeSmoothing = 0.1f;
+    // below this fraction of the target the resolution is raised again
+    constexpr float RaiseThreshold = 0.85f;
+    // largest scale change per measured frame; dropping is faster than raising
+    constexpr float MaxDropPerFrame = 0.05f;
+    constexpr float MaxRaisePerFrame = 0.01f;
+}
+
+DynamicResolution::DynamicResolution(float targetMilliseconds, float minScale, float maxScale)
+    : TargetMilliseconds(targetMilliseconds), MinScale(std::min(minScale, maxScale)), MaxScale(maxScale), Scale(maxScale)
+{
+    if (IsEnabled()) {
+        glGenQueries(QueryCount, this->Queries);
+    }
+}
+
+DynamicResolution::~DynamicResolution()
+{
+    if (IsEnabled()) {
+        glDeleteQueries(QueryCount, this->Queries);
+    }
+}
+
+void DynamicResolution::BeginFrame()
+{
+    if (!IsEnabled()) {
+        return;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, this->Queries[this->Frame % QueryCount]);
+    this->Frame++;
+}
+
+void DynamicResolution::EndFrame()
+{
+    if (!IsEnabled() || this->Frame == 0) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+
+    // the query begun QueryCount - 1 frames ago, i.e. the one reused by the next BeginFrame()
+    if (this->Frame < QueryCount) {
+        return;
+    }
+    GLuint oldest = this->Queries[this->Frame % QueryCount];
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(oldest, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available) {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(oldest, GL_QUERY_RESULT, &nanoseconds);
+        Update(static_cast<float>(nanoseconds) * 1e-6f);
+    }
+}
+
+float DynamicResolution::GetScale() const
+{
+    // in whole steps, rounded down so the target still holds
+    float steps = std::floor(this->Scale / ScaleStep + 1e-3f);
+    return std::clamp(steps * ScaleStep, this->MinScale, this->MaxScale);
+}
+
+void DynamicResolution::GetRenderSize(GLsizei outputWidth, GLsizei outputHeight, GLsizei& width, GLsizei& height) const
+{
+    float scale = GetScale();
+    width = std::max<GLsizei>(1, static_cast<GLsizei>(std::lround(outputWidth * scale)));
+    height = std::max<GLsizei>(1, static_cast<GLsizei>(std::lround(outputHeight * scale)));
+}
+
+void DynamicResolution::Update(float milliseconds)
+{
+    this->GpuMilliseconds = this->GpuMilliseconds > 0.0f
+        ? this->GpuMilliseconds + TimeSmoothing * (milliseconds - this->GpuMilliseconds)
+        : milliseconds;
+    if (this->GpuMilliseconds <= 0.0f) {
+        return;
+    }
+
+    float desired = this->Scale * std::sqrt(this->TargetMilliseconds / this->GpuMilliseconds);
+    if (this->GpuMilliseconds > this->TargetMilliseconds) {
+        this->Scale = std::max(desired, this->Scale - MaxDropPerFrame);
+    }
+    else if (this->GpuMilliseconds < this->TargetMilliseconds * RaiseThreshold) {
+        this->Scale = std::min(desired, this->Scale + MaxRaisePerFrame);
+    }
+    this->Scale = std::clamp(this->Scale, this->MinScale, this->MaxScale);
+}
@@ -0,0 +1,58 @@
+#ifndef PROG2002_DYNAMICRESOLUTION_H
+#define PROG2002_DYNAMICRESOLUTION_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+/*
+ * Scales the internal render size so the GPU time per frame holds a target. The GPU
+ * time of each frame is measured with a GL_TIME_ELAPSED query between BeginFrame() and
+ * EndFrame(); the results are read QueryCount - 1 frames later and only if available,
+ * so measuring never waits for the GPU. The cost of a frame is taken to grow with its
+ * pixel count, so the per-axis scale moves towards scale * sqrt(target / time) in
+ * bounded steps, and is applied in ScaleStep increments to keep the render targets that
+ * follow the viewport size (e.g. WeightedBlendedOIT) from being reallocated every frame.
+ */
+class DynamicResolution
+{
+public:
+    // targetMilliseconds <= 0 disables the scaling (the scale stays at maxScale)
+    DynamicResolution(float targetMilliseconds, float minScale = 0.5f, float maxScale = 1.0f);
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Bracket the GPU work of a frame (no other GL_TIME_ELAPSED query may be active).
+    void BeginFrame();
+    void EndFrame();
+
+    // per-axis scale of the render size, in [minScale, maxScale]
+    float GetScale() const;
+    // smoothed GPU time per frame, 0 until the first measurement arrives
+    float GetGpuMilliseconds() const { return GpuMilliseconds; }
+    bool IsEnabled() const { return TargetMilliseconds > 0.0f; }
+
+    // render size for an output of outputWidth x outputHeight (at least 1 x 1)
+    void GetRenderSize(GLsizei outputWidth, GLsizei outputHeight, GLsizei& width, GLsizei& height) const;
+
+    static constexpr float ScaleStep = 0.05f;
+
+private:
+    void Update(float milliseconds);
+
+private:
+    static constexpr int QueryCount = 4;
+
+    float TargetMilliseconds;
+    float MinScale;
+    float MaxScale;
+    float Scale;
+    float GpuMilliseconds = 0.0f;
+
+    GLuint Queries[QueryCount] = {};
+    uint64_t Frame = 0; // frames begun so far
+};
+
+#endif //PROG2002_DYNAMICRESOLUTION_H
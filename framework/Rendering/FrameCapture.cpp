@@ -0,0 +1,367 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace {
+    // how long a full ring waits for its oldest readback per try
+    constexpr GLuint64 WaitTimeoutNanoseconds = 1000000000;
+
+    // full range BT.601 (the "C420jpeg" color space of Y4M) in 8.8 fixed point; the chroma
+    // sums are offset by 128.5 * 256 to stay positive before the shift
+    inline unsigned char Luma(int r, int g, int b)
+    {
+        return static_cast<unsigned char>((77 * r + 150 * g + 29 * b + 128) >> 8);
+    }
+    inline unsigned char ChromaBlue(int r, int g, int b)
+    {
+        return static_cast<unsigned char>(std::min((-43 * r - 85 * g + 128 * b + 32896) >> 8, 255));
+    }
+    inline unsigned char ChromaRed(int r, int g, int b)
+    {
+        return static_cast<unsigned char>(std::min((128 * r - 107 * g - 21 * b + 32896) >> 8, 255));
+    }
+}
+
+FrameCapture::Video::~Video()
+{
+    // the last frame fills a single slot
+    if (!this->lastFrame.empty()) {
+        WritePlanes(*this, this->lastFrame);
+    }
+    std::cout << "Recorded " << this->written << " frames at " << this->framesPerSecond << " fps from "
+              << (this->frames - this->dropped) << " captured frames to " << this->filePath;
+    if (this->dropped > 0) {
+        std::cout << " (" << this->dropped << " dropped, the encoder fell behind)";
+    }
+    std::cout << std::endl;
+}
+
+FrameCapture::FrameCapture(unsigned int ringSize)
+    : Ring(std::max(2u, ringSize))
+{
+    this->Encoder = std::thread(&FrameCapture::Encode, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    StopEncoder();
+}
+
+void FrameCapture::RequestScreenshot(const std::string& filePath)
+{
+    this->PendingScreenshots.push_back(filePath);
+}
+
+bool FrameCapture::StartRecording(const std::string& filePath, unsigned int framesPerSecond)
+{
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to create the recording " << filePath << std::endl;
+        return false;
+    }
+    auto video = std::make_shared<Video>();
+    video->file = std::move(file);
+    video->filePath = filePath;
+    video->framesPerSecond = std::max(1u, framesPerSecond);
+    this->Recording = std::move(video);
+    return true;
+}
+
+void FrameCapture::StopRecording()
+{
+    // the readbacks in flight still hold the video, it is closed after their frames
+    this->Recording.reset();
+}
+
+void FrameCapture::Capture(GLuint framebuffer, GLsizei width, GLsizei height)
+{
+    if (this->Finished) {
+        return;
+    }
+
+    // hand over the completed readbacks, in order
+    while (this->InFlight > 0 && Retire(this->Ring[this->Oldest], false)) {
+        this->Oldest = (this->Oldest + 1) % this->Ring.size();
+        this->InFlight--;
+    }
+
+    if (this->Recording && this->Recording->frames > 0
+        && (width != this->Recording->width || height != this->Recording->height)) {
+        std::cerr << "The frame size changed to " << width << "x" << height << ", stopping the recording "
+                  << this->Recording->filePath << std::endl;
+        StopRecording();
+    }
+    if (this->PendingScreenshots.empty() && !this->Recording) {
+        return;
+    }
+
+    // all slots in flight: the only case where the render thread waits for the GPU
+    if (this->InFlight == this->Ring.size()) {
+        Retire(this->Ring[this->Oldest], true);
+        this->Oldest = (this->Oldest + 1) % this->Ring.size();
+        this->InFlight--;
+    }
+
+    Readback& readback = this->Ring[(this->Oldest + this->InFlight) % this->Ring.size()];
+    GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+    if (!readback.buffer) {
+        glGenBuffers(1, &readback.buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    if (readback.capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        readback.capacity = size;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    if (!framebuffer) {
+        glReadBuffer(GL_BACK);
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4); // RGBA rows are always 4 byte aligned
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    readback.width = width;
+    readback.height = height;
+    readback.time = std::chrono::steady_clock::now();
+    readback.screenshotPaths.swap(this->PendingScreenshots);
+    this->PendingScreenshots.clear();
+    if (this->Recording) {
+        this->Recording->width = width;
+        this->Recording->height = height;
+        this->Recording->frames++;
+        readback.video = this->Recording;
+    }
+    this->InFlight++;
+}
+
+void FrameCapture::Finish()
+{
+    if (this->Finished) {
+        return;
+    }
+    while (this->InFlight > 0) {
+        Retire(this->Ring[this->Oldest], true);
+        this->Oldest = (this->Oldest + 1) % this->Ring.size();
+        this->InFlight--;
+    }
+    for (Readback& readback : this->Ring) {
+        if (readback.buffer) {
+            glDeleteBuffers(1, &readback.buffer);
+        }
+        readback = Readback();
+    }
+    this->PendingScreenshots.clear();
+    StopRecording();
+    StopEncoder();
+    this->Finished = true;
+}
+
+bool FrameCapture::Retire(Readback& readback, bool wait)
+{
+    if (!wait) {
+        GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return false;
+        }
+    }
+    else {
+        GLenum status;
+        do {
+            status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, WaitTimeoutNanoseconds);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+
+    Job job;
+    job.width = readback.width;
+    job.height = readback.height;
+    job.time = readback.time;
+    job.screenshotPaths.swap(readback.screenshotPaths);
+    job.video = std::move(readback.video);
+    readback.video.reset();
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        if (job.video && this->QueuedVideoFrames >= MaxQueuedFrames) {
+            job.video->dropped++;
+            job.video.reset();
+        }
+        if (job.screenshotPaths.empty() && !job.video) {
+            return true;
+        }
+        if (!this->FreePixels.empty()) {
+            job.pixels = std::move(this->FreePixels.back());
+            this->FreePixels.pop_back();
+        }
+    }
+
+    size_t size = static_cast<size_t>(job.width) * job.height * 4;
+    job.pixels.resize(size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+    bool valid = mapped != nullptr;
+    if (valid) {
+        std::memcpy(job.pixels.data(), mapped, size);
+        valid = glUnmapBuffer(GL_PIXEL_PACK_BUFFER) == GL_TRUE;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!valid) {
+        std::cerr << "Failed to map a captured frame" << std::endl;
+        if (job.video) {
+            job.video->dropped++;
+        }
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        if (job.video) {
+            this->QueuedVideoFrames++;
+        }
+        this->Jobs.push_back(std::move(job));
+    }
+    this->JobAvailable.notify_one();
+    return true;
+}
+
+void FrameCapture::Encode()
+{
+    // PNG rows are written top row first; only this thread uses stb_image_write
+    stbi_flip_vertically_on_write(1);
+
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (true) {
+        this->JobAvailable.wait(lock, [this] { return this->Stop || !this->Jobs.empty(); });
+        if (this->Jobs.empty()) {
+            return;
+        }
+        Job job = std::move(this->Jobs.front());
+        this->Jobs.pop_front();
+        lock.unlock();
+
+        if (!job.screenshotPaths.empty()) {
+            WriteScreenshot(job);
+        }
+        if (job.video) {
+            WriteVideoFrame(job);
+        }
+        bool video = job.video != nullptr;
+        job.video.reset(); // closes the file after the last frame of a stopped recording
+
+        lock.lock();
+        if (video) {
+            this->QueuedVideoFrames--;
+        }
+        if (this->FreePixels.size() < MaxQueuedFrames) {
+            this->FreePixels.push_back(std::move(job.pixels));
+        }
+    }
+}
+
+void FrameCapture::StopEncoder()
+{
+    if (!this->Encoder.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->Stop = true;
+    }
+    this->JobAvailable.notify_one();
+    this->Encoder.join();
+}
+
+void FrameCapture::WriteScreenshot(Job& job)
+{
+    // the alpha of the framebuffer is whatever blending left there
+    for (size_t i = 3; i < job.pixels.size(); i += 4) {
+        job.pixels[i] = 255;
+    }
+    for (const std::string& filePath : job.screenshotPaths) {
+        if (!stbi_write_png(filePath.c_str(), job.width, job.height, 4, job.pixels.data(), job.width * 4)) {
+            std::cerr << "Failed to write the screenshot " << filePath << std::endl;
+        }
+        else {
+            std::cout << "Screenshot saved to " << filePath << std::endl;
+        }
+    }
+}
+
+void FrameCapture::WriteVideoFrame(const Job& job)
+{
+    Video& video = *job.video;
+    if (!video.file) {
+        return;
+    }
+    if (!video.headerWritten) {
+        video.file << "YUV4MPEG2 W" << job.width << " H" << job.height << " F" << video.framesPerSecond
+                   << ":1 Ip A1:1 C420jpeg\n";
+        video.headerWritten = true;
+        video.start = job.time;
+    }
+
+    // the previous frame is shown until the slot this frame was captured in
+    double seconds = std::chrono::duration<double>(job.time - video.start).count();
+    uint64_t slot = static_cast<uint64_t>(std::max(0.0, seconds) * video.framesPerSecond);
+    if (!video.lastFrame.empty()) {
+        while (video.written < slot && video.file) {
+            WritePlanes(video, video.lastFrame);
+        }
+    }
+
+    // Y at full size, Cb and Cr averaged over 2x2 pixels; GL rows are bottom up, Y4M rows top down
+    const size_t width = job.width, height = job.height;
+    const size_t chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+    std::vector<unsigned char>& planes = video.lastFrame;
+    planes.resize(width * height + 2 * chromaWidth * chromaHeight);
+    unsigned char* lumaPlane = planes.data();
+    unsigned char* bluePlane = lumaPlane + width * height;
+    unsigned char* redPlane = bluePlane + chromaWidth * chromaHeight;
+    auto pixel = [&](size_t x, size_t y) { return job.pixels.data() + ((height - 1 - y) * width + x) * 4; };
+
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            const unsigned char* p = pixel(x, y);
+            lumaPlane[y * width + x] = Luma(p[0], p[1], p[2]);
+        }
+    }
+    for (size_t cy = 0; cy < chromaHeight; ++cy) {
+        for (size_t cx = 0; cx < chromaWidth; ++cx) {
+            size_t x0 = 2 * cx, y0 = 2 * cy;
+            size_t x1 = std::min(x0 + 1, width - 1), y1 = std::min(y0 + 1, height - 1);
+            int r = 0, g = 0, b = 0;
+            for (const unsigned char* p : { pixel(x0, y0), pixel(x1, y0), pixel(x0, y1), pixel(x1, y1) }) {
+                r += p[0];
+                g += p[1];
+                b += p[2];
+            }
+            r = (r + 2) / 4;
+            g = (g + 2) / 4;
+            b = (b + 2) / 4;
+            bluePlane[cy * chromaWidth + cx] = ChromaBlue(r, g, b);
+            redPlane[cy * chromaWidth + cx] = ChromaRed(r, g, b);
+        }
+    }
+}
+
+void FrameCapture::WritePlanes(Video& video, const std::vector<unsigned char>& planes)
+{
+    if (!video.file) {
+        return;
+    }
+    video.file << "FRAME\n";
+    video.file.write(reinterpret_cast<const char*>(planes.data()), static_cast<std::streamsize>(planes.size()));
+    if (!video.file) {
+        std::cerr << "Failed to write to the recording " << video.filePath << std::endl;
+        return;
+    }
+    video.written++;
+}
@@ -0,0 +1,135 @@
+#ifndef PROG2002_FRAMECAPTURE_H
+#define PROG2002_FRAMECAPTURE_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Screenshots (PNG) and video recordings (raw Y4M, 4:2:0) of the rendered frames without
+ * stalling the render thread. Capture() starts an asynchronous glReadPixels of the frame
+ * into one of RingSize pixel buffer objects and fences it; the buffers are mapped once
+ * their fence has signaled, usually RingSize - 1 frames later, and the pixels are handed
+ * to an encoder thread that converts and writes them. The render thread only waits when
+ * every buffer of the ring is still in flight. Video frames that arrive while the encoder
+ * is MaxQueuedFrames behind are dropped (and counted) rather than queued without bound.
+ *
+ * Videos play back in real time: every captured frame is stamped when Capture() reads it
+ * and the encoder fills the slots of the declared frame rate up to the next frame with it,
+ * repeating frames when fewer are rendered (vsync off, skipped or dropped frames) and
+ * leaving some out when more are.
+ *
+ * All methods are called by the thread owning the GL context; call Finish() before the
+ * context goes away (the destructor only waits for the encoder, it makes no GL calls).
+ */
+class FrameCapture
+{
+public:
+    explicit FrameCapture(unsigned int ringSize = 3);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Write the next captured frame to filePath as a PNG.
+    void RequestScreenshot(const std::string& filePath);
+
+    // Record the captured frames to filePath as Y4M video at framesPerSecond (paced to the
+    // capture times, see above). The frame size is taken from the first frame; the recording
+    // stops if the size changes later on (IsRecording() turns false).
+    // Returns false (with a message) if the file cannot be created.
+    bool StartRecording(const std::string& filePath, unsigned int framesPerSecond = 60);
+    void StopRecording();
+    bool IsRecording() const { return Recording != nullptr; }
+
+    // Read back the lower left width x height of framebuffer (0 = back buffer of the window)
+    // if the frame is recorded or a screenshot was requested, and pass the readbacks that
+    // completed in the meantime to the encoder. Call once per frame after drawing it.
+    void Capture(GLuint framebuffer, GLsizei width, GLsizei height);
+
+    // Map the outstanding readbacks, wait until everything is written and delete the buffers.
+    // Nothing is captured afterwards.
+    void Finish();
+
+    static constexpr size_t MaxQueuedFrames = 8;
+
+private:
+    struct Video
+    {
+        ~Video(); // writes the last frame and reports the frame counts
+
+        std::ofstream file;
+        std::string filePath;
+        unsigned int framesPerSecond = 60;
+        // render thread
+        GLsizei width = 0;
+        GLsizei height = 0;
+        uint64_t frames = 0;  // captured
+        uint64_t dropped = 0; // captured but not encoded
+        // encoder thread
+        bool headerWritten = false;
+        std::chrono::steady_clock::time_point start; // capture time of the first frame
+        std::vector<unsigned char> lastFrame; // Y, Cb and Cr planes, written once the next frame's slot is known
+        uint64_t written = 0; // frame slots written
+    };
+
+    struct Readback
+    {
+        GLuint buffer = 0;
+        GLsizeiptr capacity = 0;
+        GLsync fence = nullptr;
+        GLsizei width = 0;
+        GLsizei height = 0;
+        std::chrono::steady_clock::time_point time;
+        std::vector<std::string> screenshotPaths;
+        std::shared_ptr<Video> video;
+    };
+
+    // encoded by the encoder thread; the video is closed with its last job
+    struct Job
+    {
+        GLsizei width = 0;
+        GLsizei height = 0;
+        std::chrono::steady_clock::time_point time;
+        std::vector<unsigned char> pixels; // RGBA, bottom row first
+        std::vector<std::string> screenshotPaths;
+        std::shared_ptr<Video> video;
+    };
+
+private:
+    // map a readback whose fence signaled (waits for it when wait is set) and queue its jobs
+    bool Retire(Readback& readback, bool wait);
+    void Encode();
+    void StopEncoder();
+    static void WriteScreenshot(Job& job);
+    static void WriteVideoFrame(const Job& job);
+    static void WritePlanes(Video& video, const std::vector<unsigned char>& planes);
+
+private:
+    std::vector<Readback> Ring;
+    size_t Oldest = 0;   // first slot in flight
+    size_t InFlight = 0; // slots Oldest, Oldest + 1, ... (wrapping) hold fenced readbacks
+    bool Finished = false;
+
+    std::vector<std::string> PendingScreenshots;
+    std::shared_ptr<Video> Recording;
+
+    std::mutex Mutex;
+    std::condition_variable JobAvailable;
+    std::deque<Job> Jobs;
+    size_t QueuedVideoFrames = 0; // queued or being encoded
+    std::vector<std::vector<unsigned char>> FreePixels; // recycled pixel storage
+    bool Stop = false; // the encoder exits once the queue is empty
+    std::thread Encoder;
+};
+
+#endif //PROG2002_FRAMECAPTURE_H
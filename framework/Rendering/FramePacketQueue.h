@@ -0,0 +1,88 @@
+#ifndef PROG2002_FRAMEPACKETQUEUE_H
+#define PROG2002_FRAMEPACKETQUEUE_H
+
+#include <condition_variable>
+#include <mutex>
+
+/*
+ * Double-buffered hand-over of frame packets from the thread that updates the game
+ * to the thread that owns the GL context. The producer fills one packet while the
+ * consumer renders the other, so at most one frame is in flight: Submit() blocks
+ * while the previously submitted packet has not been picked up yet.
+ *
+ *   producer: Packet& p = queue.BeginWrite(); ...fill p...; queue.Submit();
+ *   consumer: while (Packet* p = queue.Acquire()) { ...render *p...; queue.Release(); }
+ *
+ * Packets are reused, so containers inside them keep their capacity between frames.
+ */
+template<typename Packet>
+class FramePacketQueue
+{
+public:
+    // The packet to record the next frame into. It is never the one being rendered.
+    Packet& BeginWrite()
+    {
+        return this->Packets[this->WriteIndex];
+    }
+
+    // Hand the recorded packet to the consumer and switch to the other one.
+    void Submit()
+    {
+        std::unique_lock<std::mutex> lock(this->Mutex);
+        this->Condition.wait(lock, [this] { return !this->Submitted || this->Closed; });
+        this->Submitted = true;
+        this->SubmittedIndex = this->WriteIndex;
+        this->WriteIndex = 1 - this->WriteIndex;
+        this->Condition.notify_all();
+        // the next packet to write may still be rendered
+        this->Condition.wait(lock, [this] {
+            return !this->Reading || this->ReadIndex != this->WriteIndex || this->Closed;
+        });
+    }
+
+    // Wait for the next submitted packet. Returns nullptr once the queue is closed
+    // and no packet is left.
+    Packet* Acquire()
+    {
+        std::unique_lock<std::mutex> lock(this->Mutex);
+        this->Condition.wait(lock, [this] { return this->Submitted || this->Closed; });
+        if (!this->Submitted) {
+            return nullptr;
+        }
+        this->Submitted = false;
+        this->Reading = true;
+        this->ReadIndex = this->SubmittedIndex;
+        this->Condition.notify_all();
+        return &this->Packets[this->ReadIndex];
+    }
+
+    // The consumer is done with the acquired packet.
+    void Release()
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->Reading = false;
+        this->Condition.notify_all();
+    }
+
+    // Wake both sides and stop handing out packets after the last submitted one.
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->Closed = true;
+        this->Condition.notify_all();
+    }
+
+private:
+    Packet Packets[2];
+    int WriteIndex = 0;
+    int SubmittedIndex = 0;
+    int ReadIndex = 0;
+    bool Submitted = false;
+    bool Reading = false;
+    bool Closed = false;
+
+    std::mutex Mutex;
+    std::condition_variable Condition;
+};
+
+#endif //PROG2002_FRAMEPACKETQUEUE_H
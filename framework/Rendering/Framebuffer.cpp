@@ -0,0 +1,113 @@
+#include "Framebuffer.h"
+
+#include <algorithm>
+#include <iostream>
+
+Framebuffer::~Framebuffer()
+{
+    Release();
+}
+
+bool Framebuffer::Resize(GLsizei width, GLsizei height, GLsizei samples)
+{
+    GLint maxSamples = 1;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    samples = std::clamp(samples, 1, std::max(1, maxSamples));
+    if (this->RenderFramebuffer && width == this->Width && height == this->Height && samples == this->Samples) {
+        return true;
+    }
+
+    Release();
+    this->Width = width;
+    this->Height = height;
+    this->Samples = samples;
+
+    // the single sampled color that is presented (and sampled by post-processing)
+    glGenTextures(1, &this->ColorTexture);
+    glBindTexture(GL_TEXTURE_2D, this->ColorTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenRenderbuffers(1, &this->DepthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, this->DepthRenderbuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, IsMultisampled() ? samples : 0, GL_DEPTH24_STENCIL8, width, height);
+
+    glGenFramebuffers(1, &this->RenderFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->RenderFramebuffer);
+    if (IsMultisampled()) {
+        glGenRenderbuffers(1, &this->ColorRenderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->ColorRenderbuffer);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->ColorRenderbuffer);
+    }
+    else {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->ColorTexture, 0);
+    }
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->DepthRenderbuffer);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    this->ResolveFramebuffer = this->RenderFramebuffer;
+    if (complete && IsMultisampled()) {
+        glGenFramebuffers(1, &this->ResolveFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, this->ResolveFramebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->ColorTexture, 0);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) {
+        std::cerr << "Framebuffer of " << width << "x" << height << " with " << samples << " samples is incomplete" << std::endl;
+        Release();
+        return false;
+    }
+    return true;
+}
+
+void Framebuffer::Bind(GLsizei width, GLsizei height) const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, this->RenderFramebuffer);
+    glViewport(0, 0, width, height);
+}
+
+void Framebuffer::Resolve(GLsizei width, GLsizei height) const
+{
+    if (!IsMultisampled()) {
+        return;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->RenderFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->ResolveFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+void Framebuffer::BlitColor(GLsizei width, GLsizei height, GLuint target, GLsizei targetWidth, GLsizei targetHeight) const
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->ResolveFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+    GLenum filter = (width == targetWidth && height == targetHeight) ? GL_NEAREST : GL_LINEAR;
+    glBlitFramebuffer(0, 0, width, height, 0, 0, targetWidth, targetHeight, GL_COLOR_BUFFER_BIT, filter);
+}
+
+void Framebuffer::Release()
+{
+    if (this->ResolveFramebuffer && this->ResolveFramebuffer != this->RenderFramebuffer) {
+        glDeleteFramebuffers(1, &this->ResolveFramebuffer);
+    }
+    if (this->RenderFramebuffer) {
+        glDeleteFramebuffers(1, &this->RenderFramebuffer);
+    }
+    if (this->ColorRenderbuffer) {
+        glDeleteRenderbuffers(1, &this->ColorRenderbuffer);
+    }
+    if (this->DepthRenderbuffer) {
+        glDeleteRenderbuffers(1, &this->DepthRenderbuffer);
+    }
+    if (this->ColorTexture) {
+        glDeleteTextures(1, &this->ColorTexture);
+    }
+    this->RenderFramebuffer = this->ResolveFramebuffer = 0;
+    this->ColorRenderbuffer = this->DepthRenderbuffer = this->ColorTexture = 0;
+    this->Width = this->Height = this->Samples = 0;
+}
@@ -0,0 +1,68 @@
+#ifndef PROG2002_FRAMEBUFFER_H
+#define PROG2002_FRAMEBUFFER_H
+
+#include <glad/glad.h>
+
+// How the scene is anti-aliased when it is rendered into a Framebuffer.
+enum class AntiAliasing {
+    Off,
+    MSAA, // multisampled attachments, resolved before presenting
+    FXAA  // single sampled, filtered by a post-processing pass while presenting
+};
+
+/*
+ * Offscreen render target with an RGBA8 color and a 24-bit depth (+ 8-bit stencil)
+ * attachment. With more than one sample the attachments are multisampled renderbuffers
+ * and Resolve() copies the color into a single sampled texture; otherwise the scene is
+ * drawn into that texture directly. Either way GetColorTexture() can be sampled (linear,
+ * clamped to the edge) once the frame is resolved.
+ *
+ * The scene may cover only the lower left width x height part of the target (dynamic
+ * resolution), which avoids reallocating the attachments whenever the render size changes.
+ */
+class Framebuffer
+{
+public:
+    Framebuffer() = default;
+    ~Framebuffer();
+
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+
+    // (Re)create the attachments if the size or the sample count changed. samples <= 1 is
+    // single sampled; the sample count is clamped to GL_MAX_SAMPLES.
+    // Returns false (with a message) if the framebuffer is incomplete.
+    bool Resize(GLsizei width, GLsizei height, GLsizei samples = 1);
+
+    // Draw into the framebuffer, with the viewport set to its lower left width x height part.
+    void Bind(GLsizei width, GLsizei height) const;
+
+    // Copy the multisampled color of the lower left width x height part into the color
+    // texture (nothing to do without multisampling).
+    void Resolve(GLsizei width, GLsizei height) const;
+
+    // Scale the resolved lower left width x height part onto target (a framebuffer name,
+    // 0 = window) at targetWidth x targetHeight.
+    void BlitColor(GLsizei width, GLsizei height, GLuint target, GLsizei targetWidth, GLsizei targetHeight) const;
+
+    GLuint GetColorTexture() const { return ColorTexture; }
+    GLsizei GetWidth() const { return Width; }
+    GLsizei GetHeight() const { return Height; }
+    GLsizei GetSamples() const { return Samples; }
+    bool IsMultisampled() const { return Samples > 1; }
+
+private:
+    void Release();
+
+private:
+    GLuint RenderFramebuffer = 0;  // the scene is drawn here
+    GLuint ResolveFramebuffer = 0; // color texture only; the same as RenderFramebuffer without MSAA
+    GLuint ColorTexture = 0;
+    GLuint ColorRenderbuffer = 0;  // multisampled color
+    GLuint DepthRenderbuffer = 0;
+    GLsizei Width = 0;
+    GLsizei Height = 0;
+    GLsizei Samples = 0;
+};
+
+#endif //PROG2002_FRAMEBUFFER_H
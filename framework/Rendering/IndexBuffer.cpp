@@ -1,10 +1,17 @@
 #include "IndexBuffer.h"
+#include "RenderStats.h"
+#include "DirectStateAccess.h"
 
-IndexBuffer::IndexBuffer(GLuint *indices, GLsizei count) : Count(count) {
-    glGenBuffers(1, &(this->IndexBufferID));
-    Bind();
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * count, indices, GL_STATIC_DRAW);
+IndexBuffer::IndexBuffer(const GLuint *indices, GLsizei count) : Count(count), Type(GL_UNSIGNED_INT) {
+    Upload(indices, sizeof(GLuint) * count);
+}
+
+IndexBuffer::IndexBuffer(const GLushort *indices, GLsizei count) : Count(count), Type(GL_UNSIGNED_SHORT) {
+    Upload(indices, sizeof(GLushort) * count);
+}
 
+IndexBuffer::IndexBuffer(const GLubyte *indices, GLsizei count) : Count(count), Type(GL_UNSIGNED_BYTE) {
+    Upload(indices, sizeof(GLubyte) * count);
 }
 
 IndexBuffer::~IndexBuffer() {
@@ -18,4 +25,30 @@ void IndexBuffer::Bind() const {
 
 void IndexBuffer::Unbind() const {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-}
\ No newline at end of file
+}
+
+void IndexBuffer::Upload(const void *indices, GLsizeiptr size) {
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        dsa->CreateBuffers(1, &(this->IndexBufferID));
+        dsa->NamedBufferData(this->IndexBufferID, size, indices, GL_STATIC_DRAW);
+    } else {
+        // not bound to GL_ELEMENT_ARRAY_BUFFER, which would attach it to the bound vertex array
+        glGenBuffers(1, &(this->IndexBufferID));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->IndexBufferID);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, indices, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    if (indices) RenderStatistics::CountBufferUpload(size);
+}
+
+void IndexBuffer::BufferSubData(GLintptr offset, GLsizeiptr size, const void *data) const {
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        dsa->NamedBufferSubData(this->IndexBufferID, offset, size, data);
+    } else {
+        // GL_ELEMENT_ARRAY_BUFFER is vertex array state, the copy target is not
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->IndexBufferID);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    RenderStatistics::CountBufferUpload(size);
+}
@@ -8,9 +8,14 @@ class IndexBuffer
 {
 public:
     // Constructor. Initializes the class with a data buffer and its size.
-    // Note: The buffer will be bound upon construction, and the size is
+    // Note: The buffer is not attached to a vertex array (see VertexArray::SetIndexBuffer),
+    // and the size is
     // specified in the number of elements, not bytes.
-    IndexBuffer(GLuint *indices, GLsizei count);
+    // The element type (GL_UNSIGNED_INT, GL_UNSIGNED_SHORT or GL_UNSIGNED_BYTE)
+    // is taken from the overload used.
+    IndexBuffer(const GLuint *indices, GLsizei count);
+    IndexBuffer(const GLushort *indices, GLsizei count);
+    IndexBuffer(const GLubyte *indices, GLsizei count);
     ~IndexBuffer();
 
     // Bind the vertex buffer.
@@ -19,12 +24,26 @@ public:
     // Unbind the vertex buffer.
     void Unbind() const;
 
+    // Replace size bytes of the indices, starting offset bytes into the buffer. Does not
+    // change the element array binding (and so the bound vertex array).
+    void BufferSubData(GLintptr offset, GLsizeiptr size, const void *data) const;
+
     // Get the number of elements.
     inline GLuint GetCount() const { return Count; }
 
+    // Get the element type to pass to glDrawElements.
+    inline GLenum GetType() const { return Type; }
+
+    // The name of the GL buffer object.
+    inline GLuint GetID() const { return IndexBufferID; }
+
+private:
+    void Upload(const void *indices, GLsizeiptr size);
+
 private:
     GLuint IndexBufferID;
     GLuint Count;
+    GLenum Type;
 };
 
 #endif //PROG2002_INDEXBUFFER_H
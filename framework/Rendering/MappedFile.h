@@ -0,0 +1,33 @@
+#ifndef PROG2002_MAPPEDFILE_H
+#define PROG2002_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The mapping is released
+// when the object goes out of scope.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filePath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsOpen() const { return Data != nullptr; }
+    const unsigned char* GetData() const { return Data; }
+    size_t GetSize() const { return Size; }
+
+private:
+    const unsigned char* Data = nullptr;
+    size_t Size = 0;
+#ifdef _WIN32
+    void* FileHandle = nullptr;
+    void* MappingHandle = nullptr;
+#else
+    int FileDescriptor = -1;
+#endif
+};
+
+#endif //PROG2002_MAPPEDFILE_H
@@ -0,0 +1,43 @@
+#include "MeshArena.h"
+
+#include <iostream>
+
+MeshArena::MeshArena(const std::shared_ptr<VertexBuffer> &vertices, GLsizeiptr vertexSize, GLuint vertexCapacity,
+                     const std::shared_ptr<IndexBuffer> &indices, GLsizeiptr indexSize, GLuint indexCapacity)
+    : Vertices(vertices), Indices(indices), Array(std::make_shared<VertexArray>()),
+      VertexSize(vertexSize), IndexSize(indexSize), VertexRanges(vertexCapacity), IndexRanges(indexCapacity)
+{
+    Array->SetIndexBuffer(indices);
+}
+
+bool MeshArena::Add(const void *vertices, GLuint vertexCount, const void *indices, GLsizei indexCount, MeshAllocation &mesh)
+{
+    uint32_t firstVertex = 0, firstIndex = 0;
+    if (!VertexRanges.Allocate(vertexCount, firstVertex)) {
+        std::cerr << "MeshArena: no room for " << vertexCount << " vertices (largest free range: "
+                  << VertexRanges.GetLargestFreeRange() << ")" << std::endl;
+        return false;
+    }
+    if (indexCount <= 0 || !IndexRanges.Allocate(static_cast<uint32_t>(indexCount), firstIndex)) {
+        std::cerr << "MeshArena: no room for " << indexCount << " indices (largest free range: "
+                  << IndexRanges.GetLargestFreeRange() << ")" << std::endl;
+        VertexRanges.Free(firstVertex, vertexCount);
+        return false;
+    }
+
+    Vertices->BufferSubData(VertexSize * firstVertex, VertexSize * vertexCount, vertices);
+    Indices->BufferSubData(IndexSize * firstIndex, IndexSize * indexCount, indices);
+
+    mesh.BaseVertex = static_cast<GLint>(firstVertex);
+    mesh.VertexCount = vertexCount;
+    mesh.FirstIndex = firstIndex;
+    mesh.IndexCount = indexCount;
+    return true;
+}
+
+void MeshArena::Remove(MeshAllocation &mesh)
+{
+    VertexRanges.Free(static_cast<uint32_t>(mesh.BaseVertex), mesh.VertexCount);
+    IndexRanges.Free(mesh.FirstIndex, static_cast<uint32_t>(mesh.IndexCount));
+    mesh = MeshAllocation();
+}
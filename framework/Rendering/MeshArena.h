@@ -0,0 +1,86 @@
+#ifndef PROG2002_MESHARENA_H
+#define PROG2002_MESHARENA_H
+
+#include <glad/glad.h>
+
+#include <memory>
+
+#include "IndexBuffer.h"
+#include "RangeAllocator.h"
+#include "StaticBufferLayout.h"
+#include "VertexBuffer.h"
+#include "VertextArray.h"
+
+// Where a mesh lives in a MeshArena: its indices are IndexCount indices from FirstIndex
+// on and refer to the vertices from BaseVertex on.
+struct MeshAllocation {
+    GLint BaseVertex = 0;
+    GLuint VertexCount = 0;
+    GLuint FirstIndex = 0;
+    GLsizei IndexCount = 0;
+};
+
+/*
+ * Shared vertex and index buffers for all meshes of one vertex format, with a single
+ * VertexArray. Meshes are sub-allocated with a RangeAllocator and keep indices that
+ * start at 0; they are drawn with the base vertex of their allocation, so switching
+ * between meshes of an arena needs no VertexArray bind:
+ *
+ *   auto arena = MeshArena::Create<Vertex, GLushort>(65536, 3 * 65536);
+ *   MeshAllocation cube;
+ *   arena->Add(vertices, vertexCount, indices, indexCount, cube);
+ *   arena->Bind();
+ *   RenderCommands::DrawMesh(GL_TRIANGLES, *arena, cube);
+ *
+ * The capacities are fixed at creation. Per-instance buffers can be added to the
+ * VertexArray of the arena; they are shared by all of its meshes.
+ */
+class MeshArena
+{
+public:
+    // An arena for vertices laid out like Vertex (see StaticBufferLayout.h) indexed with
+    // Index (GLuint, GLushort or GLubyte).
+    template<typename Vertex, typename Index>
+    static std::shared_ptr<MeshArena> Create(GLuint vertexCapacity, GLuint indexCapacity)
+    {
+        auto vertices = std::make_shared<VertexBuffer>(nullptr, static_cast<GLsizei>(sizeof(Vertex) * vertexCapacity));
+        auto indices = std::make_shared<IndexBuffer>(static_cast<const Index *>(nullptr), static_cast<GLsizei>(indexCapacity));
+        std::shared_ptr<MeshArena> arena(new MeshArena(vertices, sizeof(Vertex), vertexCapacity, indices, sizeof(Index), indexCapacity));
+        arena->Array->AddVertexBuffer<Vertex>(vertices);
+        return arena;
+    }
+
+    /**
+     * Copy a mesh into free ranges of the buffers. vertices are vertexCount vertices of the
+     * arena's format, indices indexCount indices of its index type.
+     * @return false (with a message) if the arena has no room for it
+     */
+    bool Add(const void *vertices, GLuint vertexCount, const void *indices, GLsizei indexCount, MeshAllocation &mesh);
+
+    // Release the ranges of a mesh; its contents stay in the buffers until they are reused.
+    void Remove(MeshAllocation &mesh);
+
+    // Bind the VertexArray once for all meshes of the arena.
+    void Bind() const { Array->Bind(); }
+
+    const std::shared_ptr<VertexArray> &GetVertexArray() const { return Array; }
+    GLenum GetIndexType() const { return Indices->GetType(); }
+    GLsizeiptr GetIndexSize() const { return IndexSize; }
+    const RangeAllocator &GetVertexRanges() const { return VertexRanges; }
+    const RangeAllocator &GetIndexRanges() const { return IndexRanges; }
+
+private:
+    MeshArena(const std::shared_ptr<VertexBuffer> &vertices, GLsizeiptr vertexSize, GLuint vertexCapacity,
+              const std::shared_ptr<IndexBuffer> &indices, GLsizeiptr indexSize, GLuint indexCapacity);
+
+private:
+    std::shared_ptr<VertexBuffer> Vertices;
+    std::shared_ptr<IndexBuffer> Indices;
+    std::shared_ptr<VertexArray> Array;
+    GLsizeiptr VertexSize;
+    GLsizeiptr IndexSize;
+    RangeAllocator VertexRanges;
+    RangeAllocator IndexRanges;
+};
+
+#endif //PROG2002_MESHARENA_H
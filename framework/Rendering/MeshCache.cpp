@@ -0,0 +1,249 @@
+#include "MeshCache.h"
+#include "TextureCache.h"
+#include "VertexStreams.h"
+
+#include "MeshOptimization.h"
+#include "VertexQuantization.h"
+#include <tiny_obj_loader.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    constexpr char CacheMagic[4] = {'M', 'S', 'H', '1'};
+    constexpr uint32_t CacheVersion = 1;
+    constexpr uint32_t CacheAlignment = 16;
+
+    struct CacheHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t SourceHash;
+        float FitHalfExtent;
+        uint32_t VertexSize;
+        uint32_t VertexCount;
+        uint32_t IndexSize;
+        uint32_t IndexCount;
+        uint32_t VertexOffset; // from the start of the file
+        uint32_t IndexOffset;
+        uint32_t Reserved;
+    };
+
+    uint32_t AlignUp(uint32_t value)
+    {
+        return (value + CacheAlignment - 1) & ~(CacheAlignment - 1);
+    }
+
+    template<typename Index>
+    bool IndicesInRange(const Index* indices, uint32_t indexCount, uint32_t vertexCount)
+    {
+        return std::all_of(indices, indices + indexCount, [vertexCount](Index index) { return index < vertexCount; });
+    }
+
+    const float* Position(const tinyobj::attrib_t& attrib, int index)
+    {
+        return &attrib.vertices[3 * static_cast<size_t>(index)];
+    }
+}
+
+bool MeshCache::LoadOrImport(const std::string& sourcePath, const ImportOptions& options, Mesh& mesh)
+{
+    uint64_t sourceHash = TextureCache::HashFile(sourcePath);
+    if (sourceHash != 0 && Load(sourcePath, sourceHash, options, mesh)) {
+        return true;
+    }
+    if (!Import(sourcePath, options, mesh)) {
+        return false;
+    }
+    if (!Write(sourcePath, sourceHash, options, mesh)) {
+        std::cerr << "Could not write the mesh cache of " << sourcePath << std::endl;
+    }
+    return true;
+}
+
+bool MeshCache::Load(const std::string& sourcePath, uint64_t sourceHash, const ImportOptions& options, Mesh& mesh)
+{
+    auto mapping = std::make_shared<MappedFile>(CachePath(sourcePath));
+    if (!mapping->IsOpen() || mapping->GetSize() < sizeof(CacheHeader)) {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, mapping->GetData(), sizeof(header));
+    if (std::memcmp(header.Magic, CacheMagic, sizeof(CacheMagic)) != 0 || header.Version != CacheVersion
+        || header.SourceHash != sourceHash || header.FitHalfExtent != options.FitHalfExtent
+        || header.VertexSize != sizeof(GeometricTools::CompactVertexPN) || header.IndexCount == 0
+        || (header.IndexSize != 2 && header.IndexSize != 4)
+        || header.VertexOffset % CacheAlignment != 0 || header.IndexOffset % CacheAlignment != 0) {
+        return false;
+    }
+    if (static_cast<size_t>(header.VertexOffset) + static_cast<size_t>(header.VertexSize) * header.VertexCount > mapping->GetSize()
+        || static_cast<size_t>(header.IndexOffset) + static_cast<size_t>(header.IndexSize) * header.IndexCount > mapping->GetSize()) {
+        return false;
+    }
+    // a damaged entry must not make the draws fetch outside the mesh
+    const unsigned char* indices = mapping->GetData() + header.IndexOffset;
+    bool indicesInRange = header.IndexSize == 2
+        ? IndicesInRange(reinterpret_cast<const uint16_t*>(indices), header.IndexCount, header.VertexCount)
+        : IndicesInRange(reinterpret_cast<const uint32_t*>(indices), header.IndexCount, header.VertexCount);
+    if (!indicesInRange) {
+        std::cerr << "The mesh cache of " << sourcePath << " has indices out of range and is ignored" << std::endl;
+        return false;
+    }
+
+    mesh.VertexSize = header.VertexSize;
+    mesh.VertexCount = header.VertexCount;
+    mesh.IndexSize = header.IndexSize;
+    mesh.IndexCount = header.IndexCount;
+    mesh.Vertices = mapping->GetData() + header.VertexOffset;
+    mesh.Indices = mapping->GetData() + header.IndexOffset;
+    mesh.Mapping = std::move(mapping);
+    mesh.Storage.clear();
+    return true;
+}
+
+bool MeshCache::Import(const std::string& sourcePath, const ImportOptions& options, Mesh& mesh)
+{
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warning, error;
+    std::string baseDirectory = std::filesystem::path(sourcePath).parent_path().string();
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, sourcePath.c_str(),
+                          baseDirectory.empty() ? nullptr : baseDirectory.c_str(), true)) {
+        std::cerr << "Could not load the model " << sourcePath << ": " << error << std::endl;
+        return false;
+    }
+    if (!warning.empty()) {
+        std::cerr << sourcePath << ": " << warning << std::endl;
+    }
+
+    // fit into [-FitHalfExtent, FitHalfExtent]^3: the positions are centered and scaled in place
+    if (options.FitHalfExtent > 0.0f && attrib.vertices.size() >= 3) {
+        VertexStream positions;
+        positions.Data = reinterpret_cast<uint8_t*>(attrib.vertices.data());
+        positions.Stride = 3 * sizeof(float);
+        positions.Count = attrib.vertices.size() / 3;
+        glm::vec3 lower, upper;
+        VertexStreams::ComputeBounds(positions, lower, upper);
+        glm::vec3 halfExtents = 0.5f * (upper - lower);
+        float halfExtent = std::max(halfExtents.x, std::max(halfExtents.y, halfExtents.z));
+        float scale = halfExtent > 0.0f ? options.FitHalfExtent / halfExtent : 1.0f;
+        VertexStreams::TransformPositions(positions, glm::scale(glm::mat4(1.0f), glm::vec3(scale))
+                                                     * glm::translate(glm::mat4(1.0f), -0.5f * (lower + upper)));
+    }
+
+    // one quantized vertex per triangle corner; corners without a normal get the face normal
+    std::vector<GeometricTools::CompactVertexPN> corners;
+    for (const tinyobj::shape_t& shape : shapes) {
+        const std::vector<tinyobj::index_t>& indices = shape.mesh.indices;
+        for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3) {
+            const float* p0 = Position(attrib, indices[triangle].vertex_index);
+            const float* p1 = Position(attrib, indices[triangle + 1].vertex_index);
+            const float* p2 = Position(attrib, indices[triangle + 2].vertex_index);
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float face[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+
+            for (size_t corner = triangle; corner < triangle + 3; ++corner) {
+                const tinyobj::index_t& index = indices[corner];
+                const float* position = Position(attrib, index.vertex_index);
+                const float* normal = index.normal_index >= 0 ? &attrib.normals[3 * static_cast<size_t>(index.normal_index)] : face;
+                float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+
+                GeometricTools::CompactVertexPN vertex;
+                for (int axis = 0; axis < 3; ++axis) {
+                    vertex.Position[axis] = GeometricTools::FloatToHalf(position[axis]);
+                }
+                vertex.Position[3] = GeometricTools::FloatToHalf(1.0f);
+                vertex.Normal = GeometricTools::PackInt2101010Rev(normal[0] * inverseLength, normal[1] * inverseLength, normal[2] * inverseLength);
+                corners.push_back(vertex);
+            }
+        }
+    }
+    if (corners.empty()) {
+        std::cerr << "The model " << sourcePath << " has no triangles" << std::endl;
+        return false;
+    }
+
+    std::vector<GeometricTools::CompactVertexPN> vertices;
+    std::vector<uint32_t> indices;
+    GeometricTools::WeldVertices(corners.data(), corners.size(), vertices, indices);
+    float missRatio = GeometricTools::AverageCacheMissRatio(indices.data(), indices.size(), vertices.size());
+    GeometricTools::OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+    float optimizedMissRatio = GeometricTools::AverageCacheMissRatio(indices.data(), indices.size(), vertices.size());
+    vertices.resize(GeometricTools::OptimizeVertexFetch(vertices.data(), vertices.size(), indices.data(), indices.size()));
+    std::cout << "Imported " << sourcePath << ": " << corners.size() << " corners welded to " << vertices.size()
+              << " vertices, " << missRatio << " -> " << optimizedMissRatio << " vertex transforms per triangle" << std::endl;
+
+    // vertices followed by the (possibly narrowed) indices, in one block
+    mesh.VertexSize = sizeof(GeometricTools::CompactVertexPN);
+    mesh.VertexCount = static_cast<uint32_t>(vertices.size());
+    mesh.IndexSize = vertices.size() <= 65536 ? 2 : 4;
+    mesh.IndexCount = static_cast<uint32_t>(indices.size());
+    size_t vertexBytes = static_cast<size_t>(mesh.VertexSize) * mesh.VertexCount;
+    mesh.Mapping.reset();
+    mesh.Storage.assign(vertexBytes + static_cast<size_t>(mesh.IndexSize) * mesh.IndexCount, 0);
+    std::memcpy(mesh.Storage.data(), vertices.data(), vertexBytes);
+    if (mesh.IndexSize == 2) {
+        std::vector<uint16_t> narrowed = GeometricTools::NarrowIndices<uint16_t>(indices);
+        std::memcpy(mesh.Storage.data() + vertexBytes, narrowed.data(), narrowed.size() * sizeof(uint16_t));
+    }
+    else {
+        std::memcpy(mesh.Storage.data() + vertexBytes, indices.data(), indices.size() * sizeof(uint32_t));
+    }
+    mesh.Vertices = mesh.Storage.data();
+    mesh.Indices = mesh.Storage.data() + vertexBytes;
+    return true;
+}
+
+std::string MeshCache::CachePath(const std::string& sourcePath)
+{
+    return sourcePath + ".meshcache";
+}
+
+bool MeshCache::Write(const std::string& sourcePath, uint64_t sourceHash, const ImportOptions& options, const Mesh& mesh)
+{
+    CacheHeader header = {};
+    std::memcpy(header.Magic, CacheMagic, sizeof(CacheMagic));
+    header.Version = CacheVersion;
+    header.SourceHash = sourceHash;
+    header.FitHalfExtent = options.FitHalfExtent;
+    header.VertexSize = mesh.VertexSize;
+    header.VertexCount = mesh.VertexCount;
+    header.IndexSize = mesh.IndexSize;
+    header.IndexCount = mesh.IndexCount;
+    header.VertexOffset = AlignUp(sizeof(CacheHeader));
+    header.IndexOffset = AlignUp(header.VertexOffset + mesh.VertexSize * mesh.VertexCount);
+
+    // write to a temporary file first so a crash never leaves a truncated entry behind
+    std::string cachePath = CachePath(sourcePath);
+    std::string temporaryPath = cachePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        static const char padding[CacheAlignment] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(padding, header.VertexOffset - sizeof(header));
+        file.write(reinterpret_cast<const char*>(mesh.Vertices), static_cast<std::streamsize>(mesh.VertexSize) * mesh.VertexCount);
+        file.write(padding, header.IndexOffset - (header.VertexOffset + mesh.VertexSize * mesh.VertexCount));
+        file.write(reinterpret_cast<const char*>(mesh.Indices), static_cast<std::streamsize>(mesh.IndexSize) * mesh.IndexCount);
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, cachePath, error);
+    return !error;
+}
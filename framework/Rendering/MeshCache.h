@@ -0,0 +1,68 @@
+#ifndef PROG2002_MESHCACHE_H
+#define PROG2002_MESHCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+/*
+ * GPU ready mesh container for OBJ models. A model is imported once with
+ * tinyobjloader: its triangles are quantized to GeometricTools::CompactVertexPN,
+ * duplicate vertices are welded and the mesh is reordered for the post-transform
+ * vertex cache and for vertex fetch locality (see MeshOptimization.h). The result
+ * is written next to the source ("<source>.meshcache"). Later runs map that file
+ * and hand the vertices and indices straight to the GPU buffers, e.g. with
+ * MeshArena::Add. Entries are keyed by a hash of the source file and the import
+ * options, so editing a model invalidates its cache entry automatically.
+ */
+class MeshCache
+{
+public:
+    struct ImportOptions
+    {
+        // > 0: center the model and scale it uniformly to fit into [-FitHalfExtent, FitHalfExtent]^3
+        float FitHalfExtent = 0.0f;
+    };
+
+    struct Mesh
+    {
+        Mesh() = default;
+        Mesh(Mesh&&) = default;
+        Mesh& operator=(Mesh&&) = default;
+        // Vertices and Indices point into Mapping or Storage, so meshes are move-only.
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+
+        uint32_t VertexSize = 0;  // bytes, sizeof(CompactVertexPN)
+        uint32_t VertexCount = 0;
+        uint32_t IndexSize = 0;   // 2 if all vertices can be addressed with 16 bits, else 4
+        uint32_t IndexCount = 0;
+        const unsigned char* Vertices = nullptr;
+        const unsigned char* Indices = nullptr;
+
+        // Keeps the data alive: either the mapped cache file or the imported mesh.
+        std::shared_ptr<MappedFile> Mapping;
+        std::vector<unsigned char> Storage;
+    };
+
+public:
+    // Map the cache entry of sourcePath, or import the model and store its entry if
+    // there is no valid one. Returns false (with a message) if the model cannot be read.
+    static bool LoadOrImport(const std::string& sourcePath, const ImportOptions& options, Mesh& mesh);
+
+    // Map the cache entry of sourcePath. Returns false if it is missing, stale or was
+    // imported with other options.
+    static bool Load(const std::string& sourcePath, uint64_t sourceHash, const ImportOptions& options, Mesh& mesh);
+
+    // Parse the OBJ file and build the optimized mesh on the CPU.
+    static bool Import(const std::string& sourcePath, const ImportOptions& options, Mesh& mesh);
+
+private:
+    static std::string CachePath(const std::string& sourcePath);
+    static bool Write(const std::string& sourcePath, uint64_t sourceHash, const ImportOptions& options, const Mesh& mesh);
+};
+
+#endif //PROG2002_MESHCACHE_H
@@ -0,0 +1,221 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <thread>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OCCLUSIONCULLER_SSE
+#endif
+
+namespace
+{
+    // corner i of a box has x from bit 0, y from bit 1 and z from bit 2;
+    // every face is listed counter-clockwise seen from outside
+    const int BoxFaces[6][4] = {
+        { 0, 4, 6, 2 }, // -x
+        { 1, 3, 7, 5 }, // +x
+        { 0, 1, 5, 4 }, // -y
+        { 2, 6, 7, 3 }, // +y
+        { 0, 2, 3, 1 }, // -z
+        { 4, 5, 7, 6 }  // +z
+    };
+
+    constexpr float MinClipW = 1e-4f;
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height, unsigned int threads)
+    : Width(width), Height(height), Stride((width + 3) & ~3), Threads(threads)
+{
+    if (this->Threads == 0) {
+        this->Threads = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+    }
+    this->Depth.assign(static_cast<size_t>(this->Stride) * this->Height, 1.0f);
+}
+
+void OcclusionCuller::Begin(const glm::mat4& viewProjection)
+{
+    this->ViewProjection = viewProjection;
+    std::fill(this->Depth.begin(), this->Depth.end(), 1.0f);
+    this->Triangles.clear();
+}
+
+bool OcclusionCuller::ProjectBox(const glm::vec3& center, const glm::vec3& halfExtent, glm::vec3 corners[8]) const
+{
+    for (int i = 0; i < 8; ++i) {
+        glm::vec4 corner(center.x + ((i & 1) ? halfExtent.x : -halfExtent.x),
+                         center.y + ((i & 2) ? halfExtent.y : -halfExtent.y),
+                         center.z + ((i & 4) ? halfExtent.z : -halfExtent.z), 1.0f);
+        glm::vec4 clip = this->ViewProjection * corner;
+        if (clip.w < MinClipW) {
+            return false;
+        }
+        // NDC -> buffer pixels (row 0 at the bottom) and depth in [0, 1]
+        corners[i] = glm::vec3((clip.x / clip.w * 0.5f + 0.5f) * this->Width,
+                               (clip.y / clip.w * 0.5f + 0.5f) * this->Height,
+                               clip.z / clip.w * 0.5f + 0.5f);
+    }
+    return true;
+}
+
+void OcclusionCuller::AddOccluder(const glm::vec3& center, const glm::vec3& halfExtent)
+{
+    glm::vec3 corners[8];
+    if (!ProjectBox(center, halfExtent, corners)) {
+        return;
+    }
+    for (const int* face : BoxFaces) {
+        for (int half = 0; half < 2; ++half) {
+            const glm::vec3& a = corners[face[0]];
+            const glm::vec3& b = corners[face[half + 1]];
+            const glm::vec3& c = corners[face[half + 2]];
+            // back faces are hidden by the front faces of the same box
+            float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (area <= 0.0f) {
+                continue;
+            }
+            this->Triangles.push_back({ { a.x, b.x, c.x }, { a.y, b.y, c.y }, { a.z, b.z, c.z } });
+        }
+    }
+}
+
+void OcclusionCuller::Rasterize()
+{
+    size_t bands = std::min<size_t>({ this->Threads, static_cast<size_t>(this->Height), this->Triangles.size() / this->MinTrianglesPerThread });
+    if (bands <= 1) {
+        RasterizeRows(0, this->Height);
+        return;
+    }
+
+    // every band writes its own rows only, so the bands need no synchronisation
+    int rowsPerBand = (this->Height + static_cast<int>(bands) - 1) / static_cast<int>(bands);
+    std::vector<std::future<void>> workers;
+    for (size_t band = 1; band < bands; ++band) {
+        int firstRow = static_cast<int>(band) * rowsPerBand;
+        int endRow = std::min(this->Height, firstRow + rowsPerBand);
+        workers.push_back(std::async(std::launch::async, &OcclusionCuller::RasterizeRows, this, firstRow, endRow));
+    }
+    RasterizeRows(0, std::min(this->Height, rowsPerBand));
+    for (std::future<void>& worker : workers) {
+        worker.get();
+    }
+}
+
+void OcclusionCuller::RasterizeRows(int firstRow, int endRow)
+{
+    for (const Triangle& triangle : this->Triangles) {
+        const float* x = triangle.x;
+        const float* y = triangle.y;
+        const float* z = triangle.z;
+
+        // pixel bounds of the triangle within the band (pixel centers at +0.5)
+        int minX = std::max(0, static_cast<int>(std::floor(std::min({ x[0], x[1], x[2] }) - 0.5f)));
+        int maxX = std::min(this->Width - 1, static_cast<int>(std::ceil(std::max({ x[0], x[1], x[2] }) - 0.5f)));
+        int minY = std::max(firstRow, static_cast<int>(std::floor(std::min({ y[0], y[1], y[2] }) - 0.5f)));
+        int maxY = std::min(endRow - 1, static_cast<int>(std::ceil(std::max({ y[0], y[1], y[2] }) - 0.5f)));
+        if (minX > maxX || minY > maxY) {
+            continue;
+        }
+
+        // edge function i is zero on the edge opposite vertex i and positive inside:
+        //   e_i(px, py) = a_i * px + b_i * py + c_i
+        float a[3], b[3], c[3];
+        for (int i = 0; i < 3; ++i) {
+            int j = (i + 1) % 3, k = (i + 2) % 3;
+            a[i] = y[j] - y[k];
+            b[i] = x[k] - x[j];
+            c[i] = x[j] * y[k] - x[k] * y[j];
+        }
+        float area = a[0] * x[0] + b[0] * y[0] + c[0]; // twice the triangle area
+        // depth = z0 + e1 / area * (z1 - z0) + e2 / area * (z2 - z0)
+        float dz1 = (z[1] - z[0]) / area;
+        float dz2 = (z[2] - z[0]) / area;
+
+        for (int row = minY; row <= maxY; ++row) {
+            float py = row + 0.5f;
+            float* depthRow = &this->Depth[static_cast<size_t>(row) * this->Stride];
+#ifdef OCCLUSIONCULLER_SSE
+            const int startX = minX & ~3; // the stride keeps the four lanes inside the row
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 laneX = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            __m128 e[3], step[3];
+            for (int i = 0; i < 3; ++i) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(startX)), laneX);
+                e[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[i]), px), _mm_set1_ps(b[i] * py + c[i]));
+                step[i] = _mm_set1_ps(a[i] * 4.0f);
+            }
+            const __m128 z0 = _mm_set1_ps(z[0]);
+            const __m128 vdz1 = _mm_set1_ps(dz1);
+            const __m128 vdz2 = _mm_set1_ps(dz2);
+            for (int column = startX; column <= maxX; column += 4) {
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)), _mm_cmpge_ps(e[2], zero));
+                if (_mm_movemask_ps(inside)) {
+                    __m128 depth = _mm_add_ps(z0, _mm_add_ps(_mm_mul_ps(e[1], vdz1), _mm_mul_ps(e[2], vdz2)));
+                    __m128 stored = _mm_loadu_ps(depthRow + column);
+                    __m128 nearest = _mm_min_ps(stored, depth);
+                    _mm_storeu_ps(depthRow + column, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, stored)));
+                }
+                for (int i = 0; i < 3; ++i) {
+                    e[i] = _mm_add_ps(e[i], step[i]);
+                }
+            }
+#else
+            for (int column = minX; column <= maxX; ++column) {
+                float px = column + 0.5f;
+                float e0 = a[0] * px + b[0] * py + c[0];
+                float e1 = a[1] * px + b[1] * py + c[1];
+                float e2 = a[2] * px + b[2] * py + c[2];
+                if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f) {
+                    float depth = z[0] + e1 * dz1 + e2 * dz2;
+                    depthRow[column] = std::min(depthRow[column], depth);
+                }
+            }
+#endif
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const glm::vec3& center, const glm::vec3& halfExtent) const
+{
+    glm::vec3 corners[8];
+    if (!ProjectBox(center, halfExtent, corners)) {
+        return true;
+    }
+
+    glm::vec3 lower = corners[0], upper = corners[0];
+    for (const glm::vec3& corner : corners) {
+        lower = glm::vec3(std::min(lower.x, corner.x), std::min(lower.y, corner.y), std::min(lower.z, corner.z));
+        upper = glm::vec3(std::max(upper.x, corner.x), std::max(upper.y, corner.y), std::max(upper.z, corner.z));
+    }
+    if (upper.x < 0.0f || upper.y < 0.0f || lower.x > this->Width || lower.y > this->Height || lower.z > 1.0f) {
+        return false; // outside the view
+    }
+
+    // pixels touched by the rectangle, grown by one pixel (see the class comment)
+    int minX = std::max(0, static_cast<int>(std::floor(lower.x)) - 1);
+    int maxX = std::min(this->Width - 1, static_cast<int>(std::floor(upper.x)) + 1);
+    int minY = std::max(0, static_cast<int>(std::floor(lower.y)) - 1);
+    int maxY = std::min(this->Height - 1, static_cast<int>(std::floor(upper.y)) + 1);
+
+    // visible as soon as one pixel of the rectangle is farther away than the nearest point of the box
+    for (int row = minY; row <= maxY; ++row) {
+        const float* depthRow = &this->Depth[static_cast<size_t>(row) * this->Stride];
+        int column = minX;
+#ifdef OCCLUSIONCULLER_SSE
+        const __m128 nearest = _mm_set1_ps(lower.z);
+        for (; column + 3 <= maxX; column += 4) {
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(depthRow + column), nearest))) {
+                return true;
+            }
+        }
+#endif
+        for (; column <= maxX; ++column) {
+            if (depthRow[column] >= lower.z) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,65 @@
+#ifndef PROG2002_OCCLUSIONCULLER_H
+#define PROG2002_OCCLUSIONCULLER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Software occlusion culling on the CPU. Large opaque boxes (occluders) are rasterised
+ * into a low resolution depth buffer, then the screen rectangles of candidate objects
+ * are tested against it before they are submitted to the GPU. No GL calls are made.
+ *
+ * The rasteriser evaluates the edge functions of four pixels at once with SSE (scalar
+ * fallback otherwise) and the buffer is split into horizontal bands that are filled
+ * on separate threads. Coverage is sampled at pixel centres, so a tested rectangle is
+ * grown by one pixel on every side to stay conservative along occluder silhouettes.
+ * Anything crossing the camera plane is treated as visible and is never an occluder.
+ */
+class OcclusionCuller
+{
+public:
+    // threads = 0 uses up to four hardware threads
+    explicit OcclusionCuller(int width = 128, int height = 128, unsigned int threads = 0);
+
+    // Start a new frame: clear the depth buffer and the occluder list.
+    void Begin(const glm::mat4& viewProjection);
+
+    // Axis aligned box given by its center and half size in world space.
+    void AddOccluder(const glm::vec3& center, const glm::vec3& halfExtent);
+
+    // Rasterise all occluders added since Begin().
+    void Rasterize();
+
+    // Below count triangles per band the occluders are rasterised on the calling thread only,
+    // as starting a thread costs more than it saves (default 128; tests lower it to force the bands).
+    void SetMinTrianglesPerThread(size_t count) { this->MinTrianglesPerThread = std::max<size_t>(1, count); }
+
+    // False if the box is hidden behind the rasterised occluders or outside the view.
+    bool IsVisible(const glm::vec3& center, const glm::vec3& halfExtent) const;
+
+    int GetWidth() const { return this->Width; }
+    int GetHeight() const { return this->Height; }
+    // depth in [0, 1] (1 = nothing rasterised), rows of GetStride() floats from the bottom up
+    const std::vector<float>& GetDepthBuffer() const { return this->Depth; }
+    int GetStride() const { return this->Stride; }
+
+private:
+    struct Triangle {
+        float x[3], y[3], z[3]; // buffer pixels and depth, counter-clockwise
+    };
+
+    // project the corners of a box; false if a corner is on or behind the camera plane
+    bool ProjectBox(const glm::vec3& center, const glm::vec3& halfExtent, glm::vec3 corners[8]) const;
+    void RasterizeRows(int firstRow, int endRow);
+
+    int Width, Height, Stride; // Stride: Width rounded up to a multiple of four
+    unsigned int Threads;
+    size_t MinTrianglesPerThread = 128;
+    glm::mat4 ViewProjection = glm::mat4(1.0f);
+    std::vector<float> Depth;
+    std::vector<Triangle> Triangles;
+};
+
+#endif //PROG2002_OCCLUSIONCULLER_H
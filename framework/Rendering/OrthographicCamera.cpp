@@ -17,5 +17,6 @@ void OrthographicCamera::RecalculateMatrix() {
     this->ViewMatrix = glm::translate(glm::mat4(1.0f), this->Position) *
                        glm::rotate(glm::mat4(1.0f), glm::radians(this->Rotation), glm::vec3(0.0f, 0.0f, 1.0f));
 
-    this->ViewProjectionMatrix = glm::mat4(1.0f);
+    // cached, so users upload one matrix instead of multiplying per object or per vertex
+    this->ViewProjectionMatrix = this->ProjectionMatrix * this->ViewMatrix;
 }
\ No newline at end of file
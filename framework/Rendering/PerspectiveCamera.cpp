@@ -19,9 +19,8 @@ void PerspectiveCamera::RecalculateMatrix() {
     this->ProjectionMatrix = glm::perspective(this->CameraFrustrum.angle, this->CameraFrustrum.width / this->CameraFrustrum.height,
                                               this->CameraFrustrum.near, this->CameraFrustrum.far);
     this->ViewMatrix = glm::lookAt(this->Position, this->LookAt, this->UpVector);
-
-    this->ViewProjectionMatrix = glm::mat4(1.0f);
-
+    // cached, so users upload one matrix instead of multiplying per object or per vertex
+    this->ViewProjectionMatrix = this->ProjectionMatrix * this->ViewMatrix;
 }
 
 void PerspectiveCamera::zoom(float zoomValue) {
@@ -0,0 +1,89 @@
+#include "RangeAllocator.h"
+
+#include <iostream>
+#include <iterator>
+
+RangeAllocator::RangeAllocator(uint32_t capacity) : Capacity(capacity), FreeUnits(0)
+{
+    if (capacity > 0) {
+        Insert(0, capacity);
+    }
+}
+
+bool RangeAllocator::Allocate(uint32_t count, uint32_t& first)
+{
+    auto fit = FreeBySize.lower_bound(count);
+    if (count == 0 || fit == FreeBySize.end()) {
+        return false;
+    }
+    uint32_t rangeFirst = fit->second;
+    uint32_t rangeCount = fit->first;
+    Erase(FreeByFirst.find(rangeFirst));
+    // the rest of the range stays free
+    if (rangeCount > count) {
+        Insert(rangeFirst + count, rangeCount - count);
+    }
+    first = rangeFirst;
+    return true;
+}
+
+void RangeAllocator::Free(uint32_t first, uint32_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    if (first + count > Capacity || first + count < first) {
+        std::cerr << "RangeAllocator: range " << first << "+" << count << " is outside the capacity of " << Capacity << std::endl;
+        return;
+    }
+
+    // merge with the free range after and the free range before it
+    auto next = FreeByFirst.lower_bound(first);
+    if (next != FreeByFirst.end() && next->first < first + count) {
+        std::cerr << "RangeAllocator: range " << first << "+" << count << " is already free" << std::endl;
+        return;
+    }
+    if (next != FreeByFirst.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second > first) {
+            std::cerr << "RangeAllocator: range " << first << "+" << count << " is already free" << std::endl;
+            return;
+        }
+        if (previous->first + previous->second == first) {
+            first = previous->first;
+            count += previous->second;
+            Erase(previous);
+        }
+    }
+    if (next != FreeByFirst.end() && next->first == first + count) {
+        count += next->second;
+        Erase(next);
+    }
+    Insert(first, count);
+}
+
+uint32_t RangeAllocator::GetLargestFreeRange() const
+{
+    return FreeBySize.empty() ? 0 : FreeBySize.rbegin()->first;
+}
+
+void RangeAllocator::Insert(uint32_t first, uint32_t count)
+{
+    FreeByFirst.emplace(first, count);
+    FreeBySize.emplace(count, first);
+    FreeUnits += count;
+}
+
+void RangeAllocator::Erase(std::map<uint32_t, uint32_t>::iterator range)
+{
+    // several free ranges can have the same size
+    auto sizes = FreeBySize.equal_range(range->second);
+    for (auto it = sizes.first; it != sizes.second; ++it) {
+        if (it->second == range->first) {
+            FreeBySize.erase(it);
+            break;
+        }
+    }
+    FreeUnits -= range->second;
+    FreeByFirst.erase(range);
+}
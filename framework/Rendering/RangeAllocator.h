@@ -0,0 +1,41 @@
+#ifndef PROG2002_RANGEALLOCATOR_H
+#define PROG2002_RANGEALLOCATOR_H
+
+#include <cstdint>
+#include <map>
+
+/*
+ * Free-list allocator of contiguous ranges in [0, capacity), in abstract units (vertices,
+ * indices, ...); it never touches the memory it manages. Allocation takes the smallest
+ * free range that fits (best fit, O(log n)) and freed ranges are merged with their free
+ * neighbours, so loading and unloading meshes of varying size keeps the free space in
+ * few large ranges.
+ */
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator(uint32_t capacity);
+
+    // First unit of count free units; false if no free range is large enough.
+    bool Allocate(uint32_t count, uint32_t& first);
+
+    // Return a range obtained from Allocate.
+    void Free(uint32_t first, uint32_t count);
+
+    uint32_t GetCapacity() const { return Capacity; }
+    uint32_t GetFreeUnits() const { return FreeUnits; }
+    // the largest count Allocate can currently satisfy
+    uint32_t GetLargestFreeRange() const;
+
+private:
+    void Insert(uint32_t first, uint32_t count);
+    void Erase(std::map<uint32_t, uint32_t>::iterator range);
+
+private:
+    uint32_t Capacity;
+    uint32_t FreeUnits;
+    std::map<uint32_t, uint32_t> FreeByFirst;     // first unit -> count, to find the neighbours
+    std::multimap<uint32_t, uint32_t> FreeBySize; // count -> first unit, for the best fit
+};
+
+#endif //PROG2002_RANGEALLOCATOR_H
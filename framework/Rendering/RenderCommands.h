@@ -1,9 +1,12 @@
 #ifndef PROG2002_RENDERCOMMANDS_H
 #define PROG2002_RENDERCOMMANDS_H
 
+#include <cstdint>
 #include <memory>
 #include "glad/glad.h"
 #include "VertextArray.h"
+#include "MeshArena.h"
+#include "RenderStats.h"
 
 namespace RenderCommands
 {
@@ -20,7 +23,39 @@ namespace RenderCommands
     inline void DrawIndex(GLenum primitive, const std::shared_ptr<VertexArray>& vao)
     {
         vao->Bind();
-        glDrawElements(primitive, vao->GetIndexBuffer()->GetCount(), GL_UNSIGNED_INT, nullptr);
+        glDrawElements(primitive, vao->GetIndexBuffer()->GetCount(), vao->GetIndexBuffer()->GetType(), nullptr);
+        RenderStatistics::CountDraw(primitive, vao->GetIndexBuffer()->GetCount());
+    }
+    // draw instanceCount instances, reading the per-instance attributes from baseInstance onwards
+    inline void DrawIndexInstanced(GLenum primitive, const std::shared_ptr<VertexArray>& vao, GLsizei instanceCount,
+                                   GLuint baseInstance = 0)
+    {
+        vao->Bind();
+        glDrawElementsInstancedBaseInstance(primitive, vao->GetIndexBuffer()->GetCount(), vao->GetIndexBuffer()->GetType(),
+                                            nullptr, instanceCount, baseInstance);
+        RenderStatistics::CountDraw(primitive, vao->GetIndexBuffer()->GetCount(), instanceCount);
+    }
+    // draw count vertices without an index buffer, e.g. a full-screen triangle built from gl_VertexID
+    inline void DrawArrays(GLenum primitive, const std::shared_ptr<VertexArray>& vao, GLsizei count)
+    {
+        vao->Bind();
+        glDrawArrays(primitive, 0, count);
+        RenderStatistics::CountDraw(primitive, count);
+    }
+    // draw a mesh of the arena; the arena must be bound (MeshArena::Bind), once for all of its meshes
+    inline void DrawMesh(GLenum primitive, const MeshArena& arena, const MeshAllocation& mesh)
+    {
+        glDrawElementsBaseVertex(primitive, mesh.IndexCount, arena.GetIndexType(),
+                                 (const void *) (uintptr_t) (arena.GetIndexSize() * mesh.FirstIndex), mesh.BaseVertex);
+        RenderStatistics::CountDraw(primitive, mesh.IndexCount);
+    }
+    inline void DrawMeshInstanced(GLenum primitive, const MeshArena& arena, const MeshAllocation& mesh, GLsizei instanceCount,
+                                  GLuint baseInstance = 0)
+    {
+        glDrawElementsInstancedBaseVertexBaseInstance(primitive, mesh.IndexCount, arena.GetIndexType(),
+                                                      (const void *) (uintptr_t) (arena.GetIndexSize() * mesh.FirstIndex),
+                                                      instanceCount, mesh.BaseVertex, baseInstance);
+        RenderStatistics::CountDraw(primitive, mesh.IndexCount, instanceCount);
     }
     inline void SetClearColor(float r, float g, float b, float a)
     {
@@ -0,0 +1,40 @@
+#include "RenderStats.h"
+
+#include <iostream>
+
+namespace
+{
+    RenderStats LastFrameStats;
+    unsigned int LogInterval = 0;
+    unsigned long long FrameNumber = 0;
+}
+
+const RenderStats& RenderStatistics::LastFrame()
+{
+    return LastFrameStats;
+}
+
+void RenderStatistics::EndFrame()
+{
+    LastFrameStats = CurrentFrame;
+    CurrentFrame = RenderStats();
+    FrameNumber++;
+
+    if (LogInterval != 0 && FrameNumber % LogInterval == 0) {
+        const RenderStats& stats = LastFrameStats;
+        std::cout << "Frame " << FrameNumber
+                  << ": draws " << stats.DrawCalls
+                  << ", triangles " << stats.Triangles
+                  << ", program binds " << stats.ProgramBinds
+                  << ", VAO binds " << stats.VertexArrayBinds
+                  << ", texture binds " << stats.TextureBinds
+                  << ", uniform uploads " << stats.UniformUploads
+                  << ", uniform lookups " << stats.UniformLocationLookups
+                  << ", buffer bytes " << stats.BufferBytesUploaded << std::endl;
+    }
+}
+
+void RenderStatistics::SetLogInterval(unsigned int frames)
+{
+    LogInterval = frames;
+}
@@ -0,0 +1,60 @@
+#ifndef PROG2002_RENDERSTATS_H
+#define PROG2002_RENDERSTATS_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+// GL work issued by the rendering framework during one frame.
+struct RenderStats
+{
+    uint32_t DrawCalls = 0;
+    uint64_t Triangles = 0;
+    uint32_t ProgramBinds = 0;
+    uint32_t VertexArrayBinds = 0;
+    uint32_t TextureBinds = 0;
+    uint32_t UniformUploads = 0;
+    uint32_t UniformLocationLookups = 0; // glGetUniformLocation calls
+    uint64_t BufferBytesUploaded = 0;    // glBufferData / glBufferSubData with data
+};
+
+/*
+ * Per-frame counters filled in by RenderCommands, Shader, VertexArray, the buffers and
+ * TextureManager. Call EndFrame() once per frame (on the GL thread) to publish the counts
+ * of the finished frame and start from zero.
+ */
+namespace RenderStatistics
+{
+    // counts of the frame being recorded
+    inline RenderStats CurrentFrame;
+
+    // Counts of the last finished frame.
+    const RenderStats& LastFrame();
+
+    // Publish the current counts, print them every logInterval frames and reset them.
+    void EndFrame();
+
+    // Print the counters every `frames` frames; 0 disables the log.
+    void SetLogInterval(unsigned int frames);
+
+    inline void CountDraw(GLenum primitive, GLsizei indexCount, GLsizei instanceCount = 1)
+    {
+        CurrentFrame.DrawCalls++;
+        uint64_t primitives = 0;
+        switch (primitive) {
+            case GL_TRIANGLES:      primitives = static_cast<uint64_t>(indexCount / 3); break;
+            case GL_TRIANGLE_STRIP:
+            case GL_TRIANGLE_FAN:   primitives = indexCount > 2 ? static_cast<uint64_t>(indexCount - 2) : 0; break;
+            default: break;
+        }
+        CurrentFrame.Triangles += primitives * static_cast<uint64_t>(instanceCount);
+    }
+    inline void CountProgramBind() { CurrentFrame.ProgramBinds++; }
+    inline void CountVertexArrayBind() { CurrentFrame.VertexArrayBinds++; }
+    inline void CountTextureBind() { CurrentFrame.TextureBinds++; }
+    inline void CountUniformUpload() { CurrentFrame.UniformUploads++; }
+    inline void CountUniformLocationLookup() { CurrentFrame.UniformLocationLookups++; }
+    inline void CountBufferUpload(GLsizeiptr bytes) { CurrentFrame.BufferBytesUploaded += static_cast<uint64_t>(bytes); }
+}
+
+#endif //PROG2002_RENDERSTATS_H
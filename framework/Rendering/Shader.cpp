@@ -1,50 +1,226 @@
 #include "Shader.h"
+#include "BindlessTexture.h"
+#include "MappedFile.h"
+#include "RenderStats.h"
 #include <glad/glad.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
 #include <string>
 #include <glm/glm.hpp>
 #include <iostream>
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    constexpr char BinaryMagic[4] = {'P', 'B', 'C', '1'};
+#ifndef GL_COMPLETION_STATUS_KHR
+    constexpr GLenum GL_COMPLETION_STATUS_KHR = 0x91B1;
+#endif
+
+    typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+    // GL_KHR_parallel_shader_compile (or its ARB twin), detected once per process
+    bool ParallelCompileSupported()
+    {
+        static int supported = -1;
+        if (supported < 0) {
+            supported = 0;
+            const char* names[2][2] = {{"GL_KHR_parallel_shader_compile", "glMaxShaderCompilerThreadsKHR"},
+                                       {"GL_ARB_parallel_shader_compile", "glMaxShaderCompilerThreadsARB"}};
+            for (const auto& name : names) {
+                if (!glfwExtensionSupported(name[0])) continue;
+                auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress(name[1]));
+                if (maxThreads) {
+                    // let the driver pick the number of compiler threads
+                    maxThreads(0xFFFFFFFFu);
+                    supported = 1;
+                    break;
+                }
+            }
+        }
+        return supported == 1;
+    }
+
+    unsigned long long Hash(unsigned long long hash, const char* text)
+    {
+        // 64-bit FNV-1a
+        for (; text && *text; ++text) {
+            hash ^= static_cast<unsigned char>(*text);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    void PrintShaderLog(GLuint shader, const char* stage)
+    {
+        GLint logSize;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logSize);
+        std::vector<GLchar> infoLog(std::max(logSize, 1));
+        glGetShaderInfoLog(shader, logSize, NULL, infoLog.data());
+        std::cerr << stage << " shader compilation failed: " << infoLog.data() << std::endl;
+    }
+}
 
 Shader::Shader(const std::string& vertexShaderSrc, const std::string& fragmentShaderSrc)
 {
+    ParallelCompileSupported();
+
+    // the driver strings are part of the key: a driver update invalidates all binaries
+    CacheKey = 14695981039346656037ull;
+    CacheKey = Hash(CacheKey, vertexShaderSrc.c_str());
+    CacheKey = Hash(CacheKey, "\n#fragment\n");
+    CacheKey = Hash(CacheKey, fragmentShaderSrc.c_str());
+    CacheKey = Hash(CacheKey, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    CacheKey = Hash(CacheKey, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    CacheKey = Hash(CacheKey, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+    ShaderProgram = glCreateProgram();
+    if (LoadBinary()) {
+        Linked = true;
+        return;
+    }
+
     // Compile vertex shader, fragment shader
     VertexShader = CompileShader(GL_VERTEX_SHADER, vertexShaderSrc.c_str());
     FragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSrc.c_str());
 
-    // Create shader program and attach compiled shaders
-    ShaderProgram = glCreateProgram();
+    // Attach compiled shaders and start linking. Nothing here waits for the driver.
     glAttachShader(ShaderProgram, VertexShader);
     glAttachShader(ShaderProgram, FragmentShader);
+    glProgramParameteri(ShaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(ShaderProgram);
+}
+
+
+Shader::~Shader()
+{
+    glDeleteProgram(ShaderProgram);
+}
+
+
+bool Shader::IsReady() const
+{
+    if (Linked || !ParallelCompileSupported()) {
+        return true;
+    }
+    GLint completed = GL_FALSE;
+    glGetProgramiv(ShaderProgram, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+}
+
+
+void Shader::Bind() const
+{
+    if (!Linked) {
+        FinishLinking();
+    }
+    glUseProgram(ShaderProgram);
+    RenderStatistics::CountProgramBind();
+}
+
+
+void Shader::FinishLinking() const
+{
+    Linked = true;
 
     GLint success;
+    glGetShaderiv(VertexShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        PrintShaderLog(VertexShader, "Vertex");
+    }
+    glGetShaderiv(FragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        PrintShaderLog(FragmentShader, "Fragment");
+    }
+
     glGetProgramiv(ShaderProgram, GL_LINK_STATUS, &success);
     if (!success) {
         GLint logSize;
         glGetProgramiv(ShaderProgram, GL_INFO_LOG_LENGTH, &logSize);
-        std::vector<GLchar> infoLog(logSize);
+        std::vector<GLchar> infoLog(std::max(logSize, 1));
         glGetProgramInfoLog(ShaderProgram, logSize, NULL, infoLog.data());
 
         std::cerr << "Shader program linking failed: " << infoLog.data() << std::endl;
     }
     else {
         // Successful linking, no need to call glUseProgram(ShaderProgram) here.
-        glDeleteShader(VertexShader);
-        glDeleteShader(FragmentShader);
+        StoreBinary();
     }
+
+    glDetachShader(ShaderProgram, VertexShader);
+    glDetachShader(ShaderProgram, FragmentShader);
+    glDeleteShader(VertexShader);
+    glDeleteShader(FragmentShader);
 }
 
 
-Shader::~Shader()
+std::string Shader::CachePath() const
 {
-    glDeleteProgram(ShaderProgram);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", CacheKey);
+    return CacheDirectory + "/" + name;
 }
 
 
-void Shader::Bind() const
+bool Shader::LoadBinary()
 {
-    glUseProgram(ShaderProgram);
+    if (CacheDirectory.empty()) {
+        return false;
+    }
+
+    // layout: magic, binary format, binary
+    MappedFile file(CachePath());
+    const size_t headerSize = sizeof(BinaryMagic) + sizeof(GLenum);
+    if (!file.IsOpen() || file.GetSize() <= headerSize
+        || std::memcmp(file.GetData(), BinaryMagic, sizeof(BinaryMagic)) != 0) {
+        return false;
+    }
+
+    GLenum format;
+    std::memcpy(&format, file.GetData() + sizeof(BinaryMagic), sizeof(format));
+    glProgramBinary(ShaderProgram, format, file.GetData() + headerSize, static_cast<GLsizei>(file.GetSize() - headerSize));
+
+    // the driver may reject binaries (e.g. after an update with the same version string)
+    GLint success;
+    glGetProgramiv(ShaderProgram, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+
+void Shader::StoreBinary() const
+{
+    if (CacheDirectory.empty()) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(ShaderProgram, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    GLenum format;
+    std::vector<char> binary(length);
+    glGetProgramBinary(ShaderProgram, length, nullptr, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(CacheDirectory, error);
+    std::string path = CachePath();
+    {
+        std::ofstream file(path + ".tmp", std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return;
+        }
+        file.write(BinaryMagic, sizeof(BinaryMagic));
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(binary.data(), binary.size());
+    }
+    std::filesystem::rename(path + ".tmp", path, error);
 }
 
 
@@ -54,40 +230,54 @@ void Shader::Unbind() const
 }
 
 void Shader::UploadUniformFloat1(const std::string& name, const GLfloat number) {
-    GLuint location = glGetUniformLocation(ShaderProgram, name.c_str());
+    GLint location = UniformLocation(name);
     glUniform1f(location, number);
 }
 
 void Shader::UploadUniformFloat2(const std::string& name, const glm::vec2& vector)
 {
-    GLuint location = glGetUniformLocation(ShaderProgram, name.c_str());
+    GLint location = UniformLocation(name);
     glUniform2f(location, vector.x, vector.y);
 }
 
 void Shader::UploadUniformFloat3(const std::string& name, const glm::vec3& vector)
 {
-    GLuint location = glGetUniformLocation(ShaderProgram, name.c_str());
+    GLint location = UniformLocation(name);
     glUniform3f(location, vector[0], vector[1], vector[2]);
 }
 
 void Shader::UploadUniformFloat4(const std::string& name, const glm::vec4& vector)
 {
-    GLuint location = glGetUniformLocation(ShaderProgram, name.c_str());
+    GLint location = UniformLocation(name);
     glUniform4f(location, vector[0], vector[1], vector[2], vector[3]);
 }
 
 void Shader::UploadUniformMatrix4fv(const std::string& name, const glm::mat4& matrix) {
-    GLuint location = glGetUniformLocation(ShaderProgram, name.c_str());
+    GLint location = UniformLocation(name);
     glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 void Shader::UploadUniform1i(const std::string& name, const GLuint slot) {
-    GLuint location = glGetUniformLocation(ShaderProgram, name.c_str());
+    GLint location = UniformLocation(name);
     glUniform1i(location, slot);
 }
 
+void Shader::UploadUniformHandle(const std::string& name, const GLuint64 handle) {
+    GLint location = UniformLocation(name);
+    BindlessTexture::UniformHandle(location, handle);
+}
+
+GLint Shader::UniformLocation(const std::string& name) const
+{
+    // every upload currently looks its location up again
+    RenderStatistics::CountUniformUpload();
+    RenderStatistics::CountUniformLocationLookup();
+    return glGetUniformLocation(ShaderProgram, name.c_str());
+}
+
 GLuint Shader::CompileShader(GLenum shaderType, const char * shaderSrc)
 {
+    // the compile status is checked in FinishLinking, after the link has been started
     auto shader = glCreateShader(shaderType);
     glShaderSource(shader, 1, &shaderSrc , nullptr);
     glCompileShader(shader);
@@ -8,9 +8,20 @@
 class Shader
 {
 public:
+	// Linked programs are cached on disk (glGetProgramBinary) keyed by a hash of the
+	// sources and the driver/GL version strings, and reloaded with glProgramBinary.
+	// On a cache miss the compile and link are only started here; their status is
+	// queried on the first Bind(), so several programs can compile in parallel.
 	Shader(const std::string& vertexSrc, const std::string& fragmentSrc);
 	~Shader();
 
+	// True once the program can be bound without waiting for the driver. Without
+	// GL_KHR_parallel_shader_compile this cannot be known and is always true.
+	bool IsReady() const;
+
+	// Directory of the program binary cache. An empty path disables the cache.
+	static void SetCacheDirectory(const std::string& directory) { CacheDirectory = directory; }
+
 	void Bind() const;
 	void Unbind() const;
 	void UploadUniformFloat1(const std::string& name, const GLfloat number);
@@ -20,12 +31,26 @@ public:
 	void UploadUniformMatrix4fv(const std::string& name, const glm::mat4& matrix);
 
 	void UploadUniform1i(const std::string& name, const GLuint slot);
+	// Set a layout(bindless_sampler) uniform to a resident GL_ARB_bindless_texture handle.
+	void UploadUniformHandle(const std::string& name, const GLuint64 handle);
 
 private:
-	GLuint VertexShader;
-	GLuint FragmentShader;
+	GLuint VertexShader = 0;
+	GLuint FragmentShader = 0;
 	GLuint ShaderProgram; 
 	GLuint CompileShader(GLenum shaderType, const char * shaderSrc);
+	GLint UniformLocation(const std::string& name) const;
+
+	// Query compile/link status, report errors and store the binary (once).
+	void FinishLinking() const;
+	bool LoadBinary();
+	void StoreBinary() const;
+	std::string CachePath() const;
+
+	mutable bool Linked = false;
+	unsigned long long CacheKey = 0;
+
+	inline static std::string CacheDirectory = "shadercache";
 };
 
 #endif //PROG2002_SHADER_H
\ No newline at end of file
@@ -21,7 +21,15 @@ enum class ShaderDataType
     Int2,
     Int3,
     Int4,
-    Bool
+    Bool,
+    // Compact vertex formats. Half2/Half4 hold 16-bit floats, Int2101010Rev
+    // packs a signed xyz(w) triple into 32 bits (GL_INT_2_10_10_10_REV) and
+    // UByte4 holds four 8-bit channels. Int2101010Rev and UByte4 are meant
+    // to be used with a normalized BufferAttribute.
+    Half2,
+    Half4,
+    Int2101010Rev,
+    UByte4
 };
 
 // =============================================================================
@@ -42,6 +50,10 @@ constexpr GLsizei ShaderDataTypeSize(ShaderDataType type)
         case ShaderDataType::Int3: return 4 * 3;
         case ShaderDataType::Int4: return 4 * 4;
         case ShaderDataType::Bool: return 1;
+        case ShaderDataType::Half2: return 2 * 2;
+        case ShaderDataType::Half4: return 2 * 4;
+        case ShaderDataType::Int2101010Rev: return 4;
+        case ShaderDataType::UByte4: return 4;
         case ShaderDataType::None: return 0;
     }
 
@@ -63,6 +75,10 @@ constexpr GLenum ShaderDataTypeToOpenGLBaseType(ShaderDataType type)
         case ShaderDataType::Int3: return GL_INT;
         case ShaderDataType::Int4: return GL_INT;
         case ShaderDataType::Bool: return GL_INT;
+        case ShaderDataType::Half2: return GL_HALF_FLOAT;
+        case ShaderDataType::Half4: return GL_HALF_FLOAT;
+        case ShaderDataType::Int2101010Rev: return GL_INT_2_10_10_10_REV;
+        case ShaderDataType::UByte4: return GL_UNSIGNED_BYTE;
         case ShaderDataType::None: return GL_INT;
     }
 
@@ -84,6 +100,10 @@ constexpr GLsizei ShaderDataTypeComponentCount(ShaderDataType type)
         case ShaderDataType::Int3: return 3;
         case ShaderDataType::Int4: return 4;
         case ShaderDataType::Bool: return 1;
+        case ShaderDataType::Half2: return 2;
+        case ShaderDataType::Half4: return 4;
+        case ShaderDataType::Int2101010Rev: return 4;
+        case ShaderDataType::UByte4: return 4;
         case ShaderDataType::None: return 0;
     }
 
@@ -0,0 +1,58 @@
+#include "ShaderPermutations.h"
+
+#include <iostream>
+
+ShaderPermutations::ShaderPermutations(const std::string& vertexSrc, const std::string& fragmentSrc,
+                                       const std::vector<std::string>& features)
+    : VertexSource(vertexSrc), FragmentSource(fragmentSrc), Features(features)
+{
+    if (this->Features.size() > 32) {
+        std::cerr << "Too many shader features: only the first 32 can be selected" << std::endl;
+        this->Features.resize(32);
+    }
+}
+
+Shader& ShaderPermutations::Get(uint32_t featureMask)
+{
+    auto variant = this->Variants.find(featureMask);
+    if (variant != this->Variants.end()) {
+        return *variant->second;
+    }
+
+    auto shader = std::make_unique<Shader>(Specialize(this->VertexSource, featureMask),
+                                           Specialize(this->FragmentSource, featureMask));
+    Shader& created = *shader;
+    this->Variants.emplace(featureMask, std::move(shader));
+    return created;
+}
+
+void ShaderPermutations::Precompile(std::initializer_list<uint32_t> featureMasks)
+{
+    // the Shader constructor only starts the compile, so this does not wait for the driver
+    for (uint32_t featureMask : featureMasks) {
+        Get(featureMask);
+    }
+}
+
+std::string ShaderPermutations::Specialize(const std::string& source, uint32_t featureMask) const
+{
+    std::string defines;
+    for (size_t feature = 0; feature < this->Features.size(); ++feature) {
+        if (featureMask & (1u << feature)) {
+            defines += "#define " + this->Features[feature] + "\n";
+        }
+    }
+
+    // "#version" has to stay the first directive, so the defines go on the line after it
+    size_t version = source.find("#version");
+    if (version == std::string::npos) {
+        return defines + source;
+    }
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) {
+        return source + "\n" + defines;
+    }
+    std::string specialized = source;
+    specialized.insert(lineEnd + 1, defines);
+    return specialized;
+}
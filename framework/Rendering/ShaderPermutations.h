@@ -0,0 +1,42 @@
+#ifndef PROG2002_SHADERPERMUTATIONS_H
+#define PROG2002_SHADERPERMUTATIONS_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+/*
+ * Specialised variants of one vertex/fragment shader pair. Bit i of a feature
+ * mask enables the preprocessor symbol features[i]; its "#define" is inserted
+ * right after the "#version" line of both sources, so the shader selects the
+ * code paths with #ifdef at compile time instead of branching on uniforms.
+ * Every variant is compiled on first use and cached by its mask.
+ */
+class ShaderPermutations
+{
+public:
+    ShaderPermutations(const std::string& vertexSrc, const std::string& fragmentSrc,
+                       const std::vector<std::string>& features);
+
+    // The program for featureMask, compiled (or loaded from the binary cache) on first use.
+    Shader& Get(uint32_t featureMask);
+
+    // Start compiling the given variants now, so they compile in parallel and
+    // switching to them later does not stall.
+    void Precompile(std::initializer_list<uint32_t> featureMasks);
+
+private:
+    std::string Specialize(const std::string& source, uint32_t featureMask) const;
+
+    std::string VertexSource;
+    std::string FragmentSource;
+    std::vector<std::string> Features;
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> Variants;
+};
+
+#endif //PROG2002_SHADERPERMUTATIONS_H
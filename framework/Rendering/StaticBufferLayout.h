@@ -0,0 +1,101 @@
+#ifndef PROG2002_STATICBUFFERLAYOUT_H
+#define PROG2002_STATICBUFFERLAYOUT_H
+
+#include "ShaderDataTypes.h"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+/*
+ * Compile-time counterpart of BufferLayout: the attributes of a vertex struct with
+ * their offsets taken from the struct itself, so the stride and offsets cannot drift
+ * from the C++ type. A vertex type describes its attributes in a static constexpr
+ * Layout() function (or in a VertexLayoutOf specialisation for types that cannot
+ * be changed), in member order:
+ *
+ *   struct Vertex {
+ *       float Position[3];
+ *       uint8_t Color[4];
+ *       static constexpr auto Layout() {
+ *           return std::array{ VERTEX_ATTRIBUTE(Vertex, Position, ShaderDataType::Float3, false),
+ *                              VERTEX_ATTRIBUTE(Vertex, Color, ShaderDataType::UByte4, true) };
+ *       }
+ *   };
+ *   static_assert(MatchesShaderInputs<Vertex>({ ShaderDataType::Float3, ShaderDataType::Float4 }));
+ *   vertexArray->AddVertexBuffer<Vertex>(vertexBuffer);
+ *
+ * StaticBufferLayout<Vertex> rejects, at compile time, attributes whose type does not
+ * have the size of their member and layouts that leave gaps in the struct.
+ */
+struct StaticAttribute {
+    ShaderDataType Type;
+    GLuint Offset;
+    GLboolean Normalized;
+    size_t MemberSize; // sizeof the struct member, checked against ShaderDataTypeSize(Type)
+};
+
+#define VERTEX_ATTRIBUTE(VertexType, member, type, normalized) \
+    StaticAttribute{ (type), static_cast<GLuint>(offsetof(VertexType, member)), static_cast<GLboolean>(normalized), sizeof(VertexType::member) }
+
+// specialise for vertex types without a Layout() function
+template<typename Vertex>
+struct VertexLayoutOf {
+    static constexpr auto Get() { return Vertex::Layout(); }
+};
+
+namespace StaticLayoutDetail {
+    // integer attributes are read with glVertexAttribIPointer (see VertexArray::AddBuffer)
+    constexpr bool IsIntegerInput(ShaderDataType type, bool normalized) {
+        return ShaderDataTypeToOpenGLBaseType(type) == GL_INT && !normalized;
+    }
+
+    template<size_t N>
+    constexpr bool SizesMatch(const std::array<StaticAttribute, N>& attributes) {
+        for (const StaticAttribute& attribute : attributes) {
+            if (static_cast<size_t>(ShaderDataTypeSize(attribute.Type)) != attribute.MemberSize) return false;
+        }
+        return true;
+    }
+
+    // in member order, each attribute starting where the previous one ends, up to the end of the struct
+    template<size_t N>
+    constexpr bool CoversStruct(const std::array<StaticAttribute, N>& attributes, size_t structSize) {
+        size_t end = 0;
+        for (const StaticAttribute& attribute : attributes) {
+            if (attribute.Offset != end) return false;
+            end += attribute.MemberSize;
+        }
+        return end == structSize;
+    }
+}
+
+template<typename Vertex>
+struct StaticBufferLayout {
+    static_assert(std::is_standard_layout<Vertex>::value, "offsetof needs a standard layout vertex type");
+
+    static constexpr auto Attributes = VertexLayoutOf<Vertex>::Get();
+    static constexpr GLsizei Stride = static_cast<GLsizei>(sizeof(Vertex));
+
+    static_assert(StaticLayoutDetail::SizesMatch(Attributes), "a vertex attribute type does not have the size of its member");
+    static_assert(StaticLayoutDetail::CoversStruct(Attributes, sizeof(Vertex)), "the vertex attributes must cover the struct in member order without gaps");
+};
+
+/*
+ * True if the attributes of Vertex feed shader inputs of the given types, one per location
+ * (Float3 for "in vec3", Int for "in int", ...): the same number of inputs, integer inputs
+ * only from non-normalized integer attributes and no input wider than its attribute.
+ */
+template<typename Vertex, size_t N>
+constexpr bool MatchesShaderInputs(const ShaderDataType (&inputs)[N]) {
+    constexpr auto attributes = StaticBufferLayout<Vertex>::Attributes;
+    if (attributes.size() != N) return false;
+    for (size_t i = 0; i < N; ++i) {
+        const StaticAttribute& attribute = attributes[i];
+        if (StaticLayoutDetail::IsIntegerInput(attribute.Type, attribute.Normalized) != (ShaderDataTypeToOpenGLBaseType(inputs[i]) == GL_INT)) return false;
+        if (ShaderDataTypeComponentCount(inputs[i]) > ShaderDataTypeComponentCount(attribute.Type)) return false;
+    }
+    return true;
+}
+
+#endif //PROG2002_STATICBUFFERLAYOUT_H
@@ -0,0 +1,434 @@
+#include "TextureCache.h"
+#include "RenderStats.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    constexpr char CacheMagic[4] = {'T', 'X', 'C', '1'};
+    constexpr uint32_t CacheVersion = 1;
+    constexpr uint32_t CacheAlignment = 16;
+    constexpr uint32_t MaxTextureSize = 16384;
+
+    struct CacheHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t SourceHash;
+        uint32_t InternalFormat;
+        uint32_t Compressed;
+        uint32_t LevelCount;
+        uint32_t Reserved;
+    };
+
+    struct CacheLevel
+    {
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t Size;
+        uint32_t Offset; // from the start of the file
+    };
+
+    uint32_t AlignUp(uint32_t value)
+    {
+        return (value + CacheAlignment - 1) & ~(CacheAlignment - 1);
+    }
+
+    // bytes of a width x height level, 0 for formats the cache never writes
+    uint64_t LevelSize(uint32_t internalFormat, bool compressed, uint32_t width, uint32_t height)
+    {
+        if (!compressed && internalFormat == GL_RGBA8) {
+            return static_cast<uint64_t>(width) * height * 4;
+        }
+        if (compressed && internalFormat == GL_COMPRESSED_RGBA_BPTC_UNORM) {
+            return ((static_cast<uint64_t>(width) + 3) / 4) * ((static_cast<uint64_t>(height) + 3) / 4) * 16;
+        }
+        return 0;
+    }
+}
+
+uint64_t TextureCache::HashFile(const std::string& filePath)
+{
+    MappedFile file(filePath);
+    if (!file.IsOpen()) {
+        return 0;
+    }
+
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char* data = file.GetData();
+    for (size_t i = 0; i < file.GetSize(); ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool TextureCache::Load(const std::string& sourcePath, uint64_t sourceHash, bool mipMap, Image& image)
+{
+    auto mapping = std::make_shared<MappedFile>(CachePath(sourcePath));
+    if (!mapping->IsOpen() || mapping->GetSize() < sizeof(CacheHeader)) {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, mapping->GetData(), sizeof(header));
+    if (std::memcmp(header.Magic, CacheMagic, sizeof(CacheMagic)) != 0 || header.Version != CacheVersion
+        || header.SourceHash != sourceHash || header.LevelCount == 0) {
+        return false;
+    }
+
+    size_t tableEnd = sizeof(CacheHeader) + sizeof(CacheLevel) * header.LevelCount;
+    if (mapping->GetSize() < tableEnd) {
+        return false;
+    }
+
+    // the level table is trusted no further than the file: every level has to be the half of the
+    // one before (down to 1x1) and exactly as large as its format needs, so the upload never reads
+    // past the mapping
+    std::vector<MipLevel> levels;
+    CacheLevel previous = {};
+    for (uint32_t i = 0; i < header.LevelCount; ++i) {
+        CacheLevel level;
+        std::memcpy(&level, mapping->GetData() + sizeof(CacheHeader) + sizeof(CacheLevel) * i, sizeof(level));
+        if (i == 0) {
+            if (level.Width == 0 || level.Height == 0 || level.Width > MaxTextureSize || level.Height > MaxTextureSize) {
+                return false;
+            }
+        } else if ((previous.Width == 1 && previous.Height == 1) || level.Width != std::max(1u, previous.Width / 2)
+                   || level.Height != std::max(1u, previous.Height / 2)) {
+            return false;
+        }
+        uint64_t expectedSize = LevelSize(header.InternalFormat, header.Compressed != 0, level.Width, level.Height);
+        if (expectedSize == 0 || level.Size != expectedSize || level.Offset < tableEnd
+            || static_cast<uint64_t>(level.Offset) + level.Size > mapping->GetSize()) {
+            return false;
+        }
+        previous = level;
+        levels.push_back({static_cast<GLsizei>(level.Width), static_cast<GLsizei>(level.Height),
+                          static_cast<GLsizei>(level.Size), mapping->GetData() + level.Offset});
+    }
+
+    // a single level image is fine for a mip-mapped request only if it is 1x1
+    if (mipMap && (levels[0].Width > 1 || levels[0].Height > 1) && levels.size() == 1) {
+        return false;
+    }
+
+    image.InternalFormat = header.InternalFormat;
+    image.Compressed = header.Compressed != 0;
+    image.Levels = std::move(levels);
+    image.Mapping = std::move(mapping);
+    image.Storage.clear();
+    return true;
+}
+
+bool TextureCache::Build(const std::string& sourcePath, bool mipMap, Image& image)
+{
+    int width, height, bpp;
+    unsigned char* data = stbi_load(sourcePath.c_str(), &width, &height, &bpp, STBI_rgb_alpha);
+    if (!data) {
+        return false;
+    }
+
+    image.InternalFormat = GL_RGBA8;
+    image.Compressed = false;
+    image.Mapping.reset();
+    image.Levels.clear();
+    image.Storage.clear();
+
+    image.Storage.emplace_back(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    image.Levels.push_back({width, height, width * height * 4, image.Storage.back().data()});
+
+    if (mipMap) {
+        BuildMipChain(image);
+    }
+    return true;
+}
+
+void TextureCache::Resample(Image& image, GLsizei width, GLsizei height, bool mipMap)
+{
+    const MipLevel& base = image.Levels[0];
+    std::vector<unsigned char> resampled(static_cast<size_t>(width) * height * 4);
+
+    // bilinear filtering with texel centers aligned, clamped at the borders
+    float scaleX = static_cast<float>(base.Width) / width;
+    float scaleY = static_cast<float>(base.Height) / height;
+    for (int y = 0; y < height; ++y) {
+        float sourceY = std::max(0.0f, (y + 0.5f) * scaleY - 0.5f);
+        int y0 = std::min(static_cast<int>(sourceY), base.Height - 1);
+        int y1 = std::min(y0 + 1, base.Height - 1);
+        float fy = sourceY - y0;
+        for (int x = 0; x < width; ++x) {
+            float sourceX = std::max(0.0f, (x + 0.5f) * scaleX - 0.5f);
+            int x0 = std::min(static_cast<int>(sourceX), base.Width - 1);
+            int x1 = std::min(x0 + 1, base.Width - 1);
+            float fx = sourceX - x0;
+            for (int c = 0; c < 4; ++c) {
+                float top = base.Data[(y0 * base.Width + x0) * 4 + c] * (1.0f - fx) + base.Data[(y0 * base.Width + x1) * 4 + c] * fx;
+                float bottom = base.Data[(y1 * base.Width + x0) * 4 + c] * (1.0f - fx) + base.Data[(y1 * base.Width + x1) * 4 + c] * fx;
+                resampled[(static_cast<size_t>(y) * width + x) * 4 + c] = static_cast<unsigned char>(top * (1.0f - fy) + bottom * fy + 0.5f);
+            }
+        }
+    }
+
+    image.InternalFormat = GL_RGBA8;
+    image.Compressed = false;
+    image.Levels.clear();
+    image.Storage.clear();
+    image.Mapping.reset();
+    image.Storage.push_back(std::move(resampled));
+    image.Levels.push_back({width, height, width * height * 4, image.Storage.back().data()});
+
+    if (mipMap) {
+        BuildMipChain(image);
+    }
+}
+
+TextureCache::Image TextureCache::Solid(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
+{
+    Image image;
+    image.Storage.push_back({r, g, b, a});
+    image.Levels.push_back({1, 1, 4, image.Storage.back().data()});
+    return image;
+}
+
+bool TextureCache::SolidLike(const Image& reference, unsigned char r, unsigned char g, unsigned char b,
+                             unsigned char a, Image& image)
+{
+    if (!reference.Compressed || reference.InternalFormat != GL_COMPRESSED_RGBA_BPTC_UNORM) {
+        return false;
+    }
+
+    // BC7 mode 6: both endpoints at the color (7 bits per channel plus a shared p-bit, chosen
+    // to keep an opaque alpha exact), all indices 0
+    unsigned char block[16] = {};
+    unsigned int bit = 0;
+    auto put = [&](unsigned int value, unsigned int bits) {
+        for (unsigned int i = 0; i < bits; ++i, ++bit) {
+            block[bit / 8] |= static_cast<unsigned char>(((value >> i) & 1u) << (bit % 8));
+        }
+    };
+    unsigned int p = a & 1u;
+    put(1u << 6, 7);
+    for (unsigned char channel : {r, g, b, a}) {
+        put(channel >> 1, 7);
+        put(channel >> 1, 7);
+    }
+    put(p, 1);
+    put(p, 1);
+
+    image = Image();
+    image.InternalFormat = reference.InternalFormat;
+    image.Compressed = true;
+    image.Storage.reserve(reference.Levels.size());
+    for (const MipLevel& level : reference.Levels) {
+        size_t blocks = static_cast<size_t>((level.Width + 3) / 4) * ((level.Height + 3) / 4);
+        std::vector<unsigned char> data(blocks * sizeof(block));
+        for (size_t i = 0; i < blocks; ++i) {
+            std::memcpy(data.data() + i * sizeof(block), block, sizeof(block));
+        }
+        image.Storage.push_back(std::move(data));
+        image.Levels.push_back({level.Width, level.Height, static_cast<GLsizei>(image.Storage.back().size()),
+                                image.Storage.back().data()});
+    }
+    return true;
+}
+
+void TextureCache::BuildMipChain(Image& image)
+{
+    int width = image.Levels.back().Width;
+    int height = image.Levels.back().Height;
+
+    // box filtered mip chain down to 1x1
+    while (width > 1 || height > 1) {
+        int nextWidth = std::max(1, width / 2);
+        int nextHeight = std::max(1, height / 2);
+        const unsigned char* src = image.Levels.back().Data;
+        std::vector<unsigned char> next(static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+        for (int y = 0; y < nextHeight; ++y) {
+            int y0 = std::min(2 * y, height - 1);
+            int y1 = std::min(2 * y + 1, height - 1);
+            for (int x = 0; x < nextWidth; ++x) {
+                int x0 = std::min(2 * x, width - 1);
+                int x1 = std::min(2 * x + 1, width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    unsigned sum = src[(y0 * width + x0) * 4 + c] + src[(y0 * width + x1) * 4 + c]
+                                 + src[(y1 * width + x0) * 4 + c] + src[(y1 * width + x1) * 4 + c];
+                    next[(y * nextWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+
+        width = nextWidth;
+        height = nextHeight;
+        image.Storage.push_back(std::move(next));
+        image.Levels.push_back({width, height, width * height * 4, image.Storage.back().data()});
+    }
+}
+
+void TextureCache::Upload(GLenum faceTarget, const Image& image)
+{
+    for (size_t i = 0; i < image.Levels.size(); ++i) {
+        const MipLevel& level = image.Levels[i];
+        if (image.Compressed) {
+            glCompressedTexImage2D(faceTarget, static_cast<GLint>(i), image.InternalFormat, level.Width,
+                                   level.Height, 0, level.Size, level.Data);
+        } else {
+            glTexImage2D(faceTarget, static_cast<GLint>(i), image.InternalFormat, level.Width, level.Height, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, level.Data);
+        }
+    }
+}
+
+void TextureCache::UploadStaged(const GLenum* faceTargets, unsigned int faceCount, const Image& image)
+{
+    GLsizeiptr totalSize = 0;
+    for (const MipLevel& level : image.Levels) {
+        totalSize = AlignUp(static_cast<uint32_t>(totalSize)) + level.Size;
+    }
+
+    GLuint pixelBuffer;
+    glGenBuffers(1, &pixelBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    auto* mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalSize,
+                                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &pixelBuffer);
+        for (unsigned int face = 0; face < faceCount; ++face) {
+            Upload(faceTargets[face], image);
+        }
+        return;
+    }
+
+    // while a pixel unpack buffer is bound the data pointers are offsets into it
+    Image staged;
+    staged.InternalFormat = image.InternalFormat;
+    staged.Compressed = image.Compressed;
+    uint32_t offset = 0;
+    for (const MipLevel& level : image.Levels) {
+        offset = AlignUp(offset);
+        std::memcpy(mapped + offset, level.Data, static_cast<size_t>(level.Size));
+        staged.Levels.push_back({level.Width, level.Height, level.Size,
+                                 reinterpret_cast<const unsigned char*>(static_cast<uintptr_t>(offset))});
+        offset += static_cast<uint32_t>(level.Size);
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    RenderStatistics::CountBufferUpload(totalSize);
+
+    for (unsigned int face = 0; face < faceCount; ++face) {
+        Upload(faceTargets[face], staged);
+    }
+
+    // the driver keeps the storage alive until the pending transfers are done
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &pixelBuffer);
+}
+
+TextureCache::Image TextureCache::UploadAndStore(GLenum faceTarget, const std::string& sourcePath,
+                                                 uint64_t sourceHash, Image image)
+{
+    // BC7 works on 4x4 blocks; odd sized images stay uncompressed
+    bool compress = image.Levels[0].Width % 4 == 0 && image.Levels[0].Height % 4 == 0;
+    GLenum requestedFormat = compress ? GL_COMPRESSED_RGBA_BPTC_UNORM : GL_RGBA8;
+
+    for (size_t i = 0; i < image.Levels.size(); ++i) {
+        const MipLevel& level = image.Levels[i];
+        glTexImage2D(faceTarget, static_cast<GLint>(i), requestedFormat, level.Width, level.Height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, level.Data);
+    }
+
+    GLint isCompressed = GL_FALSE;
+    if (compress) {
+        glGetTexLevelParameteriv(faceTarget, 0, GL_TEXTURE_COMPRESSED, &isCompressed);
+    }
+
+    Image resident;
+    if (isCompressed) {
+        GLint internalFormat;
+        glGetTexLevelParameteriv(faceTarget, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+        resident.InternalFormat = static_cast<GLenum>(internalFormat);
+        resident.Compressed = true;
+        resident.Storage.reserve(image.Levels.size());
+
+        for (size_t i = 0; i < image.Levels.size(); ++i) {
+            GLint size = 0;
+            glGetTexLevelParameteriv(faceTarget, static_cast<GLint>(i), GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+            resident.Storage.emplace_back(static_cast<size_t>(size));
+            glGetCompressedTexImage(faceTarget, static_cast<GLint>(i), resident.Storage.back().data());
+            resident.Levels.push_back({image.Levels[i].Width, image.Levels[i].Height, size,
+                                       resident.Storage.back().data()});
+        }
+    } else {
+        // driver did not compress; keep (and cache) the plain RGBA8 levels
+        if (requestedFormat != GL_RGBA8) {
+            Upload(faceTarget, image);
+        }
+        resident = std::move(image);
+    }
+
+    if (!Write(sourcePath, sourceHash, resident)) {
+        std::cerr << "Could not write texture cache for " << sourcePath << std::endl;
+    }
+    return resident;
+}
+
+std::string TextureCache::CachePath(const std::string& sourcePath)
+{
+    return sourcePath + ".texcache";
+}
+
+bool TextureCache::Write(const std::string& sourcePath, uint64_t sourceHash, const Image& image)
+{
+    CacheHeader header = {};
+    std::memcpy(header.Magic, CacheMagic, sizeof(CacheMagic));
+    header.Version = CacheVersion;
+    header.SourceHash = sourceHash;
+    header.InternalFormat = image.InternalFormat;
+    header.Compressed = image.Compressed ? 1 : 0;
+    header.LevelCount = static_cast<uint32_t>(image.Levels.size());
+
+    std::vector<CacheLevel> table;
+    uint32_t offset = AlignUp(static_cast<uint32_t>(sizeof(CacheHeader) + sizeof(CacheLevel) * image.Levels.size()));
+    for (const MipLevel& level : image.Levels) {
+        table.push_back({static_cast<uint32_t>(level.Width), static_cast<uint32_t>(level.Height),
+                         static_cast<uint32_t>(level.Size), offset});
+        offset = AlignUp(offset + static_cast<uint32_t>(level.Size));
+    }
+
+    // write to a temporary file first so a crash never leaves a truncated entry behind
+    std::string cachePath = CachePath(sourcePath);
+    std::string temporaryPath = cachePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()), sizeof(CacheLevel) * table.size());
+
+        static const char padding[CacheAlignment] = {};
+        size_t written = sizeof(header) + sizeof(CacheLevel) * table.size();
+        for (size_t i = 0; i < image.Levels.size(); ++i) {
+            file.write(padding, table[i].Offset - written);
+            file.write(reinterpret_cast<const char*>(image.Levels[i].Data), image.Levels[i].Size);
+            written = table[i].Offset + table[i].Size;
+        }
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, cachePath, error);
+    return !error;
+}
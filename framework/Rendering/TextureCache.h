@@ -0,0 +1,96 @@
+#ifndef PROG2002_TEXTURECACHE_H
+#define PROG2002_TEXTURECACHE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+/*
+ * GPU ready texture container. A source image is decoded once, its mip chain
+ * is built on the CPU and the driver compresses it to BC7 (BPTC) on upload.
+ * The compressed levels are read back and written next to the source image
+ * ("<source>.texcache"). Later runs map that file and upload it directly with
+ * glCompressedTexImage2D. Entries are keyed by a hash of the source file, so
+ * editing a texture invalidates its cache entry automatically.
+ */
+class TextureCache
+{
+public:
+    struct MipLevel
+    {
+        GLsizei Width;
+        GLsizei Height;
+        GLsizei Size; // bytes
+        const unsigned char* Data;
+    };
+
+    struct Image
+    {
+        Image() = default;
+        Image(Image&&) = default;
+        Image& operator=(Image&&) = default;
+        // Levels point into Storage, so images are move-only.
+        Image(const Image&) = delete;
+        Image& operator=(const Image&) = delete;
+
+        GLenum InternalFormat = GL_RGBA8;
+        bool Compressed = false;
+        std::vector<MipLevel> Levels;
+
+        // Keeps the level data alive: either the mapped cache file or CPU built levels.
+        std::shared_ptr<MappedFile> Mapping;
+        std::vector<std::vector<unsigned char>> Storage;
+    };
+
+public:
+    // Hash of the source file content used to validate cache entries.
+    static uint64_t HashFile(const std::string& filePath);
+
+    // Map the cache entry of sourcePath. Returns false if it is missing, stale, was built
+    // without the requested mip chain or its levels do not match their size and format
+    // (a truncated or corrupt entry is rebuilt rather than uploaded).
+    static bool Load(const std::string& sourcePath, uint64_t sourceHash, bool mipMap, Image& image);
+
+    // Decode the source image and build its RGBA8 mip chain on the CPU.
+    static bool Build(const std::string& sourcePath, bool mipMap, Image& image);
+
+    // Resample the base level of an uncompressed image to width x height (bilinear)
+    // and rebuild its mip chain. Used to bring the layers of a texture array to one size.
+    static void Resample(Image& image, GLsizei width, GLsizei height, bool mipMap);
+
+    // A single RGBA8 texel, used for placeholders and missing array layers.
+    static Image Solid(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+
+    // A single color in the compressed format and with the mip chain of reference, used for
+    // missing layers of compressed texture arrays. Only BC7 is supported; returns false otherwise.
+    static bool SolidLike(const Image& reference, unsigned char r, unsigned char g, unsigned char b, unsigned char a,
+                          Image& image);
+
+    // Upload all levels of the image to faceTarget of the currently bound texture.
+    static void Upload(GLenum faceTarget, const Image& image);
+
+    // Like Upload, but copies the levels once into a pixel unpack buffer and lets the
+    // driver transfer them from there to every face in faceTargets.
+    static void UploadStaged(const GLenum* faceTargets, unsigned int faceCount, const Image& image);
+
+    // Upload an RGBA8 image with a compressed internal format, read the driver
+    // compressed levels back and store them as the cache entry of sourcePath.
+    // Falls back to storing the RGBA8 levels when the driver does not compress.
+    // Returns the image as it now lives on the GPU.
+    static Image UploadAndStore(GLenum faceTarget, const std::string& sourcePath, uint64_t sourceHash,
+                                Image image);
+
+    // Store the levels of image as they are as the cache entry of sourcePath.
+    static bool Write(const std::string& sourcePath, uint64_t sourceHash, const Image& image);
+
+private:
+    static void BuildMipChain(Image& image);
+    static std::string CachePath(const std::string& sourcePath);
+};
+
+#endif //PROG2002_TEXTURECACHE_H
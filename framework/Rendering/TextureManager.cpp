@@ -1,98 +1,474 @@
 // This is the TextureManager.cpp
 #include "TextureManager.h"
+#include "RenderStats.h"
+#include "BindlessTexture.h"
 
+#include <algorithm>
 #include <iostream>
 
 bool TextureManager::LoadTexture2DRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
 {
-    int width, height, bpp;
-    auto data = this->LoadTextureImage(filePath, width, height, bpp, STBI_rgb_alpha);
-
-    if (!data)
+    DecodedImage decoded = DecodeImage(filePath, mipMap);
+    if (!decoded.valid)
     {
         return false;
     }
 
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glActiveTexture(GL_TEXTURE0 + unit); // Texture Unit
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    Texture texture;
+    texture.mipMap = mipMap;
+    texture.name = name;
+    texture.filePath = filePath;
+    texture.unit = unit;
+    texture.type = Texture2D;
+    texture.layers = 1;
+    texture.bindlessHandle = 0;
+    glGenTextures(1, &texture.id);
+
+    this->UploadDecoded(texture, decoded);
+    this->Textures.push_back(texture);
 
-    if (mipMap)
+    return true;
+}
+
+bool TextureManager::LoadCubeMapRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
+{
+    DecodedImage decoded = DecodeImage(filePath, mipMap);
+    if (!decoded.valid)
     {
-        glGenerateMipmap(GL_TEXTURE_2D);
+        return false;
     }
 
-    // Wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // Filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
     Texture texture;
     texture.mipMap = mipMap;
-    texture.width = width;
-    texture.height = height;
     texture.name = name;
     texture.filePath = filePath;
     texture.unit = unit;
-    texture.type = Texture2D;
+    texture.type = CubeMap;
+    texture.layers = 1;
+    texture.bindlessHandle = 0;
+    glGenTextures(1, &texture.id);
 
+    this->UploadDecoded(texture, decoded);
     this->Textures.push_back(texture);
 
-    this->FreeTextureImage(data);
-
     return true;
 }
 
-bool TextureManager::LoadCubeMapRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
+GLuint TextureManager::LoadTexture2DRGBAAsync(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
+{
+    this->CreatePlaceholder(name, filePath, unit, mipMap, Texture2D);
+    this->PendingTextures.push_back({this->Textures.size() - 1,
+                                     std::async(std::launch::async, &TextureManager::DecodeImage, filePath, mipMap), {}});
+    return unit;
+}
+
+GLuint TextureManager::LoadCubeMapRGBAAsync(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
 {
-    int width, height, bpp;
-    auto data = this->LoadTextureImage(filePath, width, height, bpp, STBI_rgb_alpha);
+    this->CreatePlaceholder(name, filePath, unit, mipMap, CubeMap);
+    this->PendingTextures.push_back({this->Textures.size() - 1,
+                                     std::async(std::launch::async, &TextureManager::DecodeImage, filePath, mipMap), {}});
+    return unit;
+}
 
-    if (!data)
+GLuint TextureManager::LoadTexture2DArrayRGBAAsync(const std::string& name, const std::vector<std::string>& filePaths, GLuint unit, bool mipMap)
+{
+    this->CreatePlaceholder(name, filePaths.empty() ? "" : filePaths[0], unit, mipMap, Texture2DArray, static_cast<int>(filePaths.size()));
+    this->PendingTextures.push_back({this->Textures.size() - 1, {},
+                                     std::async(std::launch::async, &TextureManager::DecodeArray, filePaths, mipMap, false)});
+    return unit;
+}
+
+GLuint TextureManager::LoadCubeMapArrayRGBAAsync(const std::string& name, const std::vector<std::string>& filePaths, GLuint unit, bool mipMap)
+{
+    // cube map faces have to be square
+    this->CreatePlaceholder(name, filePaths.empty() ? "" : filePaths[0], unit, mipMap, CubeMapArray, static_cast<int>(filePaths.size()));
+    this->PendingTextures.push_back({this->Textures.size() - 1, {},
+                                     std::async(std::launch::async, &TextureManager::DecodeArray, filePaths, mipMap, true)});
+    return unit;
+}
+
+GLuint64 TextureManager::GetBindlessHandle(const std::string& name)
+{
+    for (auto& texture : this->Textures)
     {
-        return false;
+        if (!texture.name.compare(name))
+        {
+            if (texture.ready && texture.bindlessHandle == 0)
+            {
+                texture.bindlessHandle = BindlessTexture::CreateResidentHandle(texture.id);
+            }
+            return texture.bindlessHandle;
+        }
     }
+    return 0;
+}
 
-    /*Generate a texture object and upload the loaded image to it.*/
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glActiveTexture(GL_TEXTURE0 + unit); // Texture Unit
-    glBindTexture(GL_TEXTURE_CUBE_MAP, tex);
+void TextureManager::ProcessPendingUploads(size_t byteBudget)
+{
+    size_t uploadedBytes = 0;
+    for (auto pending = this->PendingTextures.begin(); pending != this->PendingTextures.end();)
+    {
+        if (uploadedBytes >= byteBudget)
+        {
+            break;
+        }
+        bool finished = pending->decoded.valid()
+            ? pending->decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready
+            : pending->decodedArray.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        if (!finished)
+        {
+            ++pending;
+            continue;
+        }
 
-    for (unsigned int i = 0; i < 6; i++) {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        Texture& texture = this->Textures[pending->textureIndex];
+        bool valid;
+        if (pending->decoded.valid())
+        {
+            DecodedImage decoded = pending->decoded.get();
+            valid = decoded.valid;
+            if (valid)
+            {
+                for (const auto& level : decoded.image.Levels)
+                {
+                    uploadedBytes += level.Size;
+                }
+                this->UploadDecoded(texture, decoded);
+            }
+        }
+        else
+        {
+            DecodedArray decoded = pending->decodedArray.get();
+            valid = decoded.valid;
+            if (valid)
+            {
+                for (const auto& layer : decoded.layers)
+                {
+                    for (const auto& level : layer.Levels)
+                    {
+                        uploadedBytes += level.Size;
+                    }
+                }
+                this->UploadDecodedArray(texture, decoded);
+            }
+        }
+        if (!valid)
+        {
+            // keep the placeholder so the scene still renders
+            std::cerr << "Texture " << texture.filePath << " not loaded correctly." << std::endl;
+        }
+        pending = this->PendingTextures.erase(pending);
     }
+}
 
-    if (mipMap)
+bool TextureManager::IsReady(const std::string& name) const
+{
+    for (const auto& texture : this->Textures)
     {
-        glGenerateMipmap(GL_TEXTURE_2D);
+        if (!texture.name.compare(name))
+        {
+            return texture.ready;
+        }
     }
+    return false;
+}
+
+TextureManager::DecodedImage TextureManager::DecodeImage(const std::string& filePath, bool mipMap)
+{
+    // Use the pre-baked cache entry when the source is unchanged, otherwise decode it once
+    // and let UploadAndStore write a fresh entry for the next start.
+    DecodedImage decoded;
+    decoded.sourceHash = TextureCache::HashFile(filePath);
+    decoded.cached = TextureCache::Load(filePath, decoded.sourceHash, mipMap, decoded.image);
+    decoded.valid = decoded.cached || TextureCache::Build(filePath, mipMap, decoded.image);
+    return decoded;
+}
+
+void TextureManager::UploadDecoded(Texture& texture, DecodedImage& decoded)
+{
+    GLenum target = texture.type == CubeMap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    glActiveTexture(GL_TEXTURE0 + texture.unit); // Texture Unit
+    glBindTexture(target, texture.id);
+    RenderStatistics::CountTextureBind();
+
+    // The same image is used for all six faces of a cube map. On a cache miss the first
+    // face is compressed by the driver and the result is reused for the remaining faces.
+    GLenum faces[6];
+    unsigned int faceCount = 0;
+    if (target == GL_TEXTURE_CUBE_MAP)
+    {
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            faces[faceCount++] = GL_TEXTURE_CUBE_MAP_POSITIVE_X + i;
+        }
+    }
+    else
+    {
+        faces[faceCount++] = GL_TEXTURE_2D;
+    }
+
+    unsigned int firstFace = 0;
+    if (!decoded.cached)
+    {
+        decoded.image = TextureCache::UploadAndStore(faces[0], texture.filePath, decoded.sourceHash, std::move(decoded.image));
+        firstFace = 1;
+    }
+    if (firstFace < faceCount)
+    {
+        TextureCache::UploadStaged(faces + firstFace, faceCount - firstFace, decoded.image);
+    }
+
+    this->SetSamplerState(target, decoded.image.Levels.size());
+
+    texture.width = decoded.image.Levels[0].Width;
+    texture.height = decoded.image.Levels[0].Height;
+    texture.ready = true;
+}
 
+TextureManager::DecodedArray TextureManager::DecodeArray(const std::vector<std::string>& filePaths, bool mipMap, bool square)
+{
+    DecodedArray decoded;
+    std::vector<DecodedImage> layers;
+    for (const auto& filePath : filePaths)
+    {
+        layers.push_back(DecodeImage(filePath, mipMap));
+        if (layers.back().cached)
+        {
+            decoded.cachedLayers++;
+        }
+    }
+
+    // the size of the first layer that could be loaded decides the size of the array
+    GLsizei width = 0, height = 0;
+    for (const auto& layer : layers)
+    {
+        if (layer.valid)
+        {
+            width = layer.image.Levels[0].Width;
+            height = layer.image.Levels[0].Height;
+            break;
+        }
+    }
+    if (width == 0)
+    {
+        return decoded;
+    }
+    if (square)
+    {
+        width = height = std::max(width, height);
+    }
+
+    // Fast path: every layer that could be loaded is a cache entry with the same compressed format,
+    // size and mip chain, so the cached blocks are uploaded as they are. Missing layers become grey
+    // blocks of that format rather than sending the whole array back to RGBA8.
+    const DecodedImage* reference = nullptr;
+    bool direct = true;
+    for (const auto& layer : layers)
+    {
+        if (!layer.valid)
+        {
+            continue;
+        }
+        if (!reference)
+        {
+            reference = &layer;
+        }
+        direct = direct && layer.image.Compressed
+            && layer.image.InternalFormat == reference->image.InternalFormat
+            && layer.image.Levels.size() == reference->image.Levels.size()
+            && layer.image.Levels[0].Width == width && layer.image.Levels[0].Height == height;
+    }
+    std::vector<TextureCache::Image> missing(layers.size());
+    for (size_t i = 0; i < layers.size() && direct; ++i)
+    {
+        if (!layers[i].valid)
+        {
+            direct = TextureCache::SolidLike(reference->image, 128, 128, 128, 255, missing[i]);
+        }
+    }
+
+    decoded.uncached.reserve(layers.size() - decoded.cachedLayers);
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+        TextureCache::Image image = layers[i].valid ? std::move(layers[i].image) : std::move(missing[i]);
+        if (layers[i].valid && !layers[i].cached)
+        {
+            // keep the source levels for the cache entry, the layer only refers to them
+            // (or is resampled from them below)
+            decoded.uncached.push_back({filePaths[i], layers[i].sourceHash, std::move(image)});
+            image = TextureCache::Image();
+            image.Levels = decoded.uncached.back().image.Levels;
+        }
+        if (!direct)
+        {
+            if (!layers[i].valid || image.Compressed || image.Levels[0].Width != width || image.Levels[0].Height != height)
+            {
+                // compressed levels cannot be resampled: go back to the source image
+                if (!layers[i].valid || (image.Compressed && !TextureCache::Build(filePaths[i], false, image)))
+                {
+                    image = TextureCache::Solid(128, 128, 128, 255);
+                }
+                TextureCache::Resample(image, width, height, mipMap);
+            }
+        }
+        decoded.layers.push_back(std::move(image));
+    }
+
+    decoded.compressed = direct;
+    decoded.internalFormat = direct ? decoded.layers[0].InternalFormat : GL_RGBA8;
+    decoded.valid = true;
+    return decoded;
+}
+
+void TextureManager::UploadDecodedArray(Texture& texture, DecodedArray& decoded)
+{
+    GLenum target = texture.type == CubeMapArray ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D_ARRAY;
+    GLsizei faces = texture.type == CubeMapArray ? 6 : 1;
+    GLsizei depth = static_cast<GLsizei>(decoded.layers.size()) * faces;
+    const auto& levels = decoded.layers[0].Levels;
+
+    glActiveTexture(GL_TEXTURE0 + texture.unit); // Texture Unit
+    glBindTexture(target, texture.id);
+    RenderStatistics::CountTextureBind();
+
+    // (re)define every level for all layers, then fill in layer by layer (cube map
+    // arrays store six layer-faces per layer, all showing the same image)
+    for (size_t level = 0; level < levels.size(); ++level)
+    {
+        if (decoded.compressed)
+        {
+            glCompressedTexImage3D(target, static_cast<GLint>(level), decoded.internalFormat, levels[level].Width,
+                                   levels[level].Height, depth, 0, levels[level].Size * depth, nullptr);
+        }
+        else
+        {
+            glTexImage3D(target, static_cast<GLint>(level), decoded.internalFormat, levels[level].Width,
+                         levels[level].Height, depth, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+
+    for (size_t layer = 0; layer < decoded.layers.size(); ++layer)
+    {
+        for (GLsizei face = 0; face < faces; ++face)
+        {
+            GLint z = static_cast<GLint>(layer) * faces + face;
+            for (size_t level = 0; level < levels.size(); ++level)
+            {
+                const auto& data = decoded.layers[layer].Levels[level];
+                if (decoded.compressed)
+                {
+                    glCompressedTexSubImage3D(target, static_cast<GLint>(level), 0, 0, z, data.Width, data.Height, 1,
+                                              decoded.internalFormat, data.Size, data.Data);
+                }
+                else
+                {
+                    glTexSubImage3D(target, static_cast<GLint>(level), 0, 0, z, data.Width, data.Height, 1,
+                                    GL_RGBA, GL_UNSIGNED_BYTE, data.Data);
+                }
+            }
+        }
+    }
+
+    this->SetSamplerState(target, levels.size());
+
+    texture.width = levels[0].Width;
+    texture.height = levels[0].Height;
+    texture.layers = static_cast<int>(decoded.layers.size());
+    texture.ready = true;
+
+    // Layers that missed the cache are compressed by the driver on a scratch texture and stored,
+    // so the next start finds every layer cached and takes the compressed direct path.
+    if (!decoded.uncached.empty())
+    {
+        GLint boundTexture = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+        GLuint scratch;
+        glGenTextures(1, &scratch);
+        glBindTexture(GL_TEXTURE_2D, scratch);
+        for (auto& layer : decoded.uncached)
+        {
+            TextureCache::UploadAndStore(GL_TEXTURE_2D, layer.filePath, layer.sourceHash, std::move(layer.image));
+        }
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(boundTexture));
+        glDeleteTextures(1, &scratch);
+    }
+    std::cout << "Texture array " << texture.name << ": " << decoded.cachedLayers << " of "
+              << decoded.layers.size() << " layers cached" << std::endl;
+}
+
+void TextureManager::SetSamplerState(GLenum target, size_t levels) const
+{
     // Wrapping
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_REPEAT);
-    // Filtering
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if (target == GL_TEXTURE_CUBE_MAP || target == GL_TEXTURE_CUBE_MAP_ARRAY)
+    {
+        glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    }
+    // Filtering (the mip chain comes from the cache, so it only has to be enabled)
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels) - 1);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+void TextureManager::CreatePlaceholder(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap,
+                                       TextureType type, int layers)
+{
+    static const unsigned char placeholderPixels[6 * 4] = {
+        128, 128, 128, 255, 128, 128, 128, 255, 128, 128, 128, 255,
+        128, 128, 128, 255, 128, 128, 128, 255, 128, 128, 128, 255}; // mid grey
 
     Texture texture;
     texture.mipMap = mipMap;
-    texture.width = width;
-    texture.height = height;
+    texture.width = 1;
+    texture.height = 1;
     texture.name = name;
     texture.filePath = filePath;
     texture.unit = unit;
-    texture.type = CubeMap;
+    texture.type = type;
+    texture.ready = false;
+    texture.layers = layers;
+    texture.bindlessHandle = 0;
 
-    this->Textures.push_back(texture);
-    this->FreeTextureImage(data);
+    GLenum target = GL_TEXTURE_2D;
+    glGenTextures(1, &texture.id);
+    glActiveTexture(GL_TEXTURE0 + unit); // Texture Unit
+    switch (type)
+    {
+    case CubeMap:
+        target = GL_TEXTURE_CUBE_MAP;
+        glBindTexture(target, texture.id);
+        RenderStatistics::CountTextureBind();
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPixels);
+        }
+        break;
+    case Texture2DArray:
+    case CubeMapArray:
+    {
+        target = type == CubeMapArray ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D_ARRAY;
+        GLsizei depth = std::max(1, layers) * (type == CubeMapArray ? 6 : 1);
+        glBindTexture(target, texture.id);
+        RenderStatistics::CountTextureBind();
+        glTexImage3D(target, 0, GL_RGBA8, 1, 1, depth, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        for (GLsizei z = 0; z < depth; z++)
+        {
+            glTexSubImage3D(target, 0, 0, 0, z, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPixels);
+        }
+        break;
+    }
+    default:
+        glBindTexture(target, texture.id);
+        RenderStatistics::CountTextureBind();
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPixels);
+        break;
+    }
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    return true;
+    this->Textures.push_back(texture);
 }
 
 
@@ -5,8 +5,10 @@
 // External libraries
 #include <glad/glad.h>
 #include <stb_image.h>
+#include "TextureCache.h"
 
 // STD includes
+#include <future>
 #include <string>
 #include <vector>
 
@@ -14,7 +16,7 @@ class TextureManager
 {
 public:
 
-    enum TextureType { Texture2D, Texture3D, CubeMap, SkyBox };
+    enum TextureType { Texture2D, Texture3D, CubeMap, SkyBox, Texture2DArray, CubeMapArray };
 
     struct Texture
     {
@@ -24,6 +26,10 @@ public:
         std::string filePath;
         GLuint unit;
         TextureManager::TextureType type;
+        GLuint id;
+        bool ready;
+        int layers;
+        GLuint64 bindlessHandle;
     };
 
 public:
@@ -37,7 +43,74 @@ public:
     bool LoadCubeMapRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap = true);
     GLuint GetUnitByName(const std::string& name) const;
 
+    // Asynchronous loading. The texture is created right away with a 1x1 placeholder bound
+    // to the unit, which is returned as the handle. The image is decoded on a worker thread
+    // and replaces the placeholder in ProcessPendingUploads once it is ready.
+    GLuint LoadTexture2DRGBAAsync(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap = true);
+    GLuint LoadCubeMapRGBAAsync(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap = true);
+
+    // Texture arrays: every file becomes one layer (the layer index is the material index
+    // used in the shader). Layers are resampled to the size of the first one when they
+    // differ; files that fail to load become grey layers. Loaded asynchronously like above.
+    GLuint LoadTexture2DArrayRGBAAsync(const std::string& name, const std::vector<std::string>& filePaths, GLuint unit, bool mipMap = true);
+    GLuint LoadCubeMapArrayRGBAAsync(const std::string& name, const std::vector<std::string>& filePaths, GLuint unit, bool mipMap = true);
+
+    // Resident GL_ARB_bindless_texture handle of a loaded texture, created on first request.
+    // Returns 0 while the texture is still pending or when bindless textures are unsupported.
+    GLuint64 GetBindlessHandle(const std::string& name);
+
+    // Upload the decoded images of finished workers. Call once per frame from the thread
+    // owning the GL context. Stops after byteBudget bytes (at least one texture per call).
+    void ProcessPendingUploads(size_t byteBudget = 16 * 1024 * 1024);
+    bool IsReady(const std::string& name) const;
+    size_t GetPendingCount() const { return this->PendingTextures.size(); }
+
+public:
+    // The worker thread half of the asynchronous loads (no GL calls, so they can be checked without a context).
+    struct DecodedImage
+    {
+        bool valid = false;
+        bool cached = false;
+        uint64_t sourceHash = 0;
+        TextureCache::Image image;
+    };
+
+    // a layer that missed the cache, stored as a cache entry when the array is uploaded
+    struct UncachedLayer
+    {
+        std::string filePath;
+        uint64_t sourceHash = 0;
+        TextureCache::Image image; // RGBA8 at the size of the source
+    };
+
+    struct DecodedArray
+    {
+        bool valid = false;
+        bool compressed = false;
+        GLenum internalFormat = GL_RGBA8;
+        std::vector<TextureCache::Image> layers; // may point into the images of uncached
+        std::vector<UncachedLayer> uncached;
+        size_t cachedLayers = 0;
+    };
+
+    static DecodedImage DecodeImage(const std::string& filePath, bool mipMap);
+    static DecodedArray DecodeArray(const std::vector<std::string>& filePaths, bool mipMap, bool square);
+
 private:
+    struct PendingTexture
+    {
+        size_t textureIndex;
+        std::future<DecodedImage> decoded;
+        std::future<DecodedArray> decodedArray;
+    };
+
+    // Needs the GL context: uploads the image into texture.id and sets its sampler state.
+    void UploadDecoded(Texture& texture, DecodedImage& decoded);
+    void UploadDecodedArray(Texture& texture, DecodedArray& decoded);
+    void SetSamplerState(GLenum target, size_t levels) const;
+    void CreatePlaceholder(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap,
+                           TextureType type, int layers = 1);
+
     unsigned char* LoadTextureImage(const std::string& filepath, int& width, int& height, int& bpp, int format)const;
     void FreeTextureImage(unsigned char* data) const;
 
@@ -52,6 +125,7 @@ private:
 
 private:
     std::vector<TextureManager::Texture> Textures;
+    std::vector<PendingTexture> PendingTextures;
 };
 
 #endif // TEXTUREMANAGER_H_
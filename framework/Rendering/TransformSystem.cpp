@@ -0,0 +1,122 @@
+#include "TransformSystem.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define TRANSFORMSYSTEM_SSE
+#endif
+
+TransformSystem::Handle TransformSystem::Create(const glm::vec3& translation, const glm::vec3& scale)
+{
+    Handle handle = static_cast<Handle>(this->TranslationX.size());
+    this->TranslationX.push_back(translation.x);
+    this->TranslationY.push_back(translation.y);
+    this->TranslationZ.push_back(translation.z);
+    this->ScaleX.push_back(scale.x);
+    this->ScaleY.push_back(scale.y);
+    this->ScaleZ.push_back(scale.z);
+    this->Models.emplace_back(1.0f);
+    this->MVPs.emplace_back(1.0f);
+    this->Dirty.push_back(0);
+    MarkDirty(handle);
+    return handle;
+}
+
+void TransformSystem::SetTranslation(Handle handle, const glm::vec3& translation)
+{
+    this->TranslationX[handle] = translation.x;
+    this->TranslationY[handle] = translation.y;
+    this->TranslationZ[handle] = translation.z;
+    MarkDirty(handle);
+}
+
+void TransformSystem::SetScale(Handle handle, const glm::vec3& scale)
+{
+    this->ScaleX[handle] = scale.x;
+    this->ScaleY[handle] = scale.y;
+    this->ScaleZ[handle] = scale.z;
+    MarkDirty(handle);
+}
+
+glm::vec3 TransformSystem::GetTranslation(Handle handle) const
+{
+    return glm::vec3(this->TranslationX[handle], this->TranslationY[handle], this->TranslationZ[handle]);
+}
+
+glm::vec3 TransformSystem::GetScale(Handle handle) const
+{
+    return glm::vec3(this->ScaleX[handle], this->ScaleY[handle], this->ScaleZ[handle]);
+}
+
+void TransformSystem::MarkDirty(Handle handle)
+{
+    if (!this->Dirty[handle]) {
+        this->Dirty[handle] = 1;
+        this->DirtyList.push_back(handle);
+    }
+}
+
+void TransformSystem::Update(const glm::mat4& viewProjection)
+{
+    // a new camera invalidates every MVP
+    if (!this->HasViewProjection ||
+        std::memcmp(glm::value_ptr(viewProjection), glm::value_ptr(this->ViewProjection), sizeof(glm::mat4)) != 0) {
+        this->ViewProjection = viewProjection;
+        this->HasViewProjection = true;
+        this->DirtyList.clear();
+        for (Handle handle = 0; handle < this->Size(); ++handle) {
+            this->Dirty[handle] = 1;
+            this->DirtyList.push_back(handle);
+        }
+    }
+
+    // model = translate(t) * scale(s), so MVP = VP * model only scales the first three
+    // columns of VP and adds the translated origin to the fourth:
+    //   mvp[0..2] = vp[0..2] * s,  mvp[3] = vp[0] * tx + vp[1] * ty + vp[2] * tz + vp[3]
+    const float* vp = glm::value_ptr(this->ViewProjection);
+#ifdef TRANSFORMSYSTEM_SSE
+    const __m128 vp0 = _mm_loadu_ps(vp + 0);
+    const __m128 vp1 = _mm_loadu_ps(vp + 4);
+    const __m128 vp2 = _mm_loadu_ps(vp + 8);
+    const __m128 vp3 = _mm_loadu_ps(vp + 12);
+#endif
+    for (Handle handle : this->DirtyList) {
+        const float tx = this->TranslationX[handle], ty = this->TranslationY[handle], tz = this->TranslationZ[handle];
+        const float sx = this->ScaleX[handle], sy = this->ScaleY[handle], sz = this->ScaleZ[handle];
+
+        float* model = glm::value_ptr(this->Models[handle]);
+        float* mvp = glm::value_ptr(this->MVPs[handle]);
+#ifdef TRANSFORMSYSTEM_SSE
+        _mm_storeu_ps(model + 0, _mm_set_ps(0.0f, 0.0f, 0.0f, sx));
+        _mm_storeu_ps(model + 4, _mm_set_ps(0.0f, 0.0f, sy, 0.0f));
+        _mm_storeu_ps(model + 8, _mm_set_ps(0.0f, sz, 0.0f, 0.0f));
+        _mm_storeu_ps(model + 12, _mm_set_ps(1.0f, tz, ty, tx));
+
+        _mm_storeu_ps(mvp + 0, _mm_mul_ps(vp0, _mm_set1_ps(sx)));
+        _mm_storeu_ps(mvp + 4, _mm_mul_ps(vp1, _mm_set1_ps(sy)));
+        _mm_storeu_ps(mvp + 8, _mm_mul_ps(vp2, _mm_set1_ps(sz)));
+        __m128 origin = _mm_add_ps(_mm_mul_ps(vp0, _mm_set1_ps(tx)), _mm_mul_ps(vp1, _mm_set1_ps(ty)));
+        origin = _mm_add_ps(origin, _mm_mul_ps(vp2, _mm_set1_ps(tz)));
+        _mm_storeu_ps(mvp + 12, _mm_add_ps(origin, vp3));
+#else
+        const float s[3] = { sx, sy, sz };
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                model[column * 4 + row] = column == row ? (column < 3 ? s[column] : 1.0f) : 0.0f;
+            }
+        }
+        model[12] = tx; model[13] = ty; model[14] = tz;
+        for (int row = 0; row < 4; ++row) {
+            mvp[0 + row] = vp[0 + row] * sx;
+            mvp[4 + row] = vp[4 + row] * sy;
+            mvp[8 + row] = vp[8 + row] * sz;
+            mvp[12 + row] = vp[0 + row] * tx + vp[4 + row] * ty + vp[8 + row] * tz + vp[12 + row];
+        }
+#endif
+        this->Dirty[handle] = 0;
+    }
+    this->DirtyList.clear();
+}
@@ -0,0 +1,55 @@
+#ifndef PROG2002_TRANSFORMSYSTEM_H
+#define PROG2002_TRANSFORMSYSTEM_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Translation and scale of the objects that are drawn with their own model and
+ * model-view-projection matrices, in structure-of-arrays storage. Update() rebuilds
+ * the matrices with SIMD, but only for objects changed since the last update, or for
+ * all of them when the view-projection matrix changed.
+ *
+ * Instanced objects do not need it: their translation and scale go to the vertex
+ * shader as instance attributes (in homeexam only the grid is registered here, the
+ * cubes live in the SceneStore).
+ */
+class TransformSystem
+{
+public:
+    using Handle = uint32_t;
+
+    Handle Create(const glm::vec3& translation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+
+    void SetTranslation(Handle handle, const glm::vec3& translation);
+    void SetScale(Handle handle, const glm::vec3& scale);
+    glm::vec3 GetTranslation(Handle handle) const;
+    glm::vec3 GetScale(Handle handle) const;
+
+    // Recompute the matrices of all dirty objects.
+    void Update(const glm::mat4& viewProjection);
+
+    // Valid after Update().
+    const glm::mat4& GetModel(Handle handle) const { return this->Models[handle]; }
+    const glm::mat4& GetMVP(Handle handle) const { return this->MVPs[handle]; }
+
+    size_t Size() const { return this->TranslationX.size(); }
+
+private:
+    void MarkDirty(Handle handle);
+
+    std::vector<float> TranslationX, TranslationY, TranslationZ;
+    std::vector<float> ScaleX, ScaleY, ScaleZ;
+    std::vector<Handle> DirtyList;
+    std::vector<uint8_t> Dirty;
+
+    std::vector<glm::mat4> Models;
+    std::vector<glm::mat4> MVPs;
+
+    glm::mat4 ViewProjection = glm::mat4(1.0f);
+    bool HasViewProjection = false;
+};
+
+#endif //PROG2002_TRANSFORMSYSTEM_H
@@ -1,14 +1,22 @@
 #include <iostream>
 #include "VertexBuffer.h"
+#include "RenderStats.h"
+#include "DirectStateAccess.h"
 
 int VertexBuffer::count = 0;
 
-VertexBuffer::VertexBuffer(const void *vertices, GLsizei size)
+VertexBuffer::VertexBuffer(const void *vertices, GLsizei size, GLenum usage)
 {
-    glGenBuffers(1, &VertexBufferID);
-    Bind();
     // transfer data to GPU
-    glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        dsa->CreateBuffers(1, &VertexBufferID);
+        dsa->NamedBufferData(VertexBufferID, size, vertices, usage);
+    } else {
+        glGenBuffers(1, &VertexBufferID);
+        Bind();
+        glBufferData(GL_ARRAY_BUFFER, size, vertices, usage);
+    }
+    if (vertices) RenderStatistics::CountBufferUpload(size);
     count++;
 }
 
@@ -37,8 +45,13 @@ void VertexBuffer::BufferSubData(GLintptr offset, GLsizeiptr size, const void* d
     // replacement starts at "offset"-bytes into the array
     // replacement goes "size"-bytes far
     // this part will be replaced by data
-    Bind();
-    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        dsa->NamedBufferSubData(VertexBufferID, offset, size, data);
+    } else {
+        Bind();
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+    RenderStatistics::CountBufferUpload(size);
 }
 
 //void VertexBuffer::SetLayout(const BufferLayout& layout)
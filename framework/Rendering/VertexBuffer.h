@@ -8,8 +8,9 @@ class VertexBuffer
 {
 public:
     // Constructor: initializes the VertexBuffer with a data buffer and its size.
-    // Note that the buffer is bound upon construction.
-    VertexBuffer(const void *vertices, GLsizei size);
+    // Note that without direct state access the buffer is bound upon construction.
+    // Buffers updated every frame (e.g. instance data) should pass GL_DYNAMIC_DRAW as usage.
+    VertexBuffer(const void *vertices, GLsizei size, GLenum usage = GL_STATIC_DRAW);
     ~VertexBuffer();
 
     // Bind the VertexBuffer
@@ -19,8 +20,12 @@ public:
     void Unbind() const;
 
     // Fill a specific segment of the buffer specified by an offset and size with data.
+    // With direct state access GL_ARRAY_BUFFER is left as it is.
     void BufferSubData(GLintptr offset, GLsizeiptr size, const void *data) const;
 
+    // The name of the GL buffer object
+    GLuint GetID() const { return VertexBufferID; }
+
     // Set/Get buffer layout
     const BufferLayout& GetLayout() const { return Layout; }
     void SetLayout(const BufferLayout& layout) { Layout = layout; }
@@ -0,0 +1,253 @@
+#include "VertexStreams.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+// VERTEXSTREAMS_NO_SIMD forces the scalar kernels (tests/ checks every variant)
+#if !defined(VERTEXSTREAMS_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define VERTEXSTREAMS_SSE
+#endif
+#if defined(VERTEXSTREAMS_SSE) && defined(__AVX__)
+#include <immintrin.h>
+#define VERTEXSTREAMS_AVX
+#endif
+
+namespace
+{
+    bool FindStream(void* vertices, size_t vertexCount, const BufferLayout& layout, const std::string& name, VertexStream& stream)
+    {
+        for (const BufferAttribute& attribute : layout) {
+            if (attribute.Name != name) {
+                continue;
+            }
+            if (attribute.Type != ShaderDataType::Float3 && attribute.Type != ShaderDataType::Float4) {
+                return false;
+            }
+            stream.Data = static_cast<uint8_t*>(vertices) + attribute.Offset;
+            stream.Stride = static_cast<size_t>(layout.GetStride());
+            stream.Count = vertexCount;
+            return true;
+        }
+        return false;
+    }
+
+    // run kernel(first, end) over [0, count), split into chunks on several threads for large streams
+    template<typename Kernel>
+    void ForEachChunk(size_t count, Kernel kernel)
+    {
+        size_t chunks = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count / VertexStreams::MinVerticesPerThread);
+        if (chunks <= 1) {
+            kernel(size_t(0), count);
+            return;
+        }
+        size_t chunkSize = (count + chunks - 1) / chunks;
+        std::vector<std::future<void>> workers;
+        for (size_t first = chunkSize; first < count; first += chunkSize) {
+            workers.push_back(std::async(std::launch::async, kernel, first, std::min(count, first + chunkSize)));
+        }
+        kernel(size_t(0), chunkSize);
+        for (std::future<void>& worker : workers) {
+            worker.get();
+        }
+    }
+
+    float* Vertex(const VertexStream& stream, size_t index)
+    {
+        return reinterpret_cast<float*>(stream.Data + index * stream.Stride);
+    }
+
+#ifdef VERTEXSTREAMS_SSE
+    // xyz of a vertex (lane 3 undefined). Every vertex but the last one of [.., end) is followed
+    // by at least four more bytes of the same range, so it can be read with one 16 byte load
+    // without touching vertices another thread is writing.
+    inline __m128 LoadXYZ(const VertexStream& stream, size_t index, size_t end)
+    {
+        const float* vertex = Vertex(stream, index);
+        return index + 1 < end ? _mm_loadu_ps(vertex) : _mm_set_ps(0.0f, vertex[2], vertex[1], vertex[0]);
+    }
+
+    // writes exactly three floats, the bytes after them may belong to another vertex
+    inline void StoreXYZ(float* vertex, __m128 value)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(vertex), value);
+        _mm_store_ss(vertex + 2, _mm_movehl_ps(value, value));
+    }
+
+    inline __m128 Transform(__m128 v, const __m128 columns[4], bool translate)
+    {
+        __m128 result = _mm_mul_ps(columns[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+        result = _mm_add_ps(result, _mm_mul_ps(columns[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+        result = _mm_add_ps(result, _mm_mul_ps(columns[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+        return translate ? _mm_add_ps(result, columns[3]) : result;
+    }
+
+    // xyz / |xyz|, zero vectors stay zero
+    inline __m128 Normalize(__m128 v)
+    {
+        __m128 squared = _mm_mul_ps(v, v);
+        __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_shuffle_ps(squared, squared, _MM_SHUFFLE(0, 0, 0, 0)),
+                                                     _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 1, 1, 1))),
+                                          _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 2, 2, 2)));
+        __m128 length = _mm_sqrt_ps(lengthSquared);
+        return _mm_and_ps(_mm_div_ps(v, length), _mm_cmpgt_ps(length, _mm_setzero_ps()));
+    }
+#endif
+#ifdef VERTEXSTREAMS_AVX
+    // the same for two vertices, one per 128 bit lane
+    inline __m256 Transform(__m256 v, const __m256 columns[4], bool translate)
+    {
+        __m256 result = _mm256_mul_ps(columns[0], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+        result = _mm256_add_ps(result, _mm256_mul_ps(columns[1], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+        result = _mm256_add_ps(result, _mm256_mul_ps(columns[2], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+        return translate ? _mm256_add_ps(result, columns[3]) : result;
+    }
+
+    inline __m256 Normalize(__m256 v)
+    {
+        __m256 squared = _mm256_mul_ps(v, v);
+        __m256 lengthSquared = _mm256_add_ps(_mm256_add_ps(_mm256_shuffle_ps(squared, squared, _MM_SHUFFLE(0, 0, 0, 0)),
+                                                           _mm256_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 1, 1, 1))),
+                                             _mm256_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 2, 2, 2)));
+        __m256 length = _mm256_sqrt_ps(lengthSquared);
+        return _mm256_and_ps(_mm256_div_ps(v, length), _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ));
+    }
+#endif
+
+    // vertex = matrix * vertex (translate: w = 1, else w = 0), normalized if normalize is set
+    void TransformStream(const VertexStream& stream, const glm::mat4& matrix, bool translate, bool normalize)
+    {
+        ForEachChunk(stream.Count, [&](size_t first, size_t end) {
+            size_t i = first;
+#ifdef VERTEXSTREAMS_SSE
+            __m128 columns[4];
+            for (int column = 0; column < 4; ++column) {
+                columns[column] = _mm_loadu_ps(&matrix[column][0]);
+            }
+#ifdef VERTEXSTREAMS_AVX
+            __m256 wideColumns[4];
+            for (int column = 0; column < 4; ++column) {
+                wideColumns[column] = _mm256_broadcast_ps(&columns[column]);
+            }
+            // pairs of vertices that are both followed by more vertices of the chunk
+            for (; i + 2 < end; i += 2) {
+                __m256 v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(Vertex(stream, i))), _mm_loadu_ps(Vertex(stream, i + 1)), 1);
+                __m256 result = Transform(v, wideColumns, translate);
+                if (normalize) result = Normalize(result);
+                StoreXYZ(Vertex(stream, i), _mm256_castps256_ps128(result));
+                StoreXYZ(Vertex(stream, i + 1), _mm256_extractf128_ps(result, 1));
+            }
+#endif
+            for (; i < end; ++i) {
+                __m128 result = Transform(LoadXYZ(stream, i, end), columns, translate);
+                if (normalize) result = Normalize(result);
+                StoreXYZ(Vertex(stream, i), result);
+            }
+#else
+            for (; i < end; ++i) {
+                float* vertex = Vertex(stream, i);
+                glm::vec3 result = glm::vec3(matrix * glm::vec4(vertex[0], vertex[1], vertex[2], translate ? 1.0f : 0.0f));
+                if (normalize && glm::dot(result, result) > 0.0f) result = glm::normalize(result);
+                vertex[0] = result.x;
+                vertex[1] = result.y;
+                vertex[2] = result.z;
+            }
+#endif
+        });
+    }
+}
+
+bool VertexStreams::GetStream(void* vertices, size_t vertexCount, const BufferLayout& layout, const std::string& name, VertexStream& stream)
+{
+    if (!FindStream(vertices, vertexCount, layout, name, stream)) {
+        std::cerr << "Vertex layout has no Float3 or Float4 attribute \"" << name << "\"" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void VertexStreams::TransformPositions(const VertexStream& positions, const glm::mat4& matrix)
+{
+    TransformStream(positions, matrix, true, false);
+}
+
+void VertexStreams::TransformNormals(const VertexStream& normals, const glm::mat4& matrix)
+{
+    glm::mat4 normalMatrix(glm::inverse(glm::transpose(glm::mat3(matrix))));
+    TransformStream(normals, normalMatrix, false, true);
+}
+
+void VertexStreams::ComputeBounds(const VertexStream& positions, glm::vec3& min, glm::vec3& max)
+{
+    min = glm::vec3(std::numeric_limits<float>::max());
+    max = glm::vec3(std::numeric_limits<float>::lowest());
+    if (positions.Count == 0) {
+        return;
+    }
+
+    // bounds of [first, end), lane 3 of the SIMD registers is ignored
+    auto bounds = [&](size_t first, size_t end, glm::vec3& chunkMin, glm::vec3& chunkMax) {
+#ifdef VERTEXSTREAMS_SSE
+        __m128 lower = LoadXYZ(positions, first, end);
+        __m128 upper = lower;
+        for (size_t i = first + 1; i < end; ++i) {
+            __m128 v = LoadXYZ(positions, i, end);
+            lower = _mm_min_ps(lower, v);
+            upper = _mm_max_ps(upper, v);
+        }
+        float lowerValues[4], upperValues[4];
+        _mm_storeu_ps(lowerValues, lower);
+        _mm_storeu_ps(upperValues, upper);
+        chunkMin = glm::vec3(lowerValues[0], lowerValues[1], lowerValues[2]);
+        chunkMax = glm::vec3(upperValues[0], upperValues[1], upperValues[2]);
+#else
+        const float* vertex = Vertex(positions, first);
+        chunkMin = chunkMax = glm::vec3(vertex[0], vertex[1], vertex[2]);
+        for (size_t i = first + 1; i < end; ++i) {
+            vertex = Vertex(positions, i);
+            glm::vec3 v(vertex[0], vertex[1], vertex[2]);
+            chunkMin = glm::min(chunkMin, v);
+            chunkMax = glm::max(chunkMax, v);
+        }
+#endif
+    };
+
+    // one result per chunk, merged on the calling thread
+    size_t chunks = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), positions.Count / MinVerticesPerThread);
+    chunks = std::max<size_t>(chunks, 1);
+    size_t chunkSize = (positions.Count + chunks - 1) / chunks;
+    std::vector<glm::vec3> chunkMins(chunks), chunkMaxs(chunks);
+    std::vector<std::future<void>> workers;
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        size_t first = chunk * chunkSize;
+        size_t end = std::min(positions.Count, first + chunkSize);
+        workers.push_back(std::async(std::launch::async, bounds, first, end, std::ref(chunkMins[chunk]), std::ref(chunkMaxs[chunk])));
+    }
+    bounds(0, std::min(positions.Count, chunkSize), chunkMins[0], chunkMaxs[0]);
+    for (std::future<void>& worker : workers) {
+        worker.get();
+    }
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        min = glm::min(min, chunkMins[chunk]);
+        max = glm::max(max, chunkMaxs[chunk]);
+    }
+}
+
+bool VertexStreams::TransformMesh(void* vertices, size_t vertexCount, const BufferLayout& layout, const glm::mat4& matrix)
+{
+    VertexStream positions, normals;
+    if (!GetStream(vertices, vertexCount, layout, "position", positions)) {
+        return false;
+    }
+    TransformPositions(positions, matrix);
+    if (FindStream(vertices, vertexCount, layout, "normal", normals)) {
+        TransformNormals(normals, matrix);
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef PROG2002_VERTEXSTREAMS_H
+#define PROG2002_VERTEXSTREAMS_H
+
+#include "BufferLayout.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * One Float3 or Float4 attribute of an interleaved vertex buffer: the attribute of
+ * vertex i starts at Data + i * Stride. Only the xyz components are read and written.
+ */
+struct VertexStream {
+    uint8_t* Data = nullptr;
+    size_t Stride = 0;
+    size_t Count = 0;
+};
+
+/*
+ * In-place kernels over vertex streams, for baking static meshes and preparing
+ * instance data on the CPU. Nothing is allocated: the vertices are rewritten where
+ * they are. Vertices are processed with SSE (two per register with AVX, scalar
+ * fallback otherwise) and meshes of MinVerticesPerThread vertices or more are
+ * split into chunks that run on separate threads.
+ *
+ *   VertexStream positions;
+ *   if (VertexStreams::GetStream(vertices, count, layout, "position", positions)) {
+ *       VertexStreams::TransformPositions(positions, model);
+ *   }
+ */
+namespace VertexStreams {
+
+    // below this many vertices per thread a kernel runs on the calling thread
+    constexpr size_t MinVerticesPerThread = 64 * 1024;
+
+    /**
+     * The stream of the attribute called name in vertexCount vertices laid out by layout.
+     * @return false (with a message) if there is no such attribute or it is not Float3/Float4
+     */
+    bool GetStream(void* vertices, size_t vertexCount, const BufferLayout& layout, const std::string& name, VertexStream& stream);
+
+    // position = matrix * vec4(position, 1) (w of Float4 positions is left untouched)
+    void TransformPositions(const VertexStream& positions, const glm::mat4& matrix);
+
+    // normal = normalize(inverse(transpose(mat3(matrix))) * normal)
+    void TransformNormals(const VertexStream& normals, const glm::mat4& matrix);
+
+    // component-wise minimum and maximum of the positions; min > max for an empty stream
+    void ComputeBounds(const VertexStream& positions, glm::vec3& min, glm::vec3& max);
+
+    /**
+     * Transform the "position" and (if present) "normal" attributes of the vertices.
+     * @return false if the layout has no usable "position" attribute
+     */
+    bool TransformMesh(void* vertices, size_t vertexCount, const BufferLayout& layout, const glm::mat4& matrix);
+}
+
+#endif //PROG2002_VERTEXSTREAMS_H
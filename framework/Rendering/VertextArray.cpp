@@ -1,34 +1,122 @@
+#include <cstdint>
 #include <iostream>
 #include "VertextArray.h"
+#include "RenderStats.h"
+#include "DirectStateAccess.h"
 
 void VertexArray::AddVertexBuffer(const std::shared_ptr<VertexBuffer> &vertexBuffer) {
-    //Iterate over Layout.begin()
-    Bind();
+    AddBuffer(vertexBuffer, 0);
+}
+
+void VertexArray::AddInstanceBuffer(const std::shared_ptr<VertexBuffer> &instanceBuffer) {
+    AddBuffer(instanceBuffer, 1);
+}
+
+void VertexArray::AddBuffer(const std::shared_ptr<VertexBuffer> &vertexBuffer, GLuint divisor) {
+    // attribute locations continue after the ones of previously added buffers
+    const BufferLayout &Layout = vertexBuffer->GetLayout();
+    GLuint binding = BeginBinding(vertexBuffer, Layout.GetStride(), divisor);
+    for (const BufferAttribute &attribute : Layout) {
+        EnableAttribute(binding, attribute.Type, attribute.Normalized, attribute.Offset);
+    }
+    EndBinding(vertexBuffer, binding);
+}
 
-    vertexBuffer->Bind();
+void VertexArray::AddBuffer(const std::shared_ptr<VertexBuffer> &vertexBuffer, const StaticAttribute *attributes, size_t count,
+                            GLsizei stride, GLuint divisor) {
+    GLuint binding = BeginBinding(vertexBuffer, stride, divisor);
+    for (size_t i = 0; i < count; ++i) {
+        EnableAttribute(binding, attributes[i].Type, attributes[i].Normalized, attributes[i].Offset);
+    }
+    EndBinding(vertexBuffer, binding);
+}
 
-    unsigned countBufferLayout = 0;
-    auto Layout = vertexBuffer->GetLayout();
-    for (auto i = Layout.begin(); i != Layout.end(); ++i) {
-        // get the attribute
-        auto attribute = *i;
-        glVertexAttribPointer(countBufferLayout, ShaderDataTypeComponentCount(attribute.Type),
-                              ShaderDataTypeToOpenGLBaseType(attribute.Type), attribute.Normalized,
-                              Layout.GetStride(), (const void *) i->Offset);
-        glEnableVertexAttribArray(countBufferLayout);
+GLuint VertexArray::BeginBinding(const std::shared_ptr<VertexBuffer> &vertexBuffer, GLsizei stride, GLuint divisor) {
+    if (!DirectStateAccess::IsSupported()) {
+        // the attribute pointers take the buffer bound to GL_ARRAY_BUFFER
+        Bind();
+        vertexBuffer->Bind();
+    }
+    Bindings.push_back({ stride, divisor });
+    return static_cast<GLuint>(Bindings.size() - 1);
+}
 
-        countBufferLayout++;
+void VertexArray::EndBinding(const std::shared_ptr<VertexBuffer> &vertexBuffer, GLuint binding) {
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        dsa->VertexArrayVertexBuffer(m_vertexArrayID, binding, vertexBuffer->GetID(), 0, Bindings[binding].Stride);
+        dsa->VertexArrayBindingDivisor(m_vertexArrayID, binding, Bindings[binding].Divisor);
     }
     VertexBuffers.push_back(vertexBuffer);
 }
 
+void VertexArray::EnableAttribute(GLuint binding, ShaderDataType type, GLboolean normalized, GLuint offset) {
+    Attributes.push_back({ type, normalized, offset, binding });
+
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        GLenum baseType = ShaderDataTypeToOpenGLBaseType(type);
+        if (baseType == GL_INT && !normalized) {
+            // integer inputs (e.g. material indices) must not be converted to float
+            dsa->VertexArrayAttribIFormat(m_vertexArrayID, AttributeCount, ShaderDataTypeComponentCount(type), baseType, offset);
+        } else {
+            dsa->VertexArrayAttribFormat(m_vertexArrayID, AttributeCount, ShaderDataTypeComponentCount(type), baseType, normalized, offset);
+        }
+        dsa->VertexArrayAttribBinding(m_vertexArrayID, AttributeCount, binding);
+        dsa->EnableVertexArrayAttrib(m_vertexArrayID, AttributeCount);
+    } else {
+        PointAttribute(AttributeCount);
+        glEnableVertexAttribArray(AttributeCount);
+        glVertexAttribDivisor(AttributeCount, Bindings[binding].Divisor);
+    }
+
+    AttributeCount++;
+}
+
+void VertexArray::PointAttribute(GLuint location) const {
+    const AttributeFormat &attribute = Attributes[location];
+    GLsizei stride = Bindings[attribute.Binding].Stride;
+    GLenum baseType = ShaderDataTypeToOpenGLBaseType(attribute.Type);
+    if (baseType == GL_INT && !attribute.Normalized) {
+        // integer inputs (e.g. material indices) must not be converted to float
+        glVertexAttribIPointer(location, ShaderDataTypeComponentCount(attribute.Type), baseType,
+                               stride, (const void *) (uintptr_t) attribute.Offset);
+    } else {
+        glVertexAttribPointer(location, ShaderDataTypeComponentCount(attribute.Type),
+                              baseType, attribute.Normalized,
+                              stride, (const void *) (uintptr_t) attribute.Offset);
+    }
+}
+
+void VertexArray::SetVertexBuffer(GLuint binding, const std::shared_ptr<VertexBuffer> &vertexBuffer) {
+    if (binding >= Bindings.size()) {
+        std::cerr << "Vertex array has no buffer binding " << binding << std::endl;
+        return;
+    }
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        dsa->VertexArrayVertexBuffer(m_vertexArrayID, binding, vertexBuffer->GetID(), 0, Bindings[binding].Stride);
+    } else {
+        Bind();
+        vertexBuffer->Bind();
+        for (GLuint location = 0; location < AttributeCount; ++location) {
+            if (Attributes[location].Binding == binding) {
+                PointAttribute(location);
+            }
+        }
+    }
+    VertexBuffers[binding] = vertexBuffer;
+}
+
 void VertexArray::Bind() const {
     glBindVertexArray(m_vertexArrayID);
+    RenderStatistics::CountVertexArrayBind();
 
 }
 
 VertexArray::VertexArray() {
-    glGenVertexArrays(1, &m_vertexArrayID);
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        dsa->CreateVertexArrays(1, &m_vertexArrayID);
+    } else {
+        glGenVertexArrays(1, &m_vertexArrayID);
+    }
 }
 
 VertexArray::~VertexArray() {
@@ -46,5 +134,11 @@ void VertexArray::Unbind() const {
 
 void VertexArray::SetIndexBuffer(const std::shared_ptr<IndexBuffer> &indexBuffer) {
     IdxBuffer = indexBuffer;
-    indexBuffer->Bind();
+    if (const DirectStateAccess::Functions *dsa = DirectStateAccess::Get()) {
+        dsa->VertexArrayElementBuffer(m_vertexArrayID, indexBuffer->GetID());
+    } else {
+        // the element array binding is part of the bound vertex array
+        Bind();
+        indexBuffer->Bind();
+    }
 }
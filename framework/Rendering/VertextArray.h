@@ -5,6 +5,7 @@
 #include <memory>
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
+#include "StaticBufferLayout.h"
 
 class VertexArray {
 public:
@@ -21,9 +22,28 @@ public:
     // the vertex buffer to set up the vertex attributes. Notice that
     // this function opens for the definition of several vertex buffers.
     void AddVertexBuffer(const std::shared_ptr<VertexBuffer> &vertexBuffer);
+    // Add a buffer whose attributes advance once per instance instead of once per vertex.
+    void AddInstanceBuffer(const std::shared_ptr<VertexBuffer> &instanceBuffer);
+    // The same with the attributes of the vertex struct (see StaticBufferLayout.h) instead of
+    // the BufferLayout of the buffer, checked at compile time and set up without allocations.
+    template<typename Vertex>
+    void AddVertexBuffer(const std::shared_ptr<VertexBuffer> &vertexBuffer) {
+        AddBuffer(vertexBuffer, StaticBufferLayout<Vertex>::Attributes.data(), StaticBufferLayout<Vertex>::Attributes.size(),
+                  StaticBufferLayout<Vertex>::Stride, 0);
+    }
+    template<typename Instance>
+    void AddInstanceBuffer(const std::shared_ptr<VertexBuffer> &instanceBuffer) {
+        AddBuffer(instanceBuffer, StaticBufferLayout<Instance>::Attributes.data(), StaticBufferLayout<Instance>::Attributes.size(),
+                  StaticBufferLayout<Instance>::Stride, 1);
+    }
     // Set index buffer
     void SetIndexBuffer(const std::shared_ptr<IndexBuffer> &indexBuffer);
 
+    // Replace the buffer at binding index binding (the index of the Add*Buffer call that
+    // added it) with another one of the same vertex format. The attribute formats stay as
+    // they are, so one VertexArray can draw many buffers of a format without being set up again.
+    void SetVertexBuffer(GLuint binding, const std::shared_ptr<VertexBuffer> &vertexBuffer);
+
     // Get the index buffer
     const std::shared_ptr<IndexBuffer> &GetIndexBuffer() const { return IdxBuffer; }
 
@@ -31,8 +51,37 @@ public:
 
     const unsigned int getNumberOfVertexBuffers() const { return VertexBuffers.size(); }
 
+private:
+    // The vertex format: an attribute per location, read from one of the buffer bindings.
+    // With direct state access the formats and bindings live in the vertex array object;
+    // the fallback keeps them here to point the attributes at a replaced buffer.
+    struct AttributeFormat {
+        ShaderDataType Type;
+        GLboolean Normalized;
+        GLuint Offset;
+        GLuint Binding;
+    };
+    struct BufferBinding {
+        GLsizei Stride;
+        GLuint Divisor;
+    };
+
+    void AddBuffer(const std::shared_ptr<VertexBuffer> &vertexBuffer, GLuint divisor);
+    void AddBuffer(const std::shared_ptr<VertexBuffer> &vertexBuffer, const StaticAttribute *attributes, size_t count,
+                   GLsizei stride, GLuint divisor);
+    // start a new binding for vertexBuffer / attach it once its attributes are set up
+    GLuint BeginBinding(const std::shared_ptr<VertexBuffer> &vertexBuffer, GLsizei stride, GLuint divisor);
+    void EndBinding(const std::shared_ptr<VertexBuffer> &vertexBuffer, GLuint binding);
+    // set up the attribute at the next location, read from binding
+    void EnableAttribute(GLuint binding, ShaderDataType type, GLboolean normalized, GLuint offset);
+    // glVertexAttrib(I)Pointer for the attribute at location, with its buffer bound to GL_ARRAY_BUFFER
+    void PointAttribute(GLuint location) const;
+
 private:
     GLuint m_vertexArrayID = 0;
+    GLuint AttributeCount = 0;
+    std::vector<AttributeFormat> Attributes;
+    std::vector<BufferBinding> Bindings;
     std::vector<std::shared_ptr<VertexBuffer>> VertexBuffers;
     std::shared_ptr<IndexBuffer> IdxBuffer;
 
@@ -0,0 +1,132 @@
+#include "WeightedBlendedOIT.h"
+
+#include "RenderStats.h"
+#include "Shader.h"
+
+#include <iostream>
+
+WeightedBlendedOIT::WeightedBlendedOIT(GLuint accumUnit, GLuint revealageUnit)
+    : AccumUnit(accumUnit), RevealageUnit(revealageUnit)
+{
+}
+
+WeightedBlendedOIT::~WeightedBlendedOIT()
+{
+    Release();
+    if (this->EmptyVertexArray) {
+        glDeleteVertexArrays(1, &this->EmptyVertexArray);
+    }
+}
+
+bool WeightedBlendedOIT::Begin()
+{
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if ((viewport[2] != this->Width || viewport[3] != this->Height) && !Resize(viewport[2], viewport[3])) {
+        return false;
+    }
+
+    // take over the opaque depth, so translucent fragments behind opaque ones are rejected
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &this->TargetFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->TargetFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->Framebuffer);
+    glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->Framebuffer);
+
+    const GLfloat accumClear[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const GLfloat revealageClear[] = { 1.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, accumClear);
+    glClearBufferfv(GL_COLOR, 1, revealageClear);
+
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFunci(0, GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+    return true;
+}
+
+void WeightedBlendedOIT::Composite(Shader& compositeShader)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, this->TargetFramebuffer);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+
+    glActiveTexture(GL_TEXTURE0 + this->AccumUnit);
+    glBindTexture(GL_TEXTURE_2D, this->AccumTexture);
+    glActiveTexture(GL_TEXTURE0 + this->RevealageUnit);
+    glBindTexture(GL_TEXTURE_2D, this->RevealageTexture);
+    RenderStatistics::CountTextureBind();
+    RenderStatistics::CountTextureBind();
+
+    compositeShader.Bind();
+    compositeShader.UploadUniform1i("u_Accum", this->AccumUnit);
+    compositeShader.UploadUniform1i("u_Revealage", this->RevealageUnit);
+
+    glBindVertexArray(this->EmptyVertexArray);
+    RenderStatistics::CountVertexArrayBind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    RenderStatistics::CountDraw(GL_TRIANGLES, 3);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+}
+
+bool WeightedBlendedOIT::Resize(GLsizei width, GLsizei height)
+{
+    Release();
+    if (!this->EmptyVertexArray) {
+        glGenVertexArrays(1, &this->EmptyVertexArray);
+    }
+
+    auto createTarget = [&](GLenum internalFormat) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        return texture;
+    };
+    glActiveTexture(GL_TEXTURE0 + this->AccumUnit);
+    this->AccumTexture = createTarget(GL_RGBA16F);
+    glActiveTexture(GL_TEXTURE0 + this->RevealageUnit);
+    this->RevealageTexture = createTarget(GL_R8);
+
+    // same format as the window / render target depth, which the blit requires
+    glGenRenderbuffers(1, &this->DepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, this->DepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    GLint previousFramebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGenFramebuffers(1, &this->Framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->Framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->AccumTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, this->RevealageTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->DepthBuffer);
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    if (!complete) {
+        std::cerr << "Weighted blended OIT framebuffer is incomplete" << std::endl;
+        Release();
+        return false;
+    }
+
+    this->Width = width;
+    this->Height = height;
+    return true;
+}
+
+void WeightedBlendedOIT::Release()
+{
+    if (this->Framebuffer) glDeleteFramebuffers(1, &this->Framebuffer);
+    if (this->AccumTexture) glDeleteTextures(1, &this->AccumTexture);
+    if (this->RevealageTexture) glDeleteTextures(1, &this->RevealageTexture);
+    if (this->DepthBuffer) glDeleteRenderbuffers(1, &this->DepthBuffer);
+    this->Framebuffer = this->AccumTexture = this->RevealageTexture = this->DepthBuffer = 0;
+    this->Width = this->Height = 0;
+}
@@ -0,0 +1,52 @@
+#ifndef PROG2002_WEIGHTEDBLENDEDOIT_H
+#define PROG2002_WEIGHTEDBLENDEDOIT_H
+
+#include <glad/glad.h>
+
+class Shader;
+
+/*
+ * Weighted blended order-independent transparency (McGuire and Bavoil, 2013).
+ * Translucent surfaces are accumulated in any order into a premultiplied, weighted
+ * color sum (RGBA16F) and a revealage product (R8), then composited over the opaque
+ * image in one full-screen pass. The fragment shader of the translucent pass writes
+ * the accumulation to location 0 and its alpha to location 1.
+ *
+ * The targets are single-sampled and share the opaque depth through a blit, so
+ * translucent surfaces are still hidden behind opaque ones.
+ */
+class WeightedBlendedOIT
+{
+public:
+    // accumUnit and revealageUnit are the texture units the composite pass samples from
+    WeightedBlendedOIT(GLuint accumUnit, GLuint revealageUnit);
+    ~WeightedBlendedOIT();
+
+    // Redirect drawing to the accumulation targets (sized to the viewport), with the depth
+    // of the current draw framebuffer, depth writes off and the accumulation blend modes.
+    // Returns false (and leaves the state untouched) if the targets could not be created.
+    bool Begin();
+
+    // Blend the accumulated surfaces over the framebuffer that was bound at Begin().
+    // The composite shader reads u_Accum and u_Revealage with texelFetch.
+    void Composite(Shader& compositeShader);
+
+private:
+    bool Resize(GLsizei width, GLsizei height);
+    void Release();
+
+    GLuint AccumUnit;
+    GLuint RevealageUnit;
+
+    GLuint Framebuffer = 0;
+    GLuint AccumTexture = 0;
+    GLuint RevealageTexture = 0;
+    GLuint DepthBuffer = 0;
+    GLuint EmptyVertexArray = 0; // the composite triangle is generated from gl_VertexID
+    GLsizei Width = 0;
+    GLsizei Height = 0;
+
+    GLint TargetFramebuffer = 0;
+};
+
+#endif //PROG2002_WEIGHTEDBLENDEDOIT_H
@@ -0,0 +1,46 @@
+#include "SoftwareFramebuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+SoftwareFramebuffer::SoftwareFramebuffer(int width, int height)
+    : Width(width), Height(height),
+      Color(static_cast<size_t>(width) * height * 4, 0),
+      Depth(static_cast<size_t>(width) * height, 1.0f)
+{
+}
+
+void SoftwareFramebuffer::Clear(const float color[4], float depth)
+{
+    uint8_t clear[4];
+    for (int i = 0; i < 4; ++i) {
+        clear[i] = static_cast<uint8_t>(std::lround(std::min(std::max(color[i], 0.0f), 1.0f) * 255.0f));
+    }
+    for (size_t pixel = 0; pixel < this->Depth.size(); ++pixel) {
+        std::copy(clear, clear + 4, &this->Color[pixel * 4]);
+    }
+    std::fill(this->Depth.begin(), this->Depth.end(), depth);
+}
+
+bool SoftwareFramebuffer::WritePPM(const std::string& filePath) const
+{
+    return WritePPM(filePath, this->Width, this->Height, this->Color.data());
+}
+
+bool SoftwareFramebuffer::WritePPM(const std::string& filePath, int width, int height, const uint8_t* pixels)
+{
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << filePath << " for writing" << std::endl;
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int y = height - 1; y >= 0; --y) {
+        for (int x = 0; x < width; ++x) {
+            file.write(reinterpret_cast<const char*>(&pixels[(static_cast<size_t>(y) * width + x) * 4]), 3);
+        }
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,38 @@
+#ifndef PROG2002_SOFTWAREFRAMEBUFFER_H
+#define PROG2002_SOFTWAREFRAMEBUFFER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Color (RGBA8) and depth (float) target of the software renderer. Rows are stored
+ * bottom row first, the same order glReadPixels returns, so frames of both backends
+ * can be compared byte by byte.
+ */
+class SoftwareFramebuffer
+{
+public:
+    SoftwareFramebuffer(int width, int height);
+
+    void Clear(const float color[4], float depth = 1.0f);
+
+    int GetWidth() const { return this->Width; }
+    int GetHeight() const { return this->Height; }
+
+    uint8_t* GetColor(int x, int y) { return &this->Color[(static_cast<size_t>(y) * this->Width + x) * 4]; }
+    float* GetDepth(int x, int y) { return &this->Depth[static_cast<size_t>(y) * this->Width + x]; }
+    const std::vector<uint8_t>& GetPixels() const { return this->Color; }
+
+    // Write the color buffer as a binary PPM (top row first). Returns false on I/O errors.
+    bool WritePPM(const std::string& filePath) const;
+    // the same for RGBA8 pixels stored bottom row first, e.g. from GLFWApplication::ReadPixels
+    static bool WritePPM(const std::string& filePath, int width, int height, const uint8_t* pixels);
+
+private:
+    int Width, Height;
+    std::vector<uint8_t> Color;
+    std::vector<float> Depth;
+};
+
+#endif //PROG2002_SOFTWAREFRAMEBUFFER_H
@@ -0,0 +1,337 @@
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SOFTWARERENDERER_SSE
+#endif
+
+namespace
+{
+    // work items of the vertex and primitive assembly loops
+    constexpr size_t VertexChunk = 1024;
+    constexpr size_t TriangleChunk = 256;
+
+    // window coordinates are snapped to 1/256 pixel, so shared edges evaluate identically
+    inline float Snap(float coordinate)
+    {
+        return std::round(coordinate * 256.0f) / 256.0f;
+    }
+
+    inline float Saturate(float value)
+    {
+        return std::min(std::max(value, 0.0f), 1.0f);
+    }
+
+    inline uint8_t ToUnorm8(float value)
+    {
+        return static_cast<uint8_t>(std::lround(Saturate(value) * 255.0f));
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(SoftwareFramebuffer& target, unsigned int threads)
+    : Target(target), Pool(threads),
+      TilesX((target.GetWidth() + TileSize - 1) / TileSize),
+      TilesY((target.GetHeight() + TileSize - 1) / TileSize)
+{
+    this->TileBins.resize(static_cast<size_t>(this->TilesX) * this->TilesY);
+}
+
+void SoftwareRenderer::SetClearColor(float r, float g, float b, float a)
+{
+    this->ClearColor[0] = r;
+    this->ClearColor[1] = g;
+    this->ClearColor[2] = b;
+    this->ClearColor[3] = a;
+}
+
+void SoftwareRenderer::Clear()
+{
+    this->Target.Clear(this->ClearColor);
+}
+
+void SoftwareRenderer::DrawIndex(const SoftwareVertexArray& vao, SoftwareShader& shader)
+{
+    DrawIndexInstanced(vao, shader, 1, 0);
+}
+
+void SoftwareRenderer::DrawIndexInstanced(const SoftwareVertexArray& vao, SoftwareShader& shader, size_t instanceCount, size_t baseInstance)
+{
+    const size_t vertexCount = vao.GetVertexCount();
+    const std::vector<uint32_t>& indices = vao.GetIndices();
+    const size_t triangleCount = indices.size() / 3;
+    if (instanceCount == 0 || vertexCount == 0 || triangleCount == 0) {
+        return;
+    }
+
+    shader.Prepare();
+    const int varyingCount = std::min(shader.GetVaryingCount(), SoftwareShader::MaxVaryings);
+
+    // vertex stage: every vertex of every instance once
+    const size_t totalVertices = instanceCount * vertexCount;
+    this->ShadedVertices.resize(totalVertices);
+    this->Pool.ParallelFor((totalVertices + VertexChunk - 1) / VertexChunk, [&](size_t chunk) {
+        size_t end = std::min(totalVertices, (chunk + 1) * VertexChunk);
+        for (size_t i = chunk * VertexChunk; i < end; ++i) {
+            size_t instance = i / vertexCount;
+            uint32_t vertex = static_cast<uint32_t>(i % vertexCount);
+            ClipVertex& shaded = this->ShadedVertices[i];
+            shaded.position = shader.Vertex(vao.GetVertex(vertex), vao.GetInstance(baseInstance + instance), shaded.varyings);
+        }
+    });
+
+    // primitive assembly, clipping and triangle setup; the chunks keep the submission order
+    const size_t totalTriangles = instanceCount * triangleCount;
+    const size_t chunks = (totalTriangles + TriangleChunk - 1) / TriangleChunk;
+    if (this->ChunkTriangles.size() < chunks) {
+        this->ChunkTriangles.resize(chunks);
+    }
+    this->Pool.ParallelFor(chunks, [&](size_t chunk) {
+        std::vector<Triangle>& triangles = this->ChunkTriangles[chunk];
+        triangles.clear();
+        size_t end = std::min(totalTriangles, (chunk + 1) * TriangleChunk);
+        for (size_t i = chunk * TriangleChunk; i < end; ++i) {
+            const ClipVertex* vertices = &this->ShadedVertices[(i / triangleCount) * vertexCount];
+            const uint32_t* triangle = &indices[(i % triangleCount) * 3];
+            ClipAndSetup(vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]], varyingCount, triangles);
+        }
+    });
+
+    // binning
+    for (std::vector<uint32_t>& bin : this->TileBins) {
+        bin.clear();
+    }
+    this->TriangleList.clear();
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        for (const Triangle& triangle : this->ChunkTriangles[chunk]) {
+            uint32_t id = static_cast<uint32_t>(this->TriangleList.size());
+            this->TriangleList.push_back(&triangle);
+            for (int tileY = triangle.minY / TileSize; tileY <= triangle.maxY / TileSize; ++tileY) {
+                for (int tileX = triangle.minX / TileSize; tileX <= triangle.maxX / TileSize; ++tileX) {
+                    this->TileBins[static_cast<size_t>(tileY) * this->TilesX + tileX].push_back(id);
+                }
+            }
+        }
+    }
+
+    // every tile is written by one thread only
+    this->Pool.ParallelFor(this->TileBins.size(), [&](size_t tile) {
+        RasterizeTile(static_cast<int>(tile), shader, varyingCount);
+    });
+}
+
+void SoftwareRenderer::ClipAndSetup(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, int varyingCount,
+                                    std::vector<Triangle>& triangles) const
+{
+    const ClipVertex* input[3] = { &a, &b, &c };
+    // signed distance to the near plane (z = -w)
+    float distance[3];
+    int inside = 0;
+    for (int i = 0; i < 3; ++i) {
+        distance[i] = input[i]->position.z + input[i]->position.w;
+        inside += distance[i] >= 0.0f;
+    }
+    if (inside == 3) {
+        SetupTriangle(input, varyingCount, triangles);
+        return;
+    }
+    if (inside == 0) {
+        return;
+    }
+
+    // Sutherland-Hodgman against the near plane: the triangle becomes a triangle or a quad
+    ClipVertex polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+        int j = (i + 1) % 3;
+        if (distance[i] >= 0.0f) {
+            polygon[count++] = *input[i];
+        }
+        if ((distance[i] >= 0.0f) != (distance[j] >= 0.0f)) {
+            float t = distance[i] / (distance[i] - distance[j]);
+            ClipVertex& clipped = polygon[count++];
+            clipped.position = input[i]->position + (input[j]->position - input[i]->position) * t;
+            for (int k = 0; k < varyingCount; ++k) {
+                clipped.varyings[k] = input[i]->varyings[k] + (input[j]->varyings[k] - input[i]->varyings[k]) * t;
+            }
+        }
+    }
+    for (int k = 1; k + 1 < count; ++k) {
+        const ClipVertex* fan[3] = { &polygon[0], &polygon[k], &polygon[k + 1] };
+        SetupTriangle(fan, varyingCount, triangles);
+    }
+}
+
+void SoftwareRenderer::SetupTriangle(const ClipVertex* vertices[3], int varyingCount, std::vector<Triangle>& triangles) const
+{
+    const float width = static_cast<float>(this->Target.GetWidth());
+    const float height = static_cast<float>(this->Target.GetHeight());
+
+    Triangle triangle;
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec4& position = vertices[i]->position;
+        if (!(position.w > 0.0f)) {
+            return;
+        }
+        float invW = 1.0f / position.w;
+        triangle.x[i] = Snap((position.x * invW * 0.5f + 0.5f) * width);
+        triangle.y[i] = Snap((position.y * invW * 0.5f + 0.5f) * height);
+        triangle.z[i] = position.z * invW * 0.5f + 0.5f;
+        triangle.invW[i] = invW;
+        for (int k = 0; k < varyingCount; ++k) {
+            triangle.varyings[i][k] = vertices[i]->varyings[k] * invW;
+        }
+        if (!std::isfinite(triangle.x[i]) || !std::isfinite(triangle.y[i])) {
+            return;
+        }
+    }
+
+    // make the triangle counter-clockwise (there is no face culling)
+    float area = (triangle.y[1] - triangle.y[2]) * triangle.x[0] + (triangle.x[2] - triangle.x[1]) * triangle.y[0]
+        + (triangle.x[1] * triangle.y[2] - triangle.x[2] * triangle.y[1]);
+    if (area == 0.0f) {
+        return;
+    }
+    if (area < 0.0f) {
+        std::swap(triangle.x[1], triangle.x[2]);
+        std::swap(triangle.y[1], triangle.y[2]);
+        std::swap(triangle.z[1], triangle.z[2]);
+        std::swap(triangle.invW[1], triangle.invW[2]);
+        std::swap(triangle.varyings[1], triangle.varyings[2]);
+    }
+
+    // pixels whose centre (i + 0.5) lies within the bounds
+    float minX = std::min({ triangle.x[0], triangle.x[1], triangle.x[2] });
+    float maxX = std::max({ triangle.x[0], triangle.x[1], triangle.x[2] });
+    float minY = std::min({ triangle.y[0], triangle.y[1], triangle.y[2] });
+    float maxY = std::max({ triangle.y[0], triangle.y[1], triangle.y[2] });
+    triangle.minX = static_cast<int>(std::max(0.0f, std::ceil(minX - 0.5f)));
+    triangle.maxX = static_cast<int>(std::min(width - 1.0f, std::floor(maxX - 0.5f)));
+    triangle.minY = static_cast<int>(std::max(0.0f, std::ceil(minY - 0.5f)));
+    triangle.maxY = static_cast<int>(std::min(height - 1.0f, std::floor(maxY - 0.5f)));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return;
+    }
+    triangles.push_back(triangle);
+}
+
+void SoftwareRenderer::RasterizeTile(int tile, const SoftwareShader& shader, int varyingCount)
+{
+    const std::vector<uint32_t>& bin = this->TileBins[tile];
+    if (bin.empty()) {
+        return;
+    }
+    const int tileX0 = (tile % this->TilesX) * TileSize;
+    const int tileY0 = (tile / this->TilesX) * TileSize;
+    const int tileX1 = std::min(this->Target.GetWidth(), tileX0 + TileSize) - 1;
+    const int tileY1 = std::min(this->Target.GetHeight(), tileY0 + TileSize) - 1;
+
+    float varyings[SoftwareShader::MaxVaryings];
+
+    for (uint32_t id : bin) {
+        const Triangle& triangle = *this->TriangleList[id];
+        const int x0 = std::max(triangle.minX, tileX0), x1 = std::min(triangle.maxX, tileX1);
+        const int y0 = std::max(triangle.minY, tileY0), y1 = std::min(triangle.maxY, tileY1);
+        if (x0 > x1 || y0 > y1) {
+            continue;
+        }
+
+        // edge function i is zero on the edge opposite vertex i and positive inside:
+        //   e_i(px, py) = a_i * px + (b_i * py + c_i)
+        // Pixels exactly on an edge belong to the triangle if it is a top or left edge,
+        // so pixels on shared edges are drawn once.
+        const float* x = triangle.x;
+        const float* y = triangle.y;
+        float a[3], b[3], c[3];
+        bool topLeft[3];
+        for (int i = 0; i < 3; ++i) {
+            int j = (i + 1) % 3, k = (i + 2) % 3;
+            a[i] = y[j] - y[k];
+            b[i] = x[k] - x[j];
+            c[i] = x[j] * y[k] - x[k] * y[j];
+            float dx = x[k] - x[j], dy = y[k] - y[j];
+            topLeft[i] = dy < 0.0f || (dy == 0.0f && dx < 0.0f);
+        }
+        const float invArea = 1.0f / (a[0] * x[0] + b[0] * y[0] + c[0]);
+
+        auto shade = [&](int px, int py, float e0, float e1, float e2) {
+            float l0 = e0 * invArea, l1 = e1 * invArea, l2 = e2 * invArea;
+            float z = l0 * triangle.z[0] + l1 * triangle.z[1] + l2 * triangle.z[2];
+            float* depth = this->Target.GetDepth(px, py);
+            if (!(z < *depth)) {
+                return;
+            }
+            float w = 1.0f / (l0 * triangle.invW[0] + l1 * triangle.invW[1] + l2 * triangle.invW[2]);
+            for (int k = 0; k < varyingCount; ++k) {
+                varyings[k] = (l0 * triangle.varyings[0][k] + l1 * triangle.varyings[1][k] + l2 * triangle.varyings[2][k]) * w;
+            }
+            glm::vec4 color = shader.Fragment(varyings);
+
+            uint8_t* target = this->Target.GetColor(px, py);
+            if (this->Blending) {
+                // like GL, the fragment color is clamped for the normalized target before blending
+                float alpha = Saturate(color.w);
+                for (int channel = 0; channel < 4; ++channel) {
+                    target[channel] = ToUnorm8(Saturate(color[channel]) * alpha + target[channel] / 255.0f * (1.0f - alpha));
+                }
+            }
+            else {
+                for (int channel = 0; channel < 4; ++channel) {
+                    target[channel] = ToUnorm8(color[channel]);
+                }
+            }
+            if (this->DepthWrite) {
+                *depth = z;
+            }
+        };
+
+        for (int row = y0; row <= y1; ++row) {
+            const float py = row + 0.5f;
+            const float rowTerm[3] = { b[0] * py + c[0], b[1] * py + c[1], b[2] * py + c[2] };
+#ifdef SOFTWARERENDERER_SSE
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 laneX = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            __m128 edgeA[3], edgeRow[3];
+            for (int i = 0; i < 3; ++i) {
+                edgeA[i] = _mm_set1_ps(a[i]);
+                edgeRow[i] = _mm_set1_ps(rowTerm[i]);
+            }
+#endif
+            for (int column = x0; column <= x1; column += 4) {
+                int lanes = std::min(4, x1 - column + 1);
+#ifdef SOFTWARERENDERER_SSE
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(column)), laneX);
+                __m128 covered = _mm_cmpeq_ps(zero, zero); // all lanes set
+                for (int i = 0; i < 3; ++i) {
+                    __m128 e = _mm_add_ps(_mm_mul_ps(edgeA[i], px), edgeRow[i]);
+                    covered = _mm_and_ps(covered, topLeft[i] ? _mm_cmpge_ps(e, zero) : _mm_cmpgt_ps(e, zero));
+                }
+                int mask = _mm_movemask_ps(covered) & ((1 << lanes) - 1);
+                while (mask) {
+                    int lane = 0;
+                    while (!(mask & (1 << lane))) ++lane;
+                    mask &= mask - 1;
+                    float laneCenter = static_cast<float>(column) + (lane + 0.5f);
+                    shade(column + lane, row, a[0] * laneCenter + rowTerm[0], a[1] * laneCenter + rowTerm[1], a[2] * laneCenter + rowTerm[2]);
+                }
+#else
+                for (int lane = 0; lane < lanes; ++lane) {
+                    float laneCenter = static_cast<float>(column) + (lane + 0.5f);
+                    float e[3];
+                    bool inside = true;
+                    for (int i = 0; i < 3; ++i) {
+                        e[i] = a[i] * laneCenter + rowTerm[i];
+                        inside = inside && (topLeft[i] ? e[i] >= 0.0f : e[i] > 0.0f);
+                    }
+                    if (inside) {
+                        shade(column + lane, row, e[0], e[1], e[2]);
+                    }
+                }
+#endif
+            }
+        }
+    }
+}
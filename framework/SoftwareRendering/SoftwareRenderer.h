@@ -0,0 +1,82 @@
+#ifndef PROG2002_SOFTWARERENDERER_H
+#define PROG2002_SOFTWARERENDERER_H
+
+#include "SoftwareFramebuffer.h"
+#include "SoftwareShader.h"
+#include "SoftwareVertexArray.h"
+#include "ThreadPool.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Tile binned software rasteriser, the CPU counterpart of RenderCommands. A draw runs
+ * the vertex stage over all vertices of all instances, clips the triangles against the
+ * near plane and sorts them into 64x64 pixel tiles. The tiles are then rasterised in
+ * parallel; within a tile the triangles keep their submission order, so blending gives
+ * the same result as on the GPU.
+ *
+ * Rasterisation follows GL: pixel centres are sampled with the top-left fill rule,
+ * attributes are interpolated perspective correct, the depth test is GL_LESS and
+ * blending is glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA). The edge functions
+ * are evaluated four pixels at a time with SSE (scalar fallback otherwise).
+ * There is no face culling and no multisampling.
+ */
+class SoftwareRenderer
+{
+public:
+    // threads = 0 uses all hardware threads
+    explicit SoftwareRenderer(SoftwareFramebuffer& target, unsigned int threads = 0);
+
+    void SetClearColor(float r, float g, float b, float a);
+    void Clear();
+
+    // glEnable/glDisable(GL_BLEND)
+    void SetBlending(bool enabled) { this->Blending = enabled; }
+    // glDepthMask
+    void SetDepthWrite(bool enabled) { this->DepthWrite = enabled; }
+
+    void DrawIndex(const SoftwareVertexArray& vao, SoftwareShader& shader);
+    // draw instanceCount instances, reading the per-instance records from baseInstance onwards
+    void DrawIndexInstanced(const SoftwareVertexArray& vao, SoftwareShader& shader, size_t instanceCount, size_t baseInstance = 0);
+
+    SoftwareFramebuffer& GetTarget() { return this->Target; }
+
+private:
+    static constexpr int TileSize = 64;
+
+    struct ClipVertex {
+        glm::vec4 position;
+        float varyings[SoftwareShader::MaxVaryings];
+    };
+
+    // a triangle in window coordinates, counter-clockwise, ready for rasterisation
+    struct Triangle {
+        float x[3], y[3], z[3];
+        float invW[3];
+        float varyings[3][SoftwareShader::MaxVaryings]; // divided by w
+        int minX, minY, maxX, maxY; // covered pixel range
+    };
+
+    void SetupTriangle(const ClipVertex* vertices[3], int varyingCount, std::vector<Triangle>& triangles) const;
+    void ClipAndSetup(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, int varyingCount,
+                      std::vector<Triangle>& triangles) const;
+    void RasterizeTile(int tile, const SoftwareShader& shader, int varyingCount);
+
+    SoftwareFramebuffer& Target;
+    ThreadPool Pool;
+    float ClearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    bool Blending = false;
+    bool DepthWrite = true;
+
+    int TilesX, TilesY;
+    // scratch storage of the current draw, kept between draws
+    std::vector<ClipVertex> ShadedVertices;
+    std::vector<std::vector<Triangle>> ChunkTriangles;
+    std::vector<const Triangle*> TriangleList;
+    std::vector<std::vector<uint32_t>> TileBins;
+};
+
+#endif //PROG2002_SOFTWARERENDERER_H
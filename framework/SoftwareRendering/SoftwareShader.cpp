@@ -0,0 +1,29 @@
+#include "SoftwareShader.h"
+
+float SoftwareShader::GetFloat1(const std::string& name) const
+{
+    return GetFloat4(name).x;
+}
+
+glm::vec3 SoftwareShader::GetFloat3(const std::string& name) const
+{
+    return glm::vec3(GetFloat4(name));
+}
+
+glm::vec4 SoftwareShader::GetFloat4(const std::string& name) const
+{
+    auto uniform = this->Vectors.find(name);
+    return uniform != this->Vectors.end() ? uniform->second : glm::vec4(0.0f);
+}
+
+glm::mat4 SoftwareShader::GetMatrix4(const std::string& name) const
+{
+    auto uniform = this->Matrices.find(name);
+    return uniform != this->Matrices.end() ? uniform->second : glm::mat4(0.0f);
+}
+
+int SoftwareShader::GetInt(const std::string& name) const
+{
+    auto uniform = this->Integers.find(name);
+    return uniform != this->Integers.end() ? uniform->second : 0;
+}
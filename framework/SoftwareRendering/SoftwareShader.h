@@ -0,0 +1,57 @@
+#ifndef PROG2002_SOFTWARESHADER_H
+#define PROG2002_SOFTWARESHADER_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/*
+ * CPU counterpart of Shader. A program derives from it and implements the vertex
+ * and fragment stages in C++; uniforms are uploaded by name like with Shader and
+ * read back into members in Prepare(), which runs once per draw.
+ *
+ * The stages run concurrently on the renderer's threads and must not modify the shader.
+ */
+class SoftwareShader
+{
+public:
+    static constexpr int MaxVaryings = 16;
+
+    virtual ~SoftwareShader() = default;
+
+    void UploadUniformFloat1(const std::string& name, float number) { this->Vectors[name] = glm::vec4(number, 0.0f, 0.0f, 0.0f); }
+    void UploadUniformFloat3(const std::string& name, const glm::vec3& vector) { this->Vectors[name] = glm::vec4(vector, 0.0f); }
+    void UploadUniformFloat4(const std::string& name, const glm::vec4& vector) { this->Vectors[name] = vector; }
+    void UploadUniformMatrix4fv(const std::string& name, const glm::mat4& matrix) { this->Matrices[name] = matrix; }
+    void UploadUniform1i(const std::string& name, int value) { this->Integers[name] = value; }
+
+    // Called by the renderer before the first vertex of a draw.
+    virtual void Prepare() {}
+
+    // Number of floats the vertex stage writes to varyings (at most MaxVaryings).
+    virtual int GetVaryingCount() const = 0;
+
+    // Vertex stage: clip space position; vertex and instance point to the records of the
+    // SoftwareVertexArray (instance is nullptr without an instance buffer).
+    virtual glm::vec4 Vertex(const uint8_t* vertex, const uint8_t* instance, float* varyings) const = 0;
+
+    // Fragment stage: RGBA color in [0, 1] from the perspective correct interpolated varyings.
+    virtual glm::vec4 Fragment(const float* varyings) const = 0;
+
+protected:
+    // Uniforms that were never uploaded read as zero (like in GL).
+    float GetFloat1(const std::string& name) const;
+    glm::vec3 GetFloat3(const std::string& name) const;
+    glm::vec4 GetFloat4(const std::string& name) const;
+    glm::mat4 GetMatrix4(const std::string& name) const;
+    int GetInt(const std::string& name) const;
+
+private:
+    std::unordered_map<std::string, glm::vec4> Vectors;
+    std::unordered_map<std::string, glm::mat4> Matrices;
+    std::unordered_map<std::string, int> Integers;
+};
+
+#endif //PROG2002_SOFTWARESHADER_H
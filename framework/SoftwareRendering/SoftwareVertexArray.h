@@ -0,0 +1,59 @@
+#ifndef PROG2002_SOFTWAREVERTEXARRAY_H
+#define PROG2002_SOFTWAREVERTEXARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+ * CPU counterpart of VertexArray: vertex, index and per-instance data in system
+ * memory. Vertices and instances are opaque records of a fixed size that the
+ * SoftwareShader of the draw interprets, like a BufferLayout does for GL.
+ */
+class SoftwareVertexArray
+{
+public:
+    void SetVertexBuffer(const void* data, size_t vertexSize, size_t vertexCount)
+    {
+        Copy(this->Vertices, data, vertexSize * vertexCount);
+        this->VertexSize = vertexSize;
+    }
+
+    void SetIndexBuffer(const uint32_t* indices, size_t count)
+    {
+        this->Indices.assign(indices, indices + count);
+    }
+
+    // like VertexBuffer::BufferSubData on the instance buffer: replaces the instance records
+    void SetInstanceBuffer(const void* data, size_t instanceSize, size_t instanceCount)
+    {
+        Copy(this->Instances, data, instanceSize * instanceCount);
+        this->InstanceSize = instanceSize;
+    }
+
+    const uint8_t* GetVertex(uint32_t index) const { return &this->Vertices[index * this->VertexSize]; }
+    // nullptr without an instance buffer
+    const uint8_t* GetInstance(size_t index) const
+    {
+        return this->InstanceSize ? &this->Instances[index * this->InstanceSize] : nullptr;
+    }
+    const std::vector<uint32_t>& GetIndices() const { return this->Indices; }
+    size_t GetVertexCount() const { return this->VertexSize ? this->Vertices.size() / this->VertexSize : 0; }
+    size_t GetInstanceCount() const { return this->InstanceSize ? this->Instances.size() / this->InstanceSize : 0; }
+
+private:
+    static void Copy(std::vector<uint8_t>& target, const void* data, size_t size)
+    {
+        target.resize(size);
+        if (size) std::memcpy(target.data(), data, size);
+    }
+
+    std::vector<uint8_t> Vertices;
+    std::vector<uint8_t> Instances;
+    std::vector<uint32_t> Indices;
+    size_t VertexSize = 0;
+    size_t InstanceSize = 0;
+};
+
+#endif //PROG2002_SOFTWAREVERTEXARRAY_H
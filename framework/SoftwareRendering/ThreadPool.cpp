@@ -0,0 +1,93 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned int i = 1; i < threads; ++i) {
+        this->Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->Stopping = true;
+    }
+    this->WorkAvailable.notify_all();
+    for (std::thread& worker : this->Workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+    if (count == 0) {
+        return;
+    }
+    if (this->Workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->Job = &job;
+        this->Count = count;
+        this->Next = 0;
+        this->Finished = 0;
+        this->Generation++;
+    }
+    this->WorkAvailable.notify_all();
+
+    RunJobs();
+
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->WorkDone.wait(lock, [this]() { return this->Finished == this->Count; });
+    this->Job = nullptr;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    unsigned long long seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->Mutex);
+            this->WorkAvailable.wait(lock, [&]() { return this->Stopping || this->Generation != seenGeneration; });
+            if (this->Stopping) {
+                return;
+            }
+            seenGeneration = this->Generation;
+        }
+        RunJobs();
+    }
+}
+
+void ThreadPool::RunJobs()
+{
+    // take one index at a time; the jobs (tiles, vertex chunks) are coarse enough
+    while (true) {
+        size_t index;
+        const std::function<void(size_t)>* job;
+        {
+            std::lock_guard<std::mutex> lock(this->Mutex);
+            if (!this->Job || this->Next >= this->Count) {
+                return;
+            }
+            index = this->Next++;
+            job = this->Job;
+        }
+        (*job)(index);
+
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        if (++this->Finished == this->Count) {
+            this->WorkDone.notify_one();
+        }
+    }
+}
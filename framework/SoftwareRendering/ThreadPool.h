@@ -0,0 +1,49 @@
+#ifndef PROG2002_THREADPOOL_H
+#define PROG2002_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed set of worker threads for data parallel loops. The workers sleep between
+ * loops; the calling thread takes part in every loop, so a pool of size 1 runs
+ * everything inline.
+ */
+class ThreadPool
+{
+public:
+    // threads = 0 uses all hardware threads (the calling thread included)
+    explicit ThreadPool(unsigned int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run job(i) for every i in [0, count) and return when all calls finished.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& job);
+
+    unsigned int Size() const { return static_cast<unsigned int>(this->Workers.size()) + 1; }
+
+private:
+    void WorkerLoop();
+    void RunJobs();
+
+    std::vector<std::thread> Workers;
+    std::mutex Mutex;
+    std::condition_variable WorkAvailable;
+    std::condition_variable WorkDone;
+
+    // the current loop; Generation changes for every ParallelFor call
+    const std::function<void(size_t)>* Job = nullptr;
+    size_t Count = 0;
+    size_t Next = 0;
+    size_t Finished = 0;
+    unsigned long long Generation = 0;
+    bool Stopping = false;
+};
+
+#endif //PROG2002_THREADPOOL_H
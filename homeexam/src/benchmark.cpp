@@ -0,0 +1,167 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    // a frame number of digits only, which may still be too large for an unsigned int
+    bool ParseFrame(const std::string& digits, unsigned int& frame)
+    {
+        try {
+            unsigned long value = std::stoul(digits);
+            if (value > std::numeric_limits<unsigned int>::max()) {
+                return false;
+            }
+            frame = static_cast<unsigned int>(value);
+            return true;
+        }
+        catch (const std::out_of_range&) {
+            return false;
+        }
+    }
+}
+
+bool BenchmarkScript::Load(const std::string& filePath, BenchmarkScript& script)
+{
+    std::ifstream file(filePath);
+    if (!file) {
+        std::cerr << "Failed to open benchmark script " << filePath << std::endl;
+        return false;
+    }
+
+    script = BenchmarkScript();
+    script.path = filePath;
+
+    std::string line;
+    unsigned int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::string first;
+        if (!(tokens >> first)) {
+            continue;
+        }
+
+        bool valid = true;
+        if (first == "seed") {
+            valid = static_cast<bool>(tokens >> script.seed);
+        }
+        else if (first == "frames") {
+            valid = static_cast<bool>(tokens >> script.frames) && script.frames > 0;
+        }
+        else if (first == "warmup") {
+            valid = static_cast<bool>(tokens >> script.warmupFrames);
+        }
+        else if (std::all_of(first.begin(), first.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+            BenchmarkEvent event;
+            if (!ParseFrame(first, event.frame)) {
+                std::cerr << filePath << ":" << lineNumber << ": frame number out of range: " << line << std::endl;
+                return false;
+            }
+            std::string command;
+            tokens >> command;
+            if (command == "move") {
+                std::string direction;
+                tokens >> direction;
+                event.type = BenchmarkEvent::Move;
+                if (direction == "up") event.direction = UP;
+                else if (direction == "down") event.direction = DOWN;
+                else if (direction == "left") event.direction = LEFT;
+                else if (direction == "right") event.direction = RIGHT;
+                else valid = false;
+            }
+            else if (command == "zoom") {
+                event.type = BenchmarkEvent::Zoom;
+                valid = static_cast<bool>(tokens >> event.value);
+            }
+            else if (command == "rotate") {
+                event.type = BenchmarkEvent::Rotate;
+                valid = static_cast<bool>(tokens >> event.value);
+            }
+            else if (command == "texture") {
+                event.type = BenchmarkEvent::ToggleTexture;
+            }
+            else {
+                valid = false;
+            }
+            if (valid) script.events.push_back(event);
+        }
+        else {
+            valid = false;
+        }
+
+        if (!valid) {
+            std::cerr << filePath << ":" << lineNumber << ": invalid benchmark command: " << line << std::endl;
+            return false;
+        }
+    }
+
+    std::stable_sort(script.events.begin(), script.events.end(),
+        [](const BenchmarkEvent& a, const BenchmarkEvent& b) { return a.frame < b.frame; });
+    return true;
+}
+
+namespace
+{
+    // nearest-rank percentile of sorted values
+    double Percentile(const std::vector<double>& sorted, double percent)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+}
+
+bool WriteBenchmarkReport(const std::string& filePath, const BenchmarkScript& script,
+                          std::vector<double> frameTimesMs, double startupMs, double texturesReadyMs)
+{
+    if (frameTimesMs.empty()) {
+        std::cerr << "No frames were measured" << std::endl;
+        return false;
+    }
+    std::sort(frameTimesMs.begin(), frameTimesMs.end());
+    double mean = std::accumulate(frameTimesMs.begin(), frameTimesMs.end(), 0.0) / static_cast<double>(frameTimesMs.size());
+
+    std::string scriptPath;
+    for (char c : script.path) {
+        if (c == '"' || c == '\\') scriptPath += '\\';
+        scriptPath += c;
+    }
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(4);
+    report << "{\n"
+           << "  \"script\": \"" << scriptPath << "\",\n"
+           << "  \"seed\": " << script.seed << ",\n"
+           << "  \"frames\": " << frameTimesMs.size() << ",\n"
+           << "  \"warmup_frames\": " << script.warmupFrames << ",\n"
+           << "  \"startup_ms\": " << startupMs << ",\n"
+           << "  \"textures_ready_ms\": " << texturesReadyMs << ",\n"
+           << "  \"frame_time_ms\": {\n"
+           << "    \"mean\": " << mean << ",\n"
+           << "    \"p50\": " << Percentile(frameTimesMs, 50.0) << ",\n"
+           << "    \"p95\": " << Percentile(frameTimesMs, 95.0) << ",\n"
+           << "    \"p99\": " << Percentile(frameTimesMs, 99.0) << ",\n"
+           << "    \"min\": " << frameTimesMs.front() << ",\n"
+           << "    \"max\": " << frameTimesMs.back() << "\n"
+           << "  }\n"
+           << "}\n";
+
+    std::ofstream file(filePath);
+    if (!file) {
+        std::cerr << "Failed to write benchmark report " << filePath << std::endl;
+        return false;
+    }
+    file << report.str();
+    std::cout << report.str();
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,56 @@
+#ifndef HOMEEXAM_BENCHMARK_H
+#define HOMEEXAM_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+#include "homeexam.h"
+
+/*
+ * Scripted, deterministic benchmark run of the home exam. A script is a text file with
+ * one command per line ('#' starts a comment):
+ *
+ *   seed <n>                  seed of the warehouse layout
+ *   frames <n>                number of measured frames
+ *   warmup <n>                frames rendered before measuring (default 0)
+ *   <frame> move up|down|left|right
+ *   <frame> zoom <delta>      same as the W/S keys (fov delta)
+ *   <frame> rotate <degrees>  same as the A/D keys
+ *   <frame> texture           same as the T key
+ *
+ * Frame numbers count from the first rendered frame, warmup included.
+ */
+struct BenchmarkEvent
+{
+    enum Type {
+        Move,
+        Zoom,
+        Rotate,
+        ToggleTexture
+    };
+
+    unsigned int frame = 0;
+    Type type = Move;
+    Direction direction = UP;
+    float value = 0.0f;
+};
+
+struct BenchmarkScript
+{
+    std::string path;
+    unsigned int seed = 1;
+    unsigned int frames = 1000;
+    unsigned int warmupFrames = 0;
+    std::vector<BenchmarkEvent> events; // sorted by frame
+
+    // Parse the script file. Reports the offending line and returns false on errors.
+    static bool Load(const std::string& filePath, BenchmarkScript& script);
+};
+
+// Write mean, p50, p95, p99, min and max of the frame times (ms between presented frames), the
+// start-up time until the first frame was presented (without the texture loading) and the time
+// until all textures were uploaded as JSON.
+bool WriteBenchmarkReport(const std::string& filePath, const BenchmarkScript& script,
+                          std::vector<double> frameTimesMs, double startupMs, double texturesReadyMs);
+
+#endif //HOMEEXAM_BENCHMARK_H
@@ -2,22 +2,49 @@
 // shader objects
 #include "shaders/grid.h"
 #include "shaders/cube.h"
-#include "shaders/sun.h"
+#include "shaders/oit.h"
+#include "shaders/fxaa.h"
+#include "shaders/features.h"
 // rendering framework
 #include "GeometricTools.h"
+#include "VertexQuantization.h"
 #include "IndexBuffer.h"
 #include "VertexBuffer.h"
 #include "VertextArray.h"
+#include "MeshArena.h"
+#include "MeshCache.h"
 #include "Shader.h"
+#include "ShaderPermutations.h"
 #include "OrthographicCamera.h"
 #include "PerspectiveCamera.h"
 #include "TextureManager.h"
+#include "RenderStats.h"
+#include "TransformSystem.h"
+#include "DepthSort.h"
+#include "OcclusionCuller.h"
+#include "WeightedBlendedOIT.h"
+#include "Framebuffer.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "FramePacketQueue.h"
+#include "SoftwareRenderer.h"
+#include "softwareshaders.h"
+#include "benchmark.h"
+// profiling (compiled out unless PROFILER_ENABLED)
+#include "Profiler.h"
+#include "BindlessTexture.h"
 #include <RenderCommands.h>
 // libraries
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 // std::time should be standart cpp function, but the build pipeline does not seem to find it so:
 #include <ctime>
@@ -25,6 +52,55 @@
 
 HomeExamApplication* HomeExamApplication::current_application = nullptr;
 
+// layouts of the compact vertex formats of VertexQuantization.h (see StaticBufferLayout.h)
+template<>
+struct VertexLayoutOf<GeometricTools::CompactVertexPN> {
+    static constexpr auto Get() {
+        using Vertex = GeometricTools::CompactVertexPN;
+        return std::array{
+            VERTEX_ATTRIBUTE(Vertex, Position, ShaderDataType::Half4, false),
+            VERTEX_ATTRIBUTE(Vertex, Normal, ShaderDataType::Int2101010Rev, true) // the norm vector (used for diffuse lighting)
+        };
+    }
+};
+
+template<>
+struct VertexLayoutOf<GeometricTools::CompactVertexPCT> {
+    static constexpr auto Get() {
+        using Vertex = GeometricTools::CompactVertexPCT;
+        return std::array{
+            VERTEX_ATTRIBUTE(Vertex, Position, ShaderDataType::Half4, false),
+            VERTEX_ATTRIBUTE(Vertex, Color, ShaderDataType::UByte4, true),
+            VERTEX_ATTRIBUTE(Vertex, TexCoords, ShaderDataType::Half2, false)
+        };
+    }
+};
+
+// an arena holding just one mesh, with its 32-bit topology narrowed to Index
+template<typename Index, typename Vertex>
+static std::shared_ptr<MeshArena> CreateMeshArenaWith(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                                      MeshAllocation& mesh) {
+    auto narrowed = GeometricTools::NarrowIndices<Index>(indices);
+    auto arena = MeshArena::Create<Vertex, Index>(static_cast<GLuint>(vertices.size()), static_cast<GLuint>(narrowed.size()));
+    if (!arena->Add(vertices.data(), static_cast<GLuint>(vertices.size()), narrowed.data(), static_cast<GLsizei>(narrowed.size()), mesh)) {
+        return nullptr;
+    }
+    return arena;
+}
+
+// an arena holding just one mesh, indexed with the smallest type (8, 16 or 32 bit) all of its indices fit in
+template<typename Vertex>
+static std::shared_ptr<MeshArena> CreateMeshArena(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                                  MeshAllocation& mesh) {
+    if (GeometricTools::IndicesFitIn<GLubyte>(indices)) {
+        return CreateMeshArenaWith<GLubyte>(vertices, indices, mesh);
+    }
+    if (GeometricTools::IndicesFitIn<GLushort>(indices)) {
+        return CreateMeshArenaWith<GLushort>(vertices, indices, mesh);
+    }
+    return CreateMeshArenaWith<GLuint>(vertices, indices, mesh);
+}
+
 HomeExamApplication::HomeExamApplication(const std::string& name, const std::string& version,
     unsigned int width, unsigned int height) : GLFWApplication(name, version, width, height) {
 
@@ -33,7 +109,10 @@ HomeExamApplication::HomeExamApplication(const std::string& name, const std::str
 
     moveCounter = 0;
 
-    toggleTexture = 0.0f;
+    textureFeature = 0;
+
+    randomSeed = static_cast<unsigned>(std::time(nullptr));
+    startTime = std::chrono::steady_clock::now();
 }
 
 HomeExamApplication::~HomeExamApplication() = default;
@@ -85,16 +164,50 @@ void HomeExamApplication::key_callback(GLFWwindow* window, int key, int scancode
             break;
         }
     }
+    // capture keys do not repeat
+    if (action == GLFW_PRESS) {
+        switch (key) {
+        case GLFW_KEY_F12:
+            getHomeExamApplication()->takeScreenshot();
+            break;
+        case GLFW_KEY_F9:
+            getHomeExamApplication()->toggleRecording();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void HomeExamApplication::refresh_callback(GLFWwindow* window) {
+    getHomeExamApplication()->sceneDirty = true;
 }
 
 void HomeExamApplication::setTextureState() {
-    toggleTexture = (toggleTexture == 0.0f) ? 1.0f : 0.0f;
+    textureFeature ^= TexturedFeature;
+    sceneDirty = true;
+}
+
+void HomeExamApplication::takeScreenshot() {
+    screenshotPath = "screenshot_" + std::to_string(++captureNumber) + ".png";
+    sceneDirty = true;
+}
+
+void HomeExamApplication::toggleRecording() {
+    if (recordingPath.empty()) {
+        recordingPath = "recording_" + std::to_string(++captureNumber) + ".y4m";
+        std::cout << "Recording to " << recordingPath << std::endl;
+    }
+    else {
+        recordingPath.clear();
+    }
 }
 
 /*current X Selected goes from 0 to numberOfSquares-1 -> [0,9]
   same for Y Selected. 
  */
 void HomeExamApplication::move(Direction direction) {
+    sceneDirty = true;
     TileInfo nextTile;
     TileInfo* nextTileAfter = nullptr;
     switch (direction) {
@@ -110,8 +223,7 @@ void HomeExamApplication::move(Direction direction) {
                 break;
             }
             else if (!nextTileAfter->hasBox && !nextTileAfter->hasObstacle && !nextTileAfter->hasPillar) {
-                GridState[currentXSelected * 10 + currentYSelected + 1].hasBox = false;
-                GridState[currentXSelected * 10 + currentYSelected + 2].hasBox = true;
+                pushBox(currentXSelected * 10 + currentYSelected + 1, currentXSelected * 10 + currentYSelected + 2);
             }
             else {
                 break; // cancel movement if the tile behind the box has a box, wall or pillar standing on it
@@ -131,8 +243,7 @@ void HomeExamApplication::move(Direction direction) {
                 break;
             }
             else if (!nextTileAfter->hasBox && !nextTileAfter->hasObstacle && !nextTileAfter->hasPillar) {
-                GridState[currentXSelected * 10 + currentYSelected - 1].hasBox = false;
-                GridState[currentXSelected * 10 + currentYSelected - 2].hasBox = true;
+                pushBox(currentXSelected * 10 + currentYSelected - 1, currentXSelected * 10 + currentYSelected - 2);
             }
             else {
                 break;
@@ -152,8 +263,7 @@ void HomeExamApplication::move(Direction direction) {
                 break;
             }
             else if (!nextTileAfter->hasBox && !nextTileAfter->hasObstacle && !nextTileAfter->hasPillar) {
-                GridState[(currentXSelected + 1) * 10 + currentYSelected].hasBox = false;
-                GridState[(currentXSelected + 2) * 10 + currentYSelected].hasBox = true;
+                pushBox((currentXSelected + 1) * 10 + currentYSelected, (currentXSelected + 2) * 10 + currentYSelected);
             }
             else {
                 break;
@@ -173,8 +283,7 @@ void HomeExamApplication::move(Direction direction) {
                 break;
             }
             else if (!nextTileAfter->hasBox && !nextTileAfter->hasObstacle && !nextTileAfter->hasPillar) {
-                GridState[(currentXSelected - 1) * 10 + currentYSelected].hasBox = false;
-                GridState[(currentXSelected - 2) * 10 + currentYSelected].hasBox = true;
+                pushBox((currentXSelected - 1) * 10 + currentYSelected, (currentXSelected - 2) * 10 + currentYSelected);
             }
             else {
                 break;
@@ -186,22 +295,57 @@ void HomeExamApplication::move(Direction direction) {
     default:
         break;
     }
+    scene.SetTranslation(playerObject, tileTranslation(currentXSelected, currentYSelected, archetypeInstances[SceneStore::Player].translation.z));
+}
+
+void HomeExamApplication::pushBox(int fromTile, int toTile) {
+    SceneStore::Handle box = GridState[fromTile].box;
+    GridState[fromTile].hasBox = false;
+    GridState[fromTile].box = SceneStore::Handle();
+    GridState[toTile].hasBox = true;
+    GridState[toTile].box = box;
+
+    TileInfo& tile = GridState[toTile];
+    SceneStore::Archetype archetype = tile.hasBoxDest ? SceneStore::BoxOnGoal : SceneStore::Box;
+    scene.SetArchetype(box, archetype);
+    scene.SetTranslation(box, tileTranslation(static_cast<unsigned int>(tile.currentPos.x),
+        static_cast<unsigned int>(tile.currentPos.y), archetypeInstances[archetype].translation.z));
+}
+
+glm::vec3 HomeExamApplication::tileTranslation(unsigned int x, unsigned int y, float z) const {
+    // HINT: from our perspective the x movement works inverted in relation to the board coordinates
+    float sideLength = 2.0f / static_cast<float>(numberOfSquare);
+    float targetXOffset = sideLength / 2 + 4 * sideLength;
+    float targetYOffset = sideLength / 2 - 5 * sideLength;
+    return glm::vec3(targetXOffset - sideLength * x, targetYOffset + sideLength * y, z);
 }
 
 void HomeExamApplication::rotate(float degree) {
     camera.rotateArroundLookAt(degree);
+    sceneDirty = true;
 }
 
 void HomeExamApplication::zoom(float zoomValue) {
     camera.zoom(zoomValue);
+    sceneDirty = true;
 }
 
 
 
 void HomeExamApplication::setupWarehouse(int numOfPillars, int numOfBoxes, int numOfBoxDest)
 {
-    // Seed the random number generator with the current time
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
+    // appearance of the archetypes (translation.z is the height above the grid)
+    float sideLength = 2.0f / static_cast<float>(numberOfSquare);
+    archetypeInstances[SceneStore::Wall] = { glm::vec3(0, 0, sideLength / 2), glm::vec3(0.98, 0.98, 1.0), glm::vec4(wallsColor, 0.98), BlackMarmorMaterial };
+    archetypeInstances[SceneStore::Pillar] = { glm::vec3(0, 0, sideLength / 2), glm::vec3(0.5, 0.5, 1.0), glm::vec4(pillarCollor, 1.0), BlackMarmorMaterial };
+    archetypeInstances[SceneStore::Box] = { glm::vec3(0, 0, sideLength / 4), glm::vec3(0.8, 0.8, 0.6), glm::vec4(boxColor, 1.0), WoodMaterial };
+    archetypeInstances[SceneStore::Goal] = { glm::vec3(0, 0, 0), glm::vec3(0.8, 0.8, 0.1), glm::vec4(boxDestColor, 1.0), RuneMaterial };
+    archetypeInstances[SceneStore::BoxOnGoal] = { glm::vec3(0, 0, sideLength / 4), glm::vec3(0.8, 0.8, 0.6), glm::vec4(boxCorrectPosColor, 1.0), WoodMaterial };
+    archetypeInstances[SceneStore::Player] = { glm::vec3(0, 0, 0.001), glm::vec3(0.8, 0.8, 0.9), glm::vec4(playerColor, 1.0), BlackMarmorMaterial };
+    archetypeInstances[SceneStore::Light] = { glm::vec3(0), glm::vec3(0.4f), glm::vec4(1.0f), BlackMarmorMaterial };
+
+    // Seed the random number generator with the current time (or the benchmark seed)
+    std::srand(randomSeed);
     for (int x = 0; x < 10; ++x) {
         for (int y = 0; y < 10; ++y) {
             TileInfo tile;
@@ -309,6 +453,23 @@ void HomeExamApplication::setupWarehouse(int numOfPillars, int numOfBoxes, int n
             wasPlayerPlaced = true;
         }
     }
+
+    // fill the scene store from the board; a box on a goal hides the goal underneath it
+    scene.Clear();
+    numberOfBoxes = numOfBoxes;
+    for (TileInfo& tile : GridState) {
+        unsigned int x = static_cast<unsigned int>(tile.currentPos.x);
+        unsigned int y = static_cast<unsigned int>(tile.currentPos.y);
+        auto create = [&](SceneStore::Archetype archetype) {
+            return scene.Create(archetype, tileTranslation(x, y, archetypeInstances[archetype].translation.z));
+        };
+        if (tile.hasObstacle) create(SceneStore::Wall);
+        if (tile.hasPillar) create(SceneStore::Pillar);
+        if (tile.hasBoxDest) create(SceneStore::Goal);
+        if (tile.hasBox) tile.box = create(tile.hasBoxDest ? SceneStore::BoxOnGoal : SceneStore::Box);
+    }
+    playerObject = scene.Create(SceneStore::Player,
+        tileTranslation(currentXSelected, currentYSelected, archetypeInstances[SceneStore::Player].translation.z));
 }
 
 // outdated / not used. I'll leave it here just in case
@@ -390,346 +551,817 @@ unsigned HomeExamApplication::Run() {
 
     current_application = this;
 
+    // the translucent walls of the frame packets are reordered back to front through the depth sorter
+    DepthSorter depthSorter;
+    std::vector<CubeInstance> translucentInstances;
+    std::vector<float> translucentDepths;
+    // low resolution CPU depth buffer of the walls and pillars
+    OcclusionCuller occlusionCuller(128, 128);
+    const float cubeHalfSide = 1.0f / static_cast<float>(numberOfSquare); // of the unit cube at scale 1
+
     //--------------------------------------------------------------------------------------------------------------
     //
-    //  define vertices and indices for the grid and cube
+    // camera
     //
     //--------------------------------------------------------------------------------------------------------------
-    auto gridVertices = GeometricTools::UnitGridGeometry2DWTCoords(numberOfSquare);
-    auto gridIndices = GeometricTools::UnitGrid2DTopology(numberOfSquare);
-
-    auto cubeVertices = unitCubeGeometry();
-    auto cubeIndices = GeometricTools::CubeTopology;
-
+    // Use PerspectiveCamera class instead
+    camera = PerspectiveCamera(
+        PerspectiveCamera::Frustrum{ glm::radians(45.0f), 1.0f, 1.0f, 1.0f, 10.0f }, // frustrum
+        glm::vec3(0.0f, -1.8f, 2.4f), // camera position
+        glm::vec3(0.0f, 0.0f, 0.0f), // lookAt
+        glm::vec3(0.0f, 0.0f, 1.0f) // upVector
+    );
 
     //--------------------------------------------------------------------------------------------------------------
     //
-    //  define the layout for the grid and cube
+    // start execution
     //
+    // important notice:
+    // for semi-transparancy (blending) to work opaque objects have to be drawn first!
+    // The translucent walls are drawn last, sorted back to front with depth writes off
+    // (or through the weighted blended OIT targets, which do not need an order).
     //--------------------------------------------------------------------------------------------------------------
+    // Renderloop variables
+    bool setup = true; // for units in first iteration
+    bool isGameWon = false;
 
-    // grid layout
-    auto gridLayout = std::make_shared<BufferLayout>(BufferLayout({
-        {ShaderDataType::Float3, "position", false},
-        {ShaderDataType::Float4, "color", false},
-        {ShaderDataType::Float2, "texCoords", false},
-        }));
+    setupWarehouse();
 
-    // cube layout
-    auto cubeLayout = std::make_shared<BufferLayout>(BufferLayout({
-        {ShaderDataType::Float3, "position", false},
-        {ShaderDataType::Float3, "normal", false} // the norm vector (used for diffuse lighting)
-        }));
+    // lighting variables
+    glm::vec3 lightColor = glm::vec3(1.0f, 1.0f, 1.0f); 
+    // place the light a bit to the right of where the player is looking from (at the start)
+    glm::vec3 lightPosition = glm::vec3(1.2f, 0.0f, 1.2f);
+    float ambientStrength = 1.0f;
+
+    // benchmark state: the script drives input and animation time, frames are not capped by vsync
+    unsigned int frameNumber = 0;
+    size_t nextBenchmarkEvent = 0;
+    if (!benchmark) {
+        // handle input
+        glfwSetKeyCallback(window, HomeExamApplication::key_callback);
+        glfwSetWindowRefreshCallback(window, HomeExamApplication::refresh_callback);
+    }
+
+    // The sun moves in steps of 1 / sunUpdateRate seconds (benchmarks: one step per frame at 60 per second),
+    // so render-on-demand knows when the next frame is due.
+    auto sunAnimationTime = [&](double now) {
+        if (benchmark) return frameNumber / 60.0;
+        return sunUpdateRate > 0.0f ? std::floor(now * sunUpdateRate) / sunUpdateRate : 0.0;
+    };
+    double drawnSunTime = -1.0;
+
+    // transforms of the objects drawn with their own matrices (the grid); the cubes live in the scene store
+    TransformSystem transforms;
+    TransformSystem::Handle gridTransform = transforms.Create();
+    lightObject = scene.Create(SceneStore::Light, lightPosition);
 
     //--------------------------------------------------------------------------------------------------------------
     //
-    //  prepping for the grid and the cube
+    // render thread
     //
+    // The main thread handles input, updates the game and records a FramePacket per frame. The render
+    // thread owns the GL context from here on (or the software renderer, see renderFramesSoftware) and
+    // draws the packets, so the update of frame N+1 overlaps with the submission of frame N.
     //--------------------------------------------------------------------------------------------------------------
+    FramePacketQueue<FramePacket> framePackets;
+    RenderThreadState renderState;
+    renderState.weightedOITAvailable.store(weightedOIT);
+    glfwGetFramebufferSize(window, &renderState.framebufferWidth, &renderState.framebufferHeight);
 
-    // VAO Grid
-    auto VAO_Grid = std::make_shared<VertexArray>();
-    VAO_Grid->Bind();
-    auto VBO_Grid = std::make_shared<VertexBuffer>(gridVertices.data(), sizeof(float) * gridVertices.size());
-    VBO_Grid->SetLayout(*gridLayout);
-    VAO_Grid->AddVertexBuffer(VBO_Grid);
-    auto IBO_Grid = std::make_shared<IndexBuffer>(gridIndices.data(), static_cast<GLsizei>(gridIndices.size()));
-    VAO_Grid->SetIndexBuffer(IBO_Grid);
-
-    // VAO Cube
-    auto VAO_Cube = std::make_shared<VertexArray>();
-    VAO_Cube->Bind();
-    auto VBO_Cube = std::make_shared<VertexBuffer>(cubeVertices.data(),
-        sizeof(float) * cubeVertices.size());
-    VBO_Cube->SetLayout(*cubeLayout);
-    VAO_Cube->AddVertexBuffer(VBO_Cube);
-    auto IBO_Cube = std::make_shared<IndexBuffer>(cubeIndices.data(),
-        static_cast<GLsizei>(cubeIndices.size()));
-    VAO_Cube->SetIndexBuffer(IBO_Cube);
+    if (!IsSoftware()) {
+        glfwMakeContextCurrent(nullptr);
+    }
+    std::thread renderThread([&]() {
+        PROFILE_THREAD_NAME("Render");
+        if (IsSoftware()) {
+            renderFramesSoftware(framePackets, renderState);
+        }
+        else {
+            renderFramesGL(framePackets, renderState);
+        }
+    });
+    // meshes, shaders and textures are created on the render thread, record frames once they exist
+    if (!renderState.ready.get_future().get()) {
+        std::cerr << "The render thread could not set up the scene" << std::endl;
+        renderThread.join();
+        if (!IsSoftware()) {
+            glfwMakeContextCurrent(window);
+        }
+        stop();
+        return EXIT_FAILURE;
+    }
+    // benchmarks: the render thread waited for the textures above, which is reported apart from the start-up time
+    double texturesReadyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    size_t seenPendingTextures = renderState.pendingTextures.load();
 
 
+    PROFILE_THREAD_NAME("Main");
+    while (!glfwWindowShouldClose(window))
+    {
+        // a texture finished loading on the render thread
+        size_t texturesLoading = renderState.pendingTextures.load();
+        if (texturesLoading != seenPendingTextures) {
+            seenPendingTextures = texturesLoading;
+            sceneDirty = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(renderState.recordingMutex);
+            if (!renderState.stoppedRecording.empty() && renderState.stoppedRecording == recordingPath) {
+                std::cout << "Recording to " << recordingPath << " stopped" << std::endl;
+                recordingPath.clear();
+            }
+            renderState.stoppedRecording.clear();
+        }
+
+        // render-on-demand: sleep until input arrives, a texture finished loading or the sun has to move
+        // (a recording gets every frame)
+        double now = glfwGetTime();
+        if (renderOnDemand && !benchmark && recordingPath.empty() && !sceneDirty && sunAnimationTime(now) == drawnSunTime) {
+            double timeout = -1.0; // wait for input only
+            if (sunUpdateRate > 0.0f) timeout = drawnSunTime + 1.0 / sunUpdateRate - now;
+            if (texturesLoading > 0) timeout = timeout < 0.0 ? 1.0 / 30.0 : std::min(timeout, 1.0 / 30.0);
+
+            if (timeout < 0.0) glfwWaitEvents();
+            else glfwWaitEventsTimeout(timeout);
+            continue;
+        }
+        sceneDirty = false;
+
+        PROFILE_CPU_ZONE("frame");
+
+        // scripted input
+        if (benchmark) {
+            for (; nextBenchmarkEvent < benchmark->events.size() && benchmark->events[nextBenchmarkEvent].frame <= frameNumber; ++nextBenchmarkEvent) {
+                const BenchmarkEvent& event = benchmark->events[nextBenchmarkEvent];
+                switch (event.type) {
+                case BenchmarkEvent::Move: move(event.direction); break;
+                case BenchmarkEvent::Zoom: zoom(event.value); break;
+                case BenchmarkEvent::Rotate: rotate(event.value); break;
+                case BenchmarkEvent::ToggleTexture: setTextureState(); break;
+                }
+            }
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+        //
+        // lighting
+        //
+        //--------------------------------------------------------------------------------------------------------------
+        
+        // change the light's position values over time (glfwGetTime returns the elapsed time in seconds)
+        float radius = 2.0f;
+        float rotationSpeed = 0.15f;
+        double animationTime = sunAnimationTime(now);
+        drawnSunTime = animationTime;
+        lightPosition.x = radius * cos(rotationSpeed * animationTime);
+        lightPosition.z = radius * sin(rotationSpeed * animationTime);
+
+        // set lightIntensity in relation to the sun's apex
+        if (ambientStrength >= 0.5) ambientStrength = (lightPosition.z + 2) / 4;
+
+        // only the sun moved (if at all); the camera change is picked up by Update()
+        scene.SetTranslation(lightObject, lightPosition);
+        transforms.Update(camera.GetViewProjectionMatrix());
+
+        // record the frame for the render thread
+        FramePacket& packet = framePackets.BeginWrite();
+        packet.viewProjection = camera.GetViewProjectionMatrix();
+        packet.gridModel = transforms.GetModel(gridTransform);
+        packet.gridMVP = transforms.GetMVP(gridTransform);
+        packet.cameraPosition = camera.GetPosition();
+        packet.lightPosition = lightPosition;
+        packet.lightColor = lightColor;
+        packet.ambientStrength = ambientStrength;
+        packet.textureFeature = textureFeature;
+        glfwGetFramebufferSize(window, &packet.framebufferWidth, &packet.framebufferHeight);
+        packet.screenshotPath.swap(screenshotPath);
+        screenshotPath.clear();
+        packet.recordingPath = recordingPath;
+        std::vector<CubeInstance>& cubeInstances = packet.instances;
+
+        // instance buffer: opaque tiles, player, translucent tiles, sun. Every archetype is copied as one
+        // dense run, so the order of the archetypes below is the draw order.
+        {
+            PROFILE_CPU_ZONE("scene instances");
+            cubeInstances.clear();
+
+            // rasterise the walls and pillars as occluders (the walls are nearly opaque)
+            if (occlusionCulling) {
+                PROFILE_CPU_ZONE("occlusion culling");
+                occlusionCuller.Begin(camera.GetViewProjectionMatrix());
+                for (SceneStore::Archetype archetype : { SceneStore::Wall, SceneStore::Pillar }) {
+                    const SceneStore::Columns& columns = scene.Get(archetype);
+                    glm::vec3 halfExtent = archetypeInstances[archetype].scale * cubeHalfSide;
+                    for (size_t i = 0; i < columns.Size(); ++i) {
+                        occlusionCuller.AddOccluder(glm::vec3(columns.TranslationX[i], columns.TranslationY[i], columns.TranslationZ[i]), halfExtent);
+                    }
+                }
+                occlusionCuller.Rasterize();
+            }
+
+            auto appendArchetype = [&](SceneStore::Archetype archetype) {
+                const SceneStore::Columns& columns = scene.Get(archetype);
+                CubeInstance instance = archetypeInstances[archetype];
+                for (size_t i = 0; i < columns.Size(); ++i) {
+                    instance.translation = glm::vec3(columns.TranslationX[i], columns.TranslationY[i], columns.TranslationZ[i]);
+                    cubeInstances.push_back(instance);
+                }
+            };
+            // same as appendArchetype, but leaves out the objects hidden behind the occluders
+            auto appendVisible = [&](SceneStore::Archetype archetype) {
+                if (!occlusionCulling) {
+                    appendArchetype(archetype);
+                    return;
+                }
+                const SceneStore::Columns& columns = scene.Get(archetype);
+                CubeInstance instance = archetypeInstances[archetype];
+                glm::vec3 halfExtent = instance.scale * cubeHalfSide;
+                for (size_t i = 0; i < columns.Size(); ++i) {
+                    instance.translation = glm::vec3(columns.TranslationX[i], columns.TranslationY[i], columns.TranslationZ[i]);
+                    if (occlusionCuller.IsVisible(instance.translation, halfExtent)) {
+                        cubeInstances.push_back(instance);
+                    }
+                }
+            };
+            appendVisible(SceneStore::Goal);
+            appendVisible(SceneStore::Pillar);
+            // the boxes are drawn with the crate model
+            packet.boxStart = static_cast<GLsizei>(cubeInstances.size());
+            appendVisible(SceneStore::Box);
+            appendVisible(SceneStore::BoxOnGoal);
+            packet.tileCount = static_cast<GLsizei>(cubeInstances.size());
+            appendArchetype(SceneStore::Player);
+            // walls are semi-transparent and go into their own batch that is drawn last
+            size_t translucentStart = cubeInstances.size();
+            appendArchetype(SceneStore::Wall);
+            packet.translucentCount = static_cast<GLsizei>(scene.Count(SceneStore::Wall));
+            packet.weightedOIT = weightedOIT && renderState.weightedOITAvailable.load();
+            if (!packet.weightedOIT) {
+                PROFILE_CPU_ZONE("depth sort");
+                // view depth of each wall (distance in front of the camera), blended farthest first
+                const glm::mat4& view = camera.GetViewMatrix();
+                glm::vec4 depthRow = -glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+                translucentDepths.clear();
+                translucentInstances.assign(cubeInstances.begin() + translucentStart, cubeInstances.end());
+                for (const CubeInstance& instance : translucentInstances) {
+                    translucentDepths.push_back(glm::dot(depthRow, glm::vec4(instance.translation, 1.0f)));
+                }
+                const std::vector<uint32_t>& order = depthSorter.SortBackToFront(translucentDepths.data(), translucentDepths.size());
+                for (size_t i = 0; i < order.size(); ++i) {
+                    cubeInstances[translucentStart + i] = translucentInstances[order[i]];
+                }
+            }
+            appendArchetype(SceneStore::Light);
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+        //
+        // check win condition
+        //
+        //--------------------------------------------------------------------------------------------------------------
+        if (scene.Count(SceneStore::BoxOnGoal) == numberOfBoxes && !isGameWon)
+        {
+            std::cout << "Won Game with " << moveCounter << " moves!" << std::endl;
+            isGameWon = true;
+        }
+
+        framePackets.Submit();
+        glfwPollEvents();
+
+        // benchmarks: the last packet is recorded, the render thread presents it before it exits
+        if (benchmark && frameNumber + 1 >= benchmark->warmupFrames + benchmark->frames) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+        frameNumber++;
+    }
+
+    // let the render thread finish the last packet and take the context back
+    framePackets.Close();
+    renderThread.join();
+    if (!IsSoftware()) {
+        glfwMakeContextCurrent(window);
+    }
+
+    // benchmarks: frame times are the intervals between the presents on the render thread (the first
+    // one starts when it was ready), so the GPU and the render thread are measured, not just the recording
+    if (benchmark) {
+        const auto& presentTimes = renderState.presentTimes;
+        auto milliseconds = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+        std::vector<double> frameTimesMs;
+        frameTimesMs.reserve(benchmark->frames);
+        for (size_t i = benchmark->warmupFrames; i < presentTimes.size(); ++i) {
+            auto previous = i == 0 ? renderState.renderStart : presentTimes[i - 1];
+            frameTimesMs.push_back(milliseconds(presentTimes[i] - previous));
+        }
+        if (frameTimesMs.size() >= benchmark->frames) {
+            double startupMs = milliseconds(presentTimes.front() - startTime) - renderState.textureWaitMs;
+            WriteBenchmarkReport(benchmarkReportPath, *benchmark, frameTimesMs, startupMs, texturesReadyMs);
+        }
+        else {
+            std::cerr << "The benchmark stopped after " << frameTimesMs.size() << " of " << benchmark->frames
+                      << " measured frames, no report was written" << std::endl;
+        }
+    }
+
+    PROFILE_WRITE_TRACE("homeexam_trace.json");
+    return stop();
+}
+
+void HomeExamApplication::renderFramesGL(FramePacketQueue<FramePacket>& framePackets, RenderThreadState& state) {
+    glfwMakeContextCurrent(window);
+
     //--------------------------------------------------------------------------------------------------------------
     //
-    // Shader setup for the grid and cube
+    //  define vertices and indices for the grid and cube
     //
     //--------------------------------------------------------------------------------------------------------------
-    std::unique_ptr<Shader> shaderGrid = std::make_unique<Shader>(VS_Grid, FS_Grid);
-    std::unique_ptr<Shader> shaderCube = std::make_unique<Shader>(VS_Cube, FS_Cube);
-    std::unique_ptr<Shader> shaderSun = std::make_unique<Shader>(VS_Sun, FS_Sun);
+    // both meshes are quantized to compact vertex formats (half float positions, packed normals,
+    // normalized byte colors) and the smallest index type their topology fits in, to reduce the memory
+    // bandwidth per vertex. The grid is generated straight into its compact format, without a float
+    // mesh in between; the cube shares its 16-bit arena with the crate model.
+    std::vector<GeometricTools::CompactVertexPCT> gridVertices(GeometricTools::GridVertexCount(numberOfSquare));
+    std::vector<GLuint> gridIndices(GeometricTools::GridIndexCount(numberOfSquare));
+    if (!GeometricTools::GenerateGridVertices(numberOfSquare, gridVertices.data(), gridVertices.size())
+        || !GeometricTools::GenerateGridTopology(numberOfSquare, gridIndices.data(), gridIndices.size())) {
+        glfwMakeContextCurrent(nullptr);
+        state.ready.set_value(false);
+        return;
+    }
+
+    auto cubeVertices = GeometricTools::QuantizePositionNormal(unitCubeGeometry());
+    if (!GeometricTools::IndicesFitIn<GLushort>(GeometricTools::CubeTopology)) {
+        std::cerr << "The cube topology does not fit into 16-bit indices" << std::endl;
+        glfwMakeContextCurrent(nullptr);
+        state.ready.set_value(false);
+        return;
+    }
+    auto cubeIndices = GeometricTools::NarrowIndices<GLushort>(GeometricTools::CubeTopology);
+
 
     //--------------------------------------------------------------------------------------------------------------
     //
-    // camera
+    //  define the layout for the grid and cube
     //
     //--------------------------------------------------------------------------------------------------------------
-    // Use PerspectiveCamera class instead
-    camera = PerspectiveCamera(
-        PerspectiveCamera::Frustrum{ glm::radians(45.0f), 1.0f, 1.0f, 1.0f, 10.0f }, // frustrum
-        glm::vec3(0.0f, -1.8f, 2.4f), // camera position
-        glm::vec3(0.0f, 0.0f, 0.0f), // lookAt
-        glm::vec3(0.0f, 0.0f, 1.0f) // upVector
-    );
+    // the layouts are derived from the vertex structs at compile time (see the VertexLayoutOf
+    // specialisations above and CubeInstance::Layout), checked against the shader inputs here
+    static_assert(MatchesShaderInputs<GeometricTools::CompactVertexPCT>({ ShaderDataType::Float3, ShaderDataType::Float4, ShaderDataType::Float2 }),
+        "grid vertices do not match the inputs of VS_Grid");
+    static_assert(MatchesShaderInputs<GeometricTools::CompactVertexPN>({ ShaderDataType::Float3, ShaderDataType::Float3 }),
+        "cube vertices do not match the inputs of VS_Cube");
+    static_assert(MatchesShaderInputs<CubeInstance>({ ShaderDataType::Float3, ShaderDataType::Float3, ShaderDataType::Float4, ShaderDataType::Int }),
+        "cube instances do not match the per-instance inputs of VS_Cube");
 
     //--------------------------------------------------------------------------------------------------------------
     //
-    // Texture module
+    //  prepping for the grid and the cube
     //
     //--------------------------------------------------------------------------------------------------------------
-    TextureManager* textureManager = TextureManager::GetInstance();
-    // Load 2D texture for the grid
-    bool success2D = textureManager->LoadTexture2DRGBA("gridTexture", "resources/textures/floor_texture.png", 0, true);
-    if (!success2D) {
-        std::cout << "2D Texture not loaded correctly." << std::endl;
-    }
-    // Give the textures to the shader
-    GLuint gridTexture = textureManager->GetUnitByName("gridTexture");
 
-    // Load Rune Cube Map
-    bool successCube = textureManager->LoadCubeMapRGBA("runeTexture", "resources/textures/cube_texture.png", 1, true);
-    if (!successCube) {
-        std::cout << "Cube Map not loaded correctly." << std::endl;
+    // One arena (shared vertex and index buffers with one VertexArray) per vertex format. The
+    // grid arena holds just the grid; the cube arena has room for further position/normal
+    // meshes, which are then drawn without switching the VertexArray.
+    MeshAllocation gridMesh;
+    auto gridArena = CreateMeshArena(gridVertices, gridIndices, gridMesh);
+    if (!gridArena) {
+        glfwMakeContextCurrent(nullptr);
+        state.ready.set_value(false);
+        return;
     }
-    GLuint runeCubeMap = textureManager->GetUnitByName("runeTexture");
 
-    // Load black marmor Cube Map
-    successCube = textureManager->LoadCubeMapRGBA("blackMarmorTexture", "resources/textures/black-tile.jpg", 2, true);
-    if (!successCube) {
-        std::cout << "Cube Map not loaded correctly." << std::endl;
-    }
-    GLuint blackMarmorCubeMap = textureManager->GetUnitByName("blackMarmorTexture");
+    auto cubeArena = MeshArena::Create<GeometricTools::CompactVertexPN, GLushort>(1 << 16, 3 << 16);
+    MeshAllocation cubeMesh;
+    cubeArena->Add(cubeVertices.data(), static_cast<GLuint>(cubeVertices.size()),
+        cubeIndices.data(), static_cast<GLsizei>(cubeIndices.size()), cubeMesh);
 
-    // Load wood Cube Map
-    successCube = textureManager->LoadCubeMapRGBA("woodTexture", "resources/textures/floor_texture.png", 3, true);
-    if (!successCube) {
-        std::cout << "Cube Map not loaded correctly." << std::endl;
+    // the crate model, imported from OBJ on the first run and mapped from its mesh cache afterwards.
+    // It is fitted into the unit cube, so the box instances keep their scale and occlusion bounds.
+    MeshAllocation crateMesh = cubeMesh;
+    {
+        MeshCache::ImportOptions crateOptions;
+        crateOptions.FitHalfExtent = 1.0f / static_cast<float>(numberOfSquare); // half side of the unit cube
+        MeshCache::Mesh crate;
+        if (MeshCache::LoadOrImport(std::string(MODELS_DIR) + "crate.obj", crateOptions, crate)) {
+            if (crate.IndexSize != sizeof(GLushort) || !cubeArena->Add(crate.Vertices, crate.VertexCount, crate.Indices,
+                                                                      static_cast<GLsizei>(crate.IndexCount), crateMesh)) {
+                std::cerr << "The crate model does not fit into the cube arena, boxes are drawn as cubes" << std::endl;
+            }
+        }
     }
-    GLuint woodCubeMap = textureManager->GetUnitByName("woodTexture");
 
+    // per-instance data of the cube batches: one entry per scene object (recorded into the frame packets)
+    auto VBO_CubeInstances = std::make_shared<VertexBuffer>(nullptr,
+        sizeof(CubeInstance) * (2 * numberOfSquare * numberOfSquare + 2), GL_DYNAMIC_DRAW); // a goal and a box can share a tile
+    cubeArena->GetVertexArray()->AddInstanceBuffer<CubeInstance>(VBO_CubeInstances);
 
-    glEnable(GL_MULTISAMPLE);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBlendEquation(GL_FUNC_ADD);
 
     //--------------------------------------------------------------------------------------------------------------
     //
-    // start execution
+    // Shader setup for the grid and cube
     //
-    // important notice:
-    // for semi-transparancy (blending) to work opaque objects have to be drawn first!
-    // Also OpenGL Depth-Test functionality might interfere
     //--------------------------------------------------------------------------------------------------------------
-    // Renderloop variables
-    glm::mat4 cubeModel = glm::mat4(1.0f);
+    // every draw picks the variant compiled for exactly the features it needs (see shaders/features.h)
+    ShaderPermutations shadersGrid(VS_Grid, FS_Grid, ShaderFeatureNames);
+    ShaderPermutations shadersCube(VS_Cube, FS_Cube, ShaderFeatureNames);
+    // compile the variants the T key switches between up front, so toggling does not stall
+    shadersGrid.Precompile({ LitFeature, LitFeature | TexturedFeature });
+    shadersCube.Precompile({
+        0, // sun
+        LitFeature,
+        LitFeature | BlendedFeature,
+        LitFeature | TexturedFeature,
+        LitFeature | TexturedFeature | BlendedFeature
+        });
+    if (weightedOIT) {
+        shadersCube.Precompile({ LitFeature | BlendedFeature | WeightedOITFeature, LitFeature | TexturedFeature | BlendedFeature | WeightedOITFeature });
+    }
+    // resolves the weighted blended OIT targets, see shaders/oit.h
+    std::unique_ptr<Shader> shaderOITComposite;
+    if (weightedOIT) {
+        shaderOITComposite = std::make_unique<Shader>(VS_OITComposite, FS_OITComposite);
+    }
+    // filters and scales the scene target to the output in the FXAA mode, see shaders/fxaa.h
+    std::unique_ptr<Shader> shaderFXAA;
+    if (antiAliasing == AntiAliasing::FXAA) {
+        shaderFXAA = std::make_unique<Shader>(VS_FXAA, FS_FXAA);
+    }
 
-    bool setup = true; // for units in first iteration
-    bool isGameWon = false;
+    //--------------------------------------------------------------------------------------------------------------
+    //
+    // Texture module
+    //
+    //--------------------------------------------------------------------------------------------------------------
+    TextureManager* textureManager = TextureManager::GetInstance();
+    // All textures are decoded on worker threads; a grey placeholder is bound to each unit
+    // until textureManager->ProcessPendingUploads() swaps in the real image during the render loop.
+    // Load 2D texture for the grid
+    GLuint gridTexture = textureManager->LoadTexture2DRGBAAsync("gridTexture", "resources/textures/floor_texture.png", 0, true);
 
-    setupWarehouse();
+    // Load the materials of all cubes into one cube map array (layer = Material), so the whole
+    // batch is drawn without switching textures
+    GLuint materialsCubeMapArray = textureManager->LoadCubeMapArrayRGBAAsync("materials", {
+        "resources/textures/black-tile.jpg",    // BlackMarmorMaterial
+        "resources/textures/floor_texture.png", // WoodMaterial
+        "resources/textures/cube_texture.png"   // RuneMaterial
+        }, 1, true);
+    // with GL_ARB_bindless_texture the array is addressed by handle once it is loaded
+    bool useBindlessMaterials = BindlessTexture::IsSupported();
+    unsigned int materialFeatures = 0; // becomes BindlessMaterialsFeature once the handle is set
 
-    // lighting variables
-    glm::vec3 lightColor = glm::vec3(1.0f, 1.0f, 1.0f); 
-    // place the light a bit to the right of where the player is looking from (at the start)
-    glm::vec3 lightPosition = glm::vec3(1.2f, 0.0f, 1.2f);
-    float ambientStrength = 1.0f;
 
-    while (!glfwWindowShouldClose(window))
-    {
+    glEnable(GL_MULTISAMPLE);
+    glEnable(GL_DEPTH_TEST);
+    glBlendEquation(GL_FUNC_ADD); // blending is only enabled for the transparency pass
+    if (benchmark) {
+        glfwSwapInterval(0); // frames are not capped by vsync
+    }
+
+    // texture units 0 and 1 hold the grid texture and the materials
+    WeightedBlendedOIT weightedBlendedOIT(2, 3);
+
+    // The scene is drawn into sceneTarget at the render size chosen by dynamicResolution and
+    // scaled to the output (the window, or the render target of the headless backend) when it
+    // is presented. If the target cannot be created the scene is drawn into the output directly.
+    Framebuffer sceneTarget;
+    bool sceneTargetFailed = false;
+    GLsizei sceneSamples = antiAliasing == AntiAliasing::MSAA ? msaaSamples : 1;
+    DynamicResolution dynamicResolution(frameTimeTarget, minResolutionScale);
+    auto fullscreenArray = std::make_shared<VertexArray>(); // the FXAA triangle is generated from gl_VertexID
+    const GLuint sceneColorUnit = 4;
+
+    // size of the last drawn frame, for the capture after the loop
+    int lastOutputWidth = std::max(state.framebufferWidth, 1), lastOutputHeight = std::max(state.framebufferHeight, 1);
+
+    // screenshots and recordings of the output, read back without stalling (see FrameCapture)
+    FrameCapture frameCapture;
+    std::string activeRecording;
+    bool activeRecordingStopped = false; // reported to the main thread
+    auto reportStoppedRecording = [&]() {
+        std::lock_guard<std::mutex> lock(state.recordingMutex);
+        state.stoppedRecording = activeRecording;
+        activeRecordingStopped = true;
+    };
+
+    // benchmarks start with every texture in place, so no frame depends on how fast the decode threads are
+    if (benchmark) {
+        auto waitStart = std::chrono::steady_clock::now();
+        while (textureManager->GetPendingCount() > 0) {
+            textureManager->ProcessPendingUploads(SIZE_MAX);
+            if (textureManager->GetPendingCount() > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        state.textureWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+    }
+
+    state.pendingTextures.store(textureManager->GetPendingCount());
+    state.renderStart = std::chrono::steady_clock::now();
+    state.ready.set_value(true);
+
+    while (FramePacket* packet = framePackets.Acquire()) {
+        PROFILE_CPU_ZONE("render frame");
+
+        // replace texture placeholders whose images finished decoding
+        textureManager->ProcessPendingUploads();
+        state.pendingTextures.store(textureManager->GetPendingCount());
+
+        int outputWidth = std::max(packet->framebufferWidth, 1);
+        int outputHeight = std::max(packet->framebufferHeight, 1);
+        lastOutputWidth = outputWidth;
+        lastOutputHeight = outputHeight;
+        GLsizei renderWidth = outputWidth, renderHeight = outputHeight;
+        if (!sceneTargetFailed && !sceneTarget.Resize(outputWidth, outputHeight, sceneSamples)) {
+            sceneTargetFailed = true;
+        }
+        if (sceneTargetFailed) {
+            glBindFramebuffer(GL_FRAMEBUFFER, renderTarget);
+            glViewport(0, 0, outputWidth, outputHeight);
+        }
+        else {
+            dynamicResolution.GetRenderSize(outputWidth, outputHeight, renderWidth, renderHeight);
+            sceneTarget.Bind(renderWidth, renderHeight);
+        }
+        dynamicResolution.BeginFrame();
 
         //preparation of Window and Shader
         RenderCommands::SetClearColor(0.663f, 0.663f, 0.663f, 1.0f); // grey background
         RenderCommands::Clear();
 
-        // handle input
-        glfwSetKeyCallback(window, HomeExamApplication::key_callback);
+        // the grid and all opaque cubes are drawn without blending
+        glDisable(GL_BLEND);
 
-        //--------------------------------------------------------------------------------------------------------------
-        //
-        // lighting
-        //
-        //--------------------------------------------------------------------------------------------------------------
-        
-        // change the light's position values over time (glfwGetTime returns the elapsed time in seconds)
-        float radius = 2.0f;
-        float rotationSpeed = 0.15f;
-        lightPosition.x = radius * cos(rotationSpeed * glfwGetTime());
-        lightPosition.z = radius * sin(rotationSpeed * glfwGetTime());
-
-        // set lightIntensity in relation to the sun's apex
-        if (ambientStrength >= 0.5) ambientStrength = (lightPosition.z + 2) / 4;
+        {
+            PROFILE_ZONE("grid");
+            Shader& shaderGrid = shadersGrid.Get(LitFeature | packet->textureFeature);
+            gridArena->Bind();
+            shaderGrid.Bind();
+            shaderGrid.UploadUniformMatrix4fv("u_Model", packet->gridModel);
+            shaderGrid.UploadUniformMatrix4fv("u_MVP", packet->gridMVP);
+            shaderGrid.UploadUniformFloat1("u_AmbientStrength", packet->ambientStrength);
+            shaderGrid.UploadUniformFloat3("u_LightColor", packet->lightColor);
+            shaderGrid.UploadUniformFloat3("u_LightPosition", packet->lightPosition);
+            shaderGrid.UploadUniformFloat3("u_ViewPos", packet->cameraPosition);
+            if (packet->textureFeature) {
+                shaderGrid.UploadUniform1i("u_Texture", gridTexture);
+            }
+            RenderCommands::DrawMesh(GL_TRIANGLES, *gridArena, gridMesh);
+        }
 
+        VBO_CubeInstances->BufferSubData(0, sizeof(CubeInstance) * packet->instances.size(), packet->instances.data());
 
-        //--------------------------------------------------------------------------------------------------------------
-        //
-        // warehouse processing
-        //
-        //--------------------------------------------------------------------------------------------------------------
-        VAO_Grid->Bind();
-        shaderGrid->Bind();
-        shaderGrid->UploadUniformMatrix4fv("u_Model", camera.GetViewProjectionMatrix());
-        shaderGrid->UploadUniformMatrix4fv("u_View", camera.GetViewMatrix());
-        shaderGrid->UploadUniformMatrix4fv("u_Projection", camera.GetProjectionMatrix());
-        shaderGrid->UploadUniformFloat1("u_TextureState", static_cast<float>(toggleTexture));
-        shaderGrid->UploadUniformFloat1("u_AmbientStrength", ambientStrength);
-        shaderGrid->UploadUniformFloat3("u_LightColor", lightColor); 
-        shaderGrid->UploadUniformFloat3("u_LightPosition", lightPosition);
-        shaderGrid->UploadUniformFloat3("u_ViewPos", camera.GetPosition());
-        shaderGrid->UploadUniform1i("u_Texture", gridTexture);
-        RenderCommands::DrawIndex(GL_TRIANGLES, VAO_Grid);
-
-        // draw all obstacles, boxes and box Destinations according to the vector GridState
-        for (int tileIndex = 0; tileIndex < GridState.size(); tileIndex++) {
-            TileInfo tile = GridState[tileIndex];
-            // unit information
-            glm::vec3 currentColor;
-            float unitOpacity = 1;
-
-            glm::vec2 currentPosition = tile.currentPos;
-
-            // helper
-            float sideLength = 2.0f / static_cast<float>(numberOfSquare);
-            float targetXOffset = sideLength / 2 + 4 * sideLength;
-            float targetYOffset = sideLength / 2 - 5 * sideLength;
-
-            cubeModel = glm::mat4(1.0f);
-            float translationX = targetXOffset - sideLength * currentPosition[0];
-            float translationY = targetYOffset + sideLength * currentPosition[1];
-
-            // colloring, transforming and scaling units according to GridState
-            // box destinations
-            if (tile.hasBoxDest) {
-                currentColor = boxDestColor; 
-                cubeModel = glm::translate(cubeModel, glm::vec3(translationX, translationY, 0));
-                cubeModel = glm::scale(cubeModel, glm::vec3(0.8, 0.8, 0.1)); 
-            }
-            // boxes
-            if (tile.hasBox) {
-                currentColor = boxColor;
-                cubeModel = glm::translate(cubeModel, glm::vec3(translationX, translationY, sideLength / 4));
-                cubeModel = glm::scale(cubeModel, glm::vec3(0.8, 0.8, 0.6));
+        // switch to the bindless material handle as soon as the array finished loading
+        if (useBindlessMaterials && !materialFeatures && textureManager->IsReady("materials")) {
+            GLuint64 materialsHandle = textureManager->GetBindlessHandle("materials");
+            for (unsigned int blended : { 0u, static_cast<unsigned int>(BlendedFeature), BlendedFeature | WeightedOITFeature }) {
+                if ((blended & WeightedOITFeature) && !weightedOIT) continue;
+                Shader& shader = shadersCube.Get(LitFeature | TexturedFeature | BindlessMaterialsFeature | blended);
+                shader.Bind();
+                shader.UploadUniformHandle("u_Materials", materialsHandle);
             }
-            // walls
-            if (tile.hasObstacle) {
-                currentColor = wallsColor;
-                unitOpacity = 0.98;
-                cubeModel = glm::translate(cubeModel, glm::vec3(translationX, translationY, sideLength / 2));
-                cubeModel = glm::scale(cubeModel, glm::vec3(0.98, 0.98, 1.0)); 
-            }
-            // pillars
-            if (tile.hasPillar) {
-                currentColor = pillarCollor;
-                cubeModel = glm::translate(cubeModel, glm::vec3(translationX, translationY, sideLength / 2));
-                cubeModel = glm::scale(cubeModel, glm::vec3(0.5, 0.5, 1.0));
-            }
-            // box on correct spot
-            if (tile.hasBox && tile.hasBoxDest) {
-                cubeModel = glm::mat4(1.0f); 
-                cubeModel = glm::translate(cubeModel, glm::vec3(translationX, translationY, sideLength / 4)); 
-                cubeModel = glm::scale(cubeModel, glm::vec3(0.8, 0.8, 0.6)); 
-                currentColor = boxCorrectPosColor;
-            }
-            // empty tiles
-            if (!tile.hasObstacle && !tile.hasPillar && !tile.hasBox && !tile.hasBoxDest) {
-                continue;
-            }
-
-            VAO_Cube->Bind();
-            shaderCube->Bind();
-            shaderCube->UploadUniformMatrix4fv("u_Model", cubeModel * camera.GetViewProjectionMatrix());
-            shaderCube->UploadUniformMatrix4fv("u_View", camera.GetViewMatrix());
-            shaderCube->UploadUniformMatrix4fv("u_Projection", camera.GetProjectionMatrix());
-            shaderCube->UploadUniformFloat1("u_TextureState", static_cast<float>(toggleTexture));
-            shaderCube->UploadUniformFloat1("u_AmbientStrength", ambientStrength);
-            shaderCube->UploadUniformFloat1("u_Opacity", unitOpacity);
-            shaderCube->UploadUniformFloat3("u_Color", currentColor);
-            shaderCube->UploadUniformFloat3("u_LightColor", lightColor); 
-            shaderCube->UploadUniformFloat3("u_LightPosition", lightPosition);
-            shaderCube->UploadUniformFloat3("u_ViewPos", camera.GetPosition());
-            // upload corresponding cubemap
-            if (tile.hasPillar || tile.hasObstacle)
-                shaderCube->UploadUniform1i("CubeMap", blackMarmorCubeMap);
-            else if (tile.hasBox)
-                shaderCube->UploadUniform1i("CubeMap", woodCubeMap);
-            else
-                shaderCube->UploadUniform1i("CubeMap", runeCubeMap);
-            RenderCommands::DrawIndex(GL_TRIANGLES, VAO_Cube);
+            materialFeatures = BindlessMaterialsFeature;
         }
 
-        //--------------------------------------------------------------------------------------------------------------
-        //
-        // player processing
-        //
-        //--------------------------------------------------------------------------------------------------------------
-        float squareOpacity = 1.0f;
-
-        // helper
-        float sideLength = 2.0f / static_cast<float>(numberOfSquare);
-        float bottomRight = numberOfSquare * sideLength - 1;
-
-        // translating square
-        cubeModel = glm::mat4(1.0f);
-        // HINT: from our perspective the x movement works inverted in relation to the board coordinates
-        float translationX = bottomRight - sideLength / 2 - currentXSelected * sideLength;
-        float translationY = bottomRight + sideLength / 2 - sideLength * numberOfSquare + currentYSelected * sideLength;
-        cubeModel = glm::translate(cubeModel, glm::vec3(translationX, translationY, 0.001));
-        cubeModel = glm::scale(cubeModel, glm::vec3(0.8, 0.8, 0.9));
-
-        // bind square buffer, upload square uniforms and draw square
-        VAO_Cube->Bind();
-        shaderCube->Bind();
-        shaderCube->UploadUniformMatrix4fv("u_Model", cubeModel * camera.GetViewProjectionMatrix());
-        shaderCube->UploadUniformMatrix4fv("u_View", camera.GetViewMatrix());
-        shaderCube->UploadUniformMatrix4fv("u_Projection", camera.GetProjectionMatrix());
-        shaderCube->UploadUniformFloat1("u_AmbientStrength", ambientStrength);
-        shaderCube->UploadUniformFloat3("u_Color", playerColor);
-        shaderCube->UploadUniformFloat3("u_LightColor", lightColor);
-        shaderCube->UploadUniformFloat3("u_LightPosition", lightPosition); 
-        shaderCube->UploadUniformFloat3("u_ViewPos", camera.GetPosition()); 
-        shaderCube->UploadUniformFloat1("u_Opacity", squareOpacity);
-        RenderCommands::DrawIndex(GL_TRIANGLES, VAO_Cube);
+        // bind the cube variant for features and upload the uniforms it declares
+        auto bindCubeShader = [&](unsigned int features) -> Shader& {
+            if (features & TexturedFeature) features |= materialFeatures;
+            Shader& shader = shadersCube.Get(features);
+            shader.Bind();
+            shader.UploadUniformMatrix4fv("u_ViewProjection", packet->viewProjection);
+            if (features & LitFeature) {
+                shader.UploadUniformFloat1("u_AmbientStrength", packet->ambientStrength);
+                shader.UploadUniformFloat3("u_LightColor", packet->lightColor);
+                shader.UploadUniformFloat3("u_LightPosition", packet->lightPosition);
+                shader.UploadUniformFloat3("u_ViewPos", packet->cameraPosition);
+            }
+            if ((features & TexturedFeature) && !(features & BindlessMaterialsFeature)) {
+                shader.UploadUniform1i("u_Materials", materialsCubeMapArray);
+            }
+            return shader;
+        };
 
-        //--------------------------------------------------------------------------------------------------------------
-        //
-        // processing sun (white cube)
-        //
-        //--------------------------------------------------------------------------------------------------------------
+        // instance buffer: opaque tiles, player, translucent tiles, sun
+        GLsizei opaqueCount = packet->tileCount + 1;
 
-        // translating and scaling the sun
-        cubeModel = glm::mat4(1.0f);
-        
-        cubeModel = glm::translate(cubeModel, lightPosition);
-        cubeModel = glm::scale(cubeModel, glm::vec3(0.4));
-        
-        // bind buffer, upload uniforms and draw 
-        VAO_Cube->Bind();
-        shaderSun->Bind();
-        shaderSun->UploadUniformMatrix4fv("u_Model", cubeModel* camera.GetViewProjectionMatrix());
-        shaderSun->UploadUniformMatrix4fv("u_View", camera.GetViewMatrix());
-        shaderSun->UploadUniformMatrix4fv("u_Projection", camera.GetProjectionMatrix());
-        RenderCommands::DrawIndex(GL_TRIANGLES, VAO_Cube); 
+        // opaque tiles, the player and the sun
+        {
+            PROFILE_ZONE("tiles");
+            cubeArena->Bind();
+            bindCubeShader(LitFeature | packet->textureFeature);
+            // goals and pillars, then the boxes; both meshes are in the cube arena
+            RenderCommands::DrawMeshInstanced(GL_TRIANGLES, *cubeArena, cubeMesh, packet->boxStart);
+            if (packet->tileCount > packet->boxStart) {
+                RenderCommands::DrawMeshInstanced(GL_TRIANGLES, *cubeArena, crateMesh, packet->tileCount - packet->boxStart, packet->boxStart);
+            }
+        }
+        {
+            PROFILE_ZONE("player");
+            RenderCommands::DrawMeshInstanced(GL_TRIANGLES, *cubeArena, cubeMesh, 1, packet->tileCount);
+        }
+        {
+            PROFILE_ZONE("sun");
+            bindCubeShader(0);
+            RenderCommands::DrawMeshInstanced(GL_TRIANGLES, *cubeArena, cubeMesh, 1, opaqueCount + packet->translucentCount);
+        }
 
-        //--------------------------------------------------------------------------------------------------------------
-        //
-        // check win condition
-        //
-        //--------------------------------------------------------------------------------------------------------------
-        int correctBoxCounter = 0;
-        for (TileInfo tile : GridState) {
-            if (tile.hasBox && tile.hasBoxDest) correctBoxCounter++;
-            if (correctBoxCounter == 6 && !isGameWon) 
-            {
-                std::cout << "Won Game with " << moveCounter << " moves!" << std::endl;
-                isGameWon = true;
+        // semi-transparent walls last, blended over everything else. They are depth tested against
+        // the opaque scene but do not write depth, so walls behind other walls are not discarded.
+        if (packet->translucentCount > 0) {
+            PROFILE_ZONE("walls");
+            if (packet->weightedOIT && weightedBlendedOIT.Begin()) {
+                bindCubeShader(LitFeature | BlendedFeature | WeightedOITFeature | packet->textureFeature);
+                RenderCommands::DrawMeshInstanced(GL_TRIANGLES, *cubeArena, cubeMesh, packet->translucentCount, opaqueCount);
+                weightedBlendedOIT.Composite(*shaderOITComposite);
+            }
+            else {
+                if (packet->weightedOIT) state.weightedOITAvailable.store(false);
+                // sorted back to front by the main thread
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDepthMask(GL_FALSE);
+                bindCubeShader(LitFeature | BlendedFeature | packet->textureFeature);
+                RenderCommands::DrawMeshInstanced(GL_TRIANGLES, *cubeArena, cubeMesh, packet->translucentCount, opaqueCount);
+                glDepthMask(GL_TRUE);
+            }
+        }
+
+        // scale the scene to the output, through the FXAA pass or a blit of the (resolved) color
+        if (!sceneTargetFailed) {
+            PROFILE_ZONE("present");
+            sceneTarget.Resolve(renderWidth, renderHeight);
+            if (antiAliasing == AntiAliasing::FXAA) {
+                glBindFramebuffer(GL_FRAMEBUFFER, renderTarget);
+                glViewport(0, 0, outputWidth, outputHeight);
+                glDisable(GL_DEPTH_TEST);
+                glDisable(GL_BLEND);
+                glActiveTexture(GL_TEXTURE0 + sceneColorUnit);
+                glBindTexture(GL_TEXTURE_2D, sceneTarget.GetColorTexture());
+                RenderStatistics::CountTextureBind();
+                shaderFXAA->Bind();
+                shaderFXAA->UploadUniform1i("u_Color", sceneColorUnit);
+                shaderFXAA->UploadUniformFloat2("u_TexelSize", glm::vec2(1.0f / sceneTarget.GetWidth(), 1.0f / sceneTarget.GetHeight()));
+                shaderFXAA->UploadUniformFloat2("u_UVScale", glm::vec2(static_cast<float>(renderWidth) / sceneTarget.GetWidth(),
+                                                                        static_cast<float>(renderHeight) / sceneTarget.GetHeight()));
+                RenderCommands::DrawArrays(GL_TRIANGLES, fullscreenArray, 3);
+                glEnable(GL_DEPTH_TEST);
+            }
+            else {
+                sceneTarget.BlitColor(renderWidth, renderHeight, renderTarget, outputWidth, outputHeight);
+            }
+            // the output stays bound, e.g. for ReadPixels of the headless backend
+            glBindFramebuffer(GL_FRAMEBUFFER, renderTarget);
+        }
+        dynamicResolution.EndFrame();
+
+        if (packet->recordingPath != activeRecording) {
+            frameCapture.StopRecording();
+            activeRecording = packet->recordingPath;
+            activeRecordingStopped = false;
+            if (!activeRecording.empty() && !frameCapture.StartRecording(activeRecording, 60)) {
+                reportStoppedRecording();
             }
         }
+        if (!packet->screenshotPath.empty()) {
+            frameCapture.RequestScreenshot(packet->screenshotPath);
+        }
+        {
+            PROFILE_ZONE("capture");
+            frameCapture.Capture(renderTarget, outputWidth, outputHeight);
+        }
+        if (!activeRecording.empty() && !activeRecordingStopped && !frameCapture.IsRecording()) {
+            reportStoppedRecording();
+        }
 
         // Swap front and back buffers
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            PROFILE_ZONE("swap");
+            glfwSwapBuffers(window);
+        }
+        if (benchmark) {
+            // the offscreen target of the headless backend is not presented, wait for the GPU instead
+            if (IsHeadless()) {
+                glFinish();
+            }
+            state.presentTimes.push_back(std::chrono::steady_clock::now());
+        }
+        PROFILE_END_FRAME();
+        RenderStatistics::EndFrame();
+
+        framePackets.Release();
     }
 
-    return stop();
+    frameCapture.Finish();
+
+    // the offscreen target of the headless backend still holds the last frame (a window back buffer is undefined after the swap)
+    if (!capturePath.empty()) {
+        std::vector<unsigned char> pixels;
+        if (!ReadPixels(pixels) || !SoftwareFramebuffer::WritePPM(capturePath, lastOutputWidth, lastOutputHeight, pixels.data())) {
+            std::cerr << "Failed to capture the last frame to " << capturePath << std::endl;
+        }
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+
+void HomeExamApplication::renderFramesSoftware(FramePacketQueue<FramePacket>& framePackets, RenderThreadState& state) {
+    SoftwareFramebuffer framebuffer(state.framebufferWidth, state.framebufferHeight);
+    SoftwareRenderer renderer(framebuffer);
+
+    // the CPU reads the float vertex formats directly, no quantization
+    std::vector<GeometricTools::GridVertexPCT> gridVertices(GeometricTools::GridVertexCount(numberOfSquare));
+    std::vector<uint32_t> gridIndices(GeometricTools::GridIndexCount(numberOfSquare));
+    if (!GeometricTools::GenerateGridVertices(numberOfSquare, gridVertices.data(), gridVertices.size())
+        || !GeometricTools::GenerateGridTopology(numberOfSquare, gridIndices.data(), gridIndices.size())) {
+        state.ready.set_value(false);
+        return;
+    }
+    SoftwareVertexArray gridArray;
+    gridArray.SetVertexBuffer(gridVertices.data(), sizeof(GeometricTools::GridVertexPCT), gridVertices.size());
+    gridArray.SetIndexBuffer(gridIndices.data(), gridIndices.size());
+
+    auto cubeVertices = unitCubeGeometry();
+    SoftwareVertexArray cubeArray;
+    cubeArray.SetVertexBuffer(cubeVertices.data(), 6 * sizeof(float), cubeVertices.size() / 6);
+    cubeArray.SetIndexBuffer(GeometricTools::CubeTopology.data(), GeometricTools::CubeTopology.size());
+    static_assert(offsetof(CubeInstance, color) == 6 * sizeof(float), "SoftwareCubeShader reads the color from float 6 of an instance");
+
+    // the untextured variants of shaders/grid.h and shaders/cube.h
+    SoftwareGridShader shaderGrid;
+    SoftwareCubeShader shaderCube(true, false);
+    SoftwareCubeShader shaderCubeBlended(true, true);
+    SoftwareCubeShader shaderSun(false, false);
+
+    // no OIT targets on the CPU, the walls are always sorted back to front
+    state.weightedOITAvailable.store(false);
+    state.renderStart = std::chrono::steady_clock::now();
+    state.ready.set_value(true);
+
+    while (FramePacket* packet = framePackets.Acquire()) {
+        PROFILE_CPU_ZONE("render frame");
+
+        // frames are only captured on the GL backend
+        if (!packet->recordingPath.empty()) {
+            std::lock_guard<std::mutex> lock(state.recordingMutex);
+            if (state.stoppedRecording.empty()) {
+                std::cerr << "The software renderer cannot record video" << std::endl;
+            }
+            state.stoppedRecording = packet->recordingPath;
+        }
+
+        renderer.SetClearColor(0.663f, 0.663f, 0.663f, 1.0f); // grey background
+        renderer.Clear();
+        renderer.SetBlending(false);
+
+        auto uploadLighting = [&](SoftwareShader& shader) {
+            shader.UploadUniformFloat1("u_AmbientStrength", packet->ambientStrength);
+            shader.UploadUniformFloat3("u_LightColor", packet->lightColor);
+            shader.UploadUniformFloat3("u_LightPosition", packet->lightPosition);
+            shader.UploadUniformFloat3("u_ViewPos", packet->cameraPosition);
+        };
+
+        {
+            PROFILE_CPU_ZONE("grid");
+            shaderGrid.UploadUniformMatrix4fv("u_Model", packet->gridModel);
+            shaderGrid.UploadUniformMatrix4fv("u_MVP", packet->gridMVP);
+            uploadLighting(shaderGrid);
+            renderer.DrawIndex(gridArray, shaderGrid);
+        }
+
+        cubeArray.SetInstanceBuffer(packet->instances.data(), sizeof(CubeInstance), packet->instances.size());
+        for (SoftwareCubeShader* shader : { &shaderCube, &shaderCubeBlended, &shaderSun }) {
+            shader->UploadUniformMatrix4fv("u_ViewProjection", packet->viewProjection);
+            uploadLighting(*shader);
+        }
+
+        // instance buffer: opaque tiles, player, translucent tiles, sun
+        size_t opaqueCount = static_cast<size_t>(packet->tileCount) + 1;
+        {
+            PROFILE_CPU_ZONE("tiles");
+            renderer.DrawIndexInstanced(cubeArray, shaderCube, opaqueCount);
+        }
+        {
+            PROFILE_CPU_ZONE("sun");
+            renderer.DrawIndexInstanced(cubeArray, shaderSun, 1, opaqueCount + packet->translucentCount);
+        }
+        if (packet->translucentCount > 0) {
+            PROFILE_CPU_ZONE("walls");
+            renderer.SetBlending(true);
+            renderer.SetDepthWrite(false);
+            renderer.DrawIndexInstanced(cubeArray, shaderCubeBlended, packet->translucentCount, opaqueCount);
+            renderer.SetDepthWrite(true);
+        }
+        if (benchmark) {
+            state.presentTimes.push_back(std::chrono::steady_clock::now());
+        }
+        PROFILE_END_FRAME();
+
+        framePackets.Release();
+    }
+
+    if (!capturePath.empty()) {
+        framebuffer.WritePPM(capturePath);
+    }
 }
 
 unsigned HomeExamApplication::stop() {
@@ -751,6 +1383,17 @@ HomeExamApplication* HomeExamApplication::getHomeExamApplication() {
     return HomeExamApplication::current_application;
 }
 
+bool HomeExamApplication::setBenchmark(const std::string& scriptPath, const std::string& reportPath) {
+    auto script = std::make_unique<BenchmarkScript>();
+    if (!BenchmarkScript::Load(scriptPath, *script)) {
+        return false;
+    }
+    randomSeed = script->seed;
+    benchmark = std::move(script);
+    benchmarkReportPath = reportPath;
+    return true;
+}
+
 void HomeExamApplication::exit() {
     glfwSetWindowShouldClose(window, GLFW_TRUE);
 }
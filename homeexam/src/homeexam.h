@@ -6,10 +6,16 @@
 #include <unordered_map>
 #include <array>
 #include <memory>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <mutex>
 #include "GLFWApplication.h"
 #include "VertextArray.h"
 #include "Shader.h"
+#include "Framebuffer.h"
 #include "PerspectiveCamera.h"
+#include "scenestore.h"
 #include <glm/glm.hpp>
 
 enum Direction {
@@ -19,6 +25,9 @@ enum Direction {
     RIGHT
 };
 
+struct BenchmarkScript;
+template<typename Packet> class FramePacketQueue;
+
 class HomeExamApplication : public GLFWApplication {
 private:
     struct TileInfo {
@@ -29,8 +38,76 @@ private:
         bool hasBox;
         bool hasBoxDest;
         bool isBoxFinished;
+        SceneStore::Handle box; // scene object of the box standing on the tile
     };
     std::vector<TileInfo> GridState; 
+
+    // layers of the material cube map array
+    enum Material {
+        BlackMarmorMaterial = 0,
+        WoodMaterial = 1,
+        RuneMaterial = 2
+    };
+    // per-instance data of the batched cube draw
+    struct CubeInstance {
+        glm::vec3 translation;
+        glm::vec3 scale;
+        glm::vec4 color; // rgb + opacity
+        GLint material;
+
+        // a_Translation, a_Scale, a_Color and a_Material of VS_Cube (see StaticBufferLayout.h)
+        static constexpr auto Layout() {
+            return std::array{
+                VERTEX_ATTRIBUTE(CubeInstance, translation, ShaderDataType::Float3, false),
+                VERTEX_ATTRIBUTE(CubeInstance, scale, ShaderDataType::Float3, false),
+                VERTEX_ATTRIBUTE(CubeInstance, color, ShaderDataType::Float4, false),
+                VERTEX_ATTRIBUTE(CubeInstance, material, ShaderDataType::Int, false)
+            };
+        }
+    };
+    // Everything the render thread needs to draw one frame, recorded by the main thread.
+    struct FramePacket {
+        glm::mat4 viewProjection;
+        glm::mat4 gridModel;
+        glm::mat4 gridMVP;
+        glm::vec3 cameraPosition;
+        glm::vec3 lightPosition;
+        glm::vec3 lightColor;
+        float ambientStrength;
+        unsigned int textureFeature;
+        // instance buffer: opaque tiles, player, translucent tiles, sun
+        std::vector<CubeInstance> instances;
+        GLsizei boxStart; // the boxes are the last opaque tiles
+        GLsizei tileCount;
+        GLsizei translucentCount; // sorted back to front unless weightedOIT is set
+        bool weightedOIT;
+        // framebuffer size of the window, read on the main thread (GLFW window queries are main thread only)
+        int framebufferWidth;
+        int framebufferHeight;
+        std::string screenshotPath; // PNG of this frame, empty if none was requested
+        std::string recordingPath;  // Y4M recording this frame belongs to, empty while not recording
+    };
+    // shared between the main thread and the render thread
+    struct RenderThreadState {
+        // cleared by the render thread if the OIT targets cannot be created, the walls are sorted again then
+        std::atomic<bool> weightedOITAvailable{ false };
+        std::atomic<size_t> pendingTextures{ 0 };
+        // set once the meshes, shaders and textures exist; false if they could not be created, the
+        // render thread has returned then
+        std::promise<bool> ready;
+        // framebuffer size when the render thread starts (read on the main thread), for the software framebuffer
+        int framebufferWidth = 0;
+        int framebufferHeight = 0;
+        // benchmarks: time spent before ready waiting for the textures to finish loading (written before ready is set)
+        double textureWaitMs = 0.0;
+        // benchmarks: when the render thread was ready and when it presented each frame (read once it joined)
+        std::chrono::steady_clock::time_point renderStart;
+        std::vector<std::chrono::steady_clock::time_point> presentTimes;
+        // recording the render thread ended by itself (the file could not be created or the frame
+        // size changed), the main thread stops asking for it
+        std::mutex recordingMutex;
+        std::string stoppedRecording;
+    };
     glm::vec3 boxColor = glm::vec3(181.0f /255.0f, 101.0f /255.0f, 29.0f /255.0f); // light brown
     glm::vec3 boxCorrectPosColor = glm::vec3(1.0f, 1.0f, 0.0f); // yellow
     glm::vec3 boxDestColor = glm::vec3(0.0f, 1.0f, 0.0f); // green
@@ -39,7 +116,19 @@ private:
     glm::vec3 pillarCollor = glm::vec3(54.0f / 255.0f, 34.0f / 255.0f, 50.0f / 255.0f);
     glm::vec3 playerColor = glm::vec3(0.0f, 0.0f, 1.0f);
     
+    // renderable objects of the warehouse by archetype, kept up to date by setupWarehouse() and move()
+    SceneStore scene;
+    SceneStore::Handle playerObject;
+    SceneStore::Handle lightObject;
+    // scale, color, material and height shared by all objects of an archetype (translation.z is the height)
+    std::array<CubeInstance, SceneStore::ArchetypeCount> archetypeInstances;
+    unsigned int numberOfBoxes = 0;
+
     void setupWarehouse(int numOfPillars = 6, int numOfBoxes = 6, int numOfBoxDest = 6);
+    // center of the tile (x, y) at height z
+    glm::vec3 tileTranslation(unsigned int x, unsigned int y, float z) const;
+    // move the box on fromTile to toTile, in GridState and in the scene
+    void pushBox(int fromTile, int toTile);
     int findTile(glm::vec2 checkingPos, std::vector<TileInfo> tileGrid);
 
     unsigned int currentXSelected; // Current x position of the selector
@@ -48,10 +137,35 @@ private:
 
     PerspectiveCamera camera; //The perspective camera used
 
-    float toggleTexture; // toggle functionality to activate/deactivate textures and blending
+    unsigned int textureFeature; // TexturedFeature or 0: the T key switches between the textured and untextured shader variants
 
     const unsigned int numberOfSquare = 10; // The number of square on the grid
 
+    unsigned int randomSeed; // seed of the warehouse layout
+
+    // benchmark mode: the script replaces key_callback, see benchmark.h
+    std::unique_ptr<BenchmarkScript> benchmark;
+    std::string benchmarkReportPath;
+    std::chrono::steady_clock::time_point startTime; // for the start-up time of the benchmark report
+
+    // render-on-demand: only draw when something changed (see setRenderOnDemand)
+    bool renderOnDemand = false;
+    bool sceneDirty = true; // input, board or texture changes since the last drawn frame
+    float sunUpdateRate = 60.0f; // sun position updates per second, 0 stops the orbit
+
+    bool weightedOIT = false; // translucent walls: weighted blended OIT instead of the depth sorted pass
+    bool occlusionCulling = true; // skip goals, boxes and pillars hidden behind walls and pillars
+
+    AntiAliasing antiAliasing = AntiAliasing::MSAA; // of the scene target (see setAntiAliasing)
+    int msaaSamples = 4;
+    float frameTimeTarget = 0.0f; // GPU milliseconds per frame, 0 renders at the full size (see setDynamicResolution)
+    float minResolutionScale = 0.5f;
+
+    std::string capturePath; // the last frame is written here as a PPM (see setCapture)
+    std::string screenshotPath; // requested with F12, passed on with the next frame packet
+    std::string recordingPath; // Y4M file while recording (F9 or setRecording), empty otherwise
+    unsigned int captureNumber = 0; // numbers the screenshot and recording file names
+
     static HomeExamApplication* current_application; // The current_application used for the communication with the key_callback
 
     /**
@@ -62,6 +176,11 @@ private:
     // function to toggle texture State
     void setTextureState();
 
+    // render thread: create the resources, then draw the frame packets until the queue is closed
+    void renderFramesGL(FramePacketQueue<FramePacket>& framePackets, RenderThreadState& state);
+    // the same frames drawn by the CPU renderer of SoftwareRendering (untextured)
+    void renderFramesSoftware(FramePacketQueue<FramePacket>& framePackets, RenderThreadState& state);
+
 public:
     explicit HomeExamApplication(const std::string& name = "homeexam", const std::string& version = "0.0.1",
         unsigned int width = 1024, unsigned int height = 1024);
@@ -71,6 +190,61 @@ public:
     unsigned Run() override;
     unsigned stop() override;
 
+    /**
+     * Run the benchmark script instead of reading the keyboard: vsync is disabled,
+     * the script's frames are rendered and the frame time statistics are written to reportPath.
+     * @return false if the script could not be loaded
+     */
+    bool setBenchmark(const std::string& scriptPath, const std::string& reportPath);
+
+    /**
+     * Block in glfwWaitEventsTimeout and only render when input arrives, the board or
+     * a texture changes or the sun is due to move, instead of redrawing at full rate.
+     */
+    void setRenderOnDemand(bool enabled) { renderOnDemand = enabled; }
+
+    /**
+     * How often the sun moves along its orbit (updates per second, 0 stops it).
+     */
+    void setSunUpdateRate(float updatesPerSecond) { sunUpdateRate = updatesPerSecond; }
+
+    /**
+     * Draw the translucent walls with weighted blended order-independent transparency
+     * instead of sorting them back to front (falls back to sorting if the targets are unavailable).
+     */
+    void setWeightedBlendedOIT(bool enabled) { weightedOIT = enabled; }
+
+    /**
+     * Test goals, boxes and pillars against a CPU depth buffer of the walls and pillars
+     * and leave hidden ones out of the frame (on by default).
+     */
+    void setOcclusionCulling(bool enabled) { occlusionCulling = enabled; }
+
+    /**
+     * How the scene target is anti-aliased: multisampled with the given sample count (the default,
+     * 4 samples), single sampled and filtered by FXAA when it is presented, or not at all.
+     */
+    void setAntiAliasing(AntiAliasing mode, int samples = 4) { antiAliasing = mode; msaaSamples = samples; }
+
+    /**
+     * Lower the render size (down to minScale of the output per axis) while the GPU time per frame
+     * exceeds targetMilliseconds, and upscale the scene to the output; 0 keeps the full size.
+     */
+    void setDynamicResolution(float targetMilliseconds, float minScale = 0.5f) { frameTimeTarget = targetMilliseconds; minResolutionScale = minScale; }
+
+    /**
+     * Write the last rendered frame to filePath (binary PPM) when Run() ends, e.g. to compare
+     * the software backend against the headless GL backend pixel by pixel.
+     */
+    void setCapture(const std::string& filePath) { capturePath = filePath; }
+
+    /**
+     * Record every rendered frame to filePath as raw Y4M video from the start (F9 stops and
+     * starts recordings while running). The frames are read back asynchronously and encoded on
+     * a background thread, see FrameCapture; the software backend does not record.
+     */
+    void setRecording(const std::string& filePath) { recordingPath = filePath; }
+
     /**
      * Move the selection square in a specific direction
      * @param direction The direction to move the selection square
@@ -81,6 +255,10 @@ public:
      * Function called when the player press any key on the keyboard
      */
     static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    /**
+     * Function called when the window content has to be redrawn (e.g. after being uncovered)
+     */
+    static void refresh_callback(GLFWwindow* window);
     /**
      * Function called when the key callback want to use a function of the current_application
      * @return current_application
@@ -101,6 +279,16 @@ public:
      */
     void rotate(float degree);
 
+    /**
+     * Function called by the key_callback to save the next frame as screenshot_<n>.png
+     */
+    void takeScreenshot();
+
+    /**
+     * Function called by the key_callback to start recording to recording_<n>.y4m, or to stop recording
+     */
+    void toggleRecording();
+
     /**
      * Function called by the key_callback when the player want to exit the application
      */
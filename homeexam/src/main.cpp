@@ -1,13 +1,91 @@
-
 #include "homeexam.h"
+#include "RenderStats.h"
+
+#include <cstdlib>
+#include <cstring>
 
 int main(int argc, char* argv[])
 {
     HomeExamApplication application("HomeExam", "1.0");
 
-    application.Init();
+    // --stats <frames>: print the GL call counters every <frames> frames
+    for (int arg = 1; arg + 1 < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--stats") == 0) {
+            RenderStatistics::SetLogInterval(static_cast<unsigned int>(std::strtoul(argv[arg + 1], nullptr, 10)));
+        }
+    }
+
+    // --on-demand: only redraw on input/changes; --sun-rate <updates per second> (0 stops the sun);
+    // --oit: weighted blended order-independent transparency for the walls;
+    // --no-occlusion: draw goals, boxes and pillars even when walls or pillars hide them
+    for (int arg = 1; arg < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--on-demand") == 0) application.setRenderOnDemand(true);
+        if (std::strcmp(argv[arg], "--oit") == 0) application.setWeightedBlendedOIT(true);
+        if (std::strcmp(argv[arg], "--no-occlusion") == 0) application.setOcclusionCulling(false);
+        if (std::strcmp(argv[arg], "--sun-rate") == 0 && arg + 1 < argc) {
+            application.setSunUpdateRate(std::strtof(argv[arg + 1], nullptr));
+        }
+    }
+
+    // render offscreen (OSMesa/EGL) when started with --headless or HOMEEXAM_HEADLESS=1,
+    // e.g. on display-less benchmark and CI machines
+    bool headless = std::getenv("HOMEEXAM_HEADLESS") && std::strcmp(std::getenv("HOMEEXAM_HEADLESS"), "0") != 0;
+    for (int arg = 1; arg < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--headless") == 0) headless = true;
+    }
+    if (headless) {
+        application.SetContextBackend(ContextBackend::Headless);
+        // single sampled like the software backend, so captures can be compared pixel by pixel
+        application.setAntiAliasing(AntiAliasing::Off);
+    }
+
+    // --aa off|msaa|fxaa: anti-aliasing of the scene target; --msaa <samples>: samples of the msaa mode;
+    // --target-ms <milliseconds>: dynamic resolution for this GPU time per frame, down to --min-scale <scale>
+    float frameTimeTarget = 0.0f;
+    float minResolutionScale = 0.5f;
+    for (int arg = 1; arg + 1 < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--aa") == 0) {
+            if (std::strcmp(argv[arg + 1], "off") == 0) application.setAntiAliasing(AntiAliasing::Off);
+            if (std::strcmp(argv[arg + 1], "msaa") == 0) application.setAntiAliasing(AntiAliasing::MSAA);
+            if (std::strcmp(argv[arg + 1], "fxaa") == 0) application.setAntiAliasing(AntiAliasing::FXAA);
+        }
+    }
+    for (int arg = 1; arg + 1 < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--msaa") == 0) {
+            application.setAntiAliasing(AntiAliasing::MSAA, std::atoi(argv[arg + 1]));
+        }
+        if (std::strcmp(argv[arg], "--target-ms") == 0) frameTimeTarget = std::strtof(argv[arg + 1], nullptr);
+        if (std::strcmp(argv[arg], "--min-scale") == 0) minResolutionScale = std::strtof(argv[arg + 1], nullptr);
+    }
+    application.setDynamicResolution(frameTimeTarget, minResolutionScale);
+
+    // --software: draw on the CPU without any GL context (untextured), e.g. on machines without a GPU;
+    // --capture <file.ppm>: write the last frame, to compare the backends pixel by pixel;
+    // --record <file.y4m>: record the session as raw video (F9 toggles recording, F12 saves a PNG screenshot)
+    for (int arg = 1; arg < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--software") == 0) application.SetContextBackend(ContextBackend::Software);
+        if (std::strcmp(argv[arg], "--capture") == 0 && arg + 1 < argc) application.setCapture(argv[arg + 1]);
+        if (std::strcmp(argv[arg], "--record") == 0 && arg + 1 < argc) application.setRecording(argv[arg + 1]);
+    }
+
+    // --benchmark <script> [--report <file>]: scripted run that writes frame time statistics
+    const char* benchmarkScript = nullptr;
+    const char* benchmarkReport = "benchmark.json";
+    for (int arg = 1; arg + 1 < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--benchmark") == 0) benchmarkScript = argv[arg + 1];
+        if (std::strcmp(argv[arg], "--report") == 0) benchmarkReport = argv[arg + 1];
+    }
+    if (benchmarkScript && !application.setBenchmark(benchmarkScript, benchmarkReport)) {
+        return EXIT_FAILURE;
+    }
+
+    if (application.Init() != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
 
-    application.Run();
+    if (application.Run() != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
 
     application.stop();
 }
@@ -0,0 +1,104 @@
+#include "scenestore.h"
+
+SceneStore::Handle SceneStore::Create(Archetype archetype, const glm::vec3& translation)
+{
+    uint32_t slot;
+    if (!this->FreeSlots.empty()) {
+        slot = this->FreeSlots.back();
+        this->FreeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<uint32_t>(this->SlotTable.size());
+        this->SlotTable.push_back({ archetype, 0, 0 });
+    }
+
+    Slot& entry = this->SlotTable[slot];
+    entry.archetype = archetype;
+    entry.index = Append(archetype, slot, translation);
+    return { slot, entry.generation };
+}
+
+void SceneStore::Destroy(Handle handle)
+{
+    if (!IsValid(handle)) {
+        return;
+    }
+    Slot& entry = this->SlotTable[handle.slot];
+    Remove(entry.archetype, entry.index);
+    entry.generation++; // outstanding handles to this slot become invalid
+    this->FreeSlots.push_back(handle.slot);
+}
+
+bool SceneStore::IsValid(Handle handle) const
+{
+    return handle.slot < this->SlotTable.size() && this->SlotTable[handle.slot].generation == handle.generation;
+}
+
+void SceneStore::SetArchetype(Handle handle, Archetype archetype)
+{
+    Slot& entry = this->SlotTable[handle.slot];
+    if (entry.archetype == archetype) {
+        return;
+    }
+    glm::vec3 translation = GetTranslation(handle);
+    Remove(entry.archetype, entry.index);
+    entry.archetype = archetype;
+    entry.index = Append(archetype, handle.slot, translation);
+}
+
+void SceneStore::SetTranslation(Handle handle, const glm::vec3& translation)
+{
+    const Slot& entry = this->SlotTable[handle.slot];
+    Columns& columns = this->Archetypes[entry.archetype];
+    columns.TranslationX[entry.index] = translation.x;
+    columns.TranslationY[entry.index] = translation.y;
+    columns.TranslationZ[entry.index] = translation.z;
+}
+
+glm::vec3 SceneStore::GetTranslation(Handle handle) const
+{
+    const Slot& entry = this->SlotTable[handle.slot];
+    const Columns& columns = this->Archetypes[entry.archetype];
+    return glm::vec3(columns.TranslationX[entry.index], columns.TranslationY[entry.index], columns.TranslationZ[entry.index]);
+}
+
+void SceneStore::Clear()
+{
+    for (Columns& columns : this->Archetypes) {
+        columns = Columns();
+    }
+    // keep the generations, so handles from before the clear stay invalid
+    this->FreeSlots.clear();
+    for (uint32_t slot = 0; slot < this->SlotTable.size(); ++slot) {
+        this->SlotTable[slot].generation++;
+        this->FreeSlots.push_back(slot);
+    }
+}
+
+uint32_t SceneStore::Append(Archetype archetype, uint32_t slot, const glm::vec3& translation)
+{
+    Columns& columns = this->Archetypes[archetype];
+    columns.TranslationX.push_back(translation.x);
+    columns.TranslationY.push_back(translation.y);
+    columns.TranslationZ.push_back(translation.z);
+    columns.Slots.push_back(slot);
+    return static_cast<uint32_t>(columns.Slots.size() - 1);
+}
+
+void SceneStore::Remove(Archetype archetype, uint32_t index)
+{
+    // move the last object into the gap and point its slot at the new index
+    Columns& columns = this->Archetypes[archetype];
+    uint32_t last = static_cast<uint32_t>(columns.Slots.size() - 1);
+    if (index != last) {
+        columns.TranslationX[index] = columns.TranslationX[last];
+        columns.TranslationY[index] = columns.TranslationY[last];
+        columns.TranslationZ[index] = columns.TranslationZ[last];
+        columns.Slots[index] = columns.Slots[last];
+        this->SlotTable[columns.Slots[index]].index = index;
+    }
+    columns.TranslationX.pop_back();
+    columns.TranslationY.pop_back();
+    columns.TranslationZ.pop_back();
+    columns.Slots.pop_back();
+}
@@ -0,0 +1,77 @@
+#ifndef HOMEEXAM_SCENESTORE_H
+#define HOMEEXAM_SCENESTORE_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Renderable objects of the warehouse, grouped by archetype. Each archetype keeps the
+ * translations of its objects in dense structure-of-arrays columns, so render and update
+ * passes walk one archetype at a time without testing what an object is.
+ *
+ * Handles stay valid while objects are removed or change archetype: they point into a
+ * slot table, and the slot is patched whenever its object is moved by a swap-remove.
+ */
+class SceneStore
+{
+public:
+    enum Archetype : uint8_t {
+        Wall,
+        Pillar,
+        Box,
+        Goal,
+        BoxOnGoal,
+        Player,
+        Light,
+        ArchetypeCount
+    };
+
+    struct Handle {
+        uint32_t slot = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    // dense per-archetype storage; Slots[i] is the slot of the object stored at index i
+    struct Columns {
+        std::vector<float> TranslationX, TranslationY, TranslationZ;
+        std::vector<uint32_t> Slots;
+
+        size_t Size() const { return this->Slots.size(); }
+    };
+
+    Handle Create(Archetype archetype, const glm::vec3& translation);
+    // swap-removes the object; other handles stay valid
+    void Destroy(Handle handle);
+    bool IsValid(Handle handle) const;
+
+    // move the object to another archetype (e.g. a box pushed onto a goal), keeping its handle
+    void SetArchetype(Handle handle, Archetype archetype);
+    Archetype GetArchetype(Handle handle) const { return this->SlotTable[handle.slot].archetype; }
+
+    void SetTranslation(Handle handle, const glm::vec3& translation);
+    glm::vec3 GetTranslation(Handle handle) const;
+
+    const Columns& Get(Archetype archetype) const { return this->Archetypes[archetype]; }
+    size_t Count(Archetype archetype) const { return this->Archetypes[archetype].Size(); }
+
+    void Clear();
+
+private:
+    struct Slot {
+        Archetype archetype;
+        uint32_t index; // into the archetype's columns
+        uint32_t generation;
+    };
+
+    uint32_t Append(Archetype archetype, uint32_t slot, const glm::vec3& translation);
+    void Remove(Archetype archetype, uint32_t index);
+
+    std::array<Columns, ArchetypeCount> Archetypes;
+    std::vector<Slot> SlotTable;
+    std::vector<uint32_t> FreeSlots;
+};
+
+#endif //HOMEEXAM_SCENESTORE_H
@@ -3,52 +3,77 @@
 #define HOMEEXAM_CUBE_H
 
 // Vertex and fragment shader source code
+// All cubes (tiles and player) are drawn in one instanced batch: the per-instance attributes
+// carry translation, scale, color/opacity and the material (layer of the cube map array).
 const std::string VS_Cube = R"(
     #version 430 core
     layout(location = 0) in vec3 position;
     layout(location = 1) in vec3 aNormal;
+    // per instance
+    layout(location = 2) in vec3 a_Translation;
+    layout(location = 3) in vec3 a_Scale;
+    layout(location = 4) in vec4 a_Color; // rgb + opacity
+    layout(location = 5) in int a_Material;
 
     out vec3 TexCoords;
     // for diffuse lighting
     out vec3 Normal;
     out vec3 FragPos;
+    out vec4 Color;
+    flat out int Material;
 
-    uniform mat4 u_Model;
-    uniform mat4 u_View;
-    uniform mat4 u_Projection;
+    uniform mat4 u_ViewProjection;
 
     void main()
-    {;
+    {
         TexCoords = position;
-        gl_Position = u_Projection * u_View * u_Model * vec4(position, 1.0);
+        vec3 worldPos = position * a_Scale + a_Translation;
+        gl_Position = u_ViewProjection * vec4(worldPos, 1.0);
 
-        FragPos = vec3(u_Model * vec4(position, 1.0));
+        FragPos = worldPos;
         Normal = aNormal;
+        Color = a_Color;
+        Material = a_Material;
     }
 )";
 
+// Compiled per feature set (see features.h): TEXTURED, LIT, BLENDED, BINDLESS_MATERIALS and WEIGHTED_OIT.
+// The unlit, untextured variant draws the sun. WEIGHTED_OIT variants feed the accumulation
+// targets of WeightedBlendedOIT instead of writing a color.
+// The material array is either bound to a texture unit or addressed through a bindless handle.
 const std::string FS_Cube = R"(
     #version 430 core
+#if defined(TEXTURED) && defined(BINDLESS_MATERIALS)
+    #extension GL_ARB_bindless_texture : require
+    layout(bindless_sampler) uniform samplerCubeArray u_Materials;
+#elif defined(TEXTURED)
+    uniform samplerCubeArray u_Materials;
+#endif
 
     in vec3 TexCoords;
 
     in vec3 Normal; 
     in vec3 FragPos; 
-    
-    uniform samplerCube CubeMap;
-    uniform float u_Opacity;
-    uniform float u_TextureState;
+    in vec4 Color;
+    flat in int Material;
 
-    uniform vec3 u_Color;
+#ifdef LIT
     uniform vec3 u_LightColor;
     uniform vec3 u_LightPosition;
     uniform vec3 u_ViewPos;
     uniform float u_AmbientStrength;
+#endif
 
+#ifdef WEIGHTED_OIT
+    layout(location = 0) out vec4 accum;
+    layout(location = 1) out float revealage;
+#else
     out vec4 color;
+#endif
     
     void main()
     {
+#ifdef LIT
         // ambient lighting
         vec3 ambient = u_AmbientStrength * u_LightColor;
 
@@ -65,15 +90,35 @@ const std::string FS_Cube = R"(
         float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32); // last param (of pow) definies the "shininess": the higher the shinier
         vec3 specular = specularStrength * spec * u_LightColor;
 
-        vec3 colorAfterLighting = (ambient + diffuse + specular) * u_Color;
+        vec3 colorAfterLighting = (ambient + diffuse + specular) * Color.rgb;
+#else
+        vec3 colorAfterLighting = Color.rgb;
+#endif
+
+#ifdef BLENDED
+        float opacity = Color.a;
+#else
+        float opacity = 1.0;
+#endif
+
+#ifdef TEXTURED
+        //Sample the material layer using the texture coordinates
+        vec4 texColor = texture(u_Materials, vec4(TexCoords, float(Material)));
+        vec4 result = mix(vec4(texColor.rgb, opacity), vec4(colorAfterLighting, opacity), 0.7);
+#else
+        vec4 result = vec4(colorAfterLighting, opacity);
+#endif
 
-        if(u_TextureState != 0.0f) {
-             //Sample the texture using the texture coordinates
-             vec4 texColor = texture(CubeMap, TexCoords);
-             color = mix(vec4(texColor.rgb, u_Opacity), vec4(colorAfterLighting, u_Opacity), 0.7);
-        } else {
-            color = vec4(colorAfterLighting, u_Opacity);
-        }
+#ifdef WEIGHTED_OIT
+        // alpha-cubed weight on the window depth gl_FragCoord.z from McGuire's 2015 follow-up
+        // "Implementing Weighted, Blended Order-Independent Transparency" (not one of the paper's
+        // view-depth weights, eq. 7-10): closer and more opaque surfaces dominate
+        float weight = clamp(pow(min(1.0, result.a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+        accum = vec4(result.rgb * result.a, result.a) * weight;
+        revealage = result.a;
+#else
+        color = result;
+#endif
     }
 )";
 
@@ -0,0 +1,24 @@
+#include <string>
+#include <vector>
+#ifndef HOMEEXAM_FEATURES_H
+#define HOMEEXAM_FEATURES_H
+
+// Feature bits of the grid and cube shader permutations.
+// Bit i enables the #define ShaderFeatureNames[i] in the compiled variant.
+enum ShaderFeature : unsigned int {
+    TexturedFeature = 1u << 0,          // mix in the texture / material layer
+    LitFeature = 1u << 1,               // ambient, diffuse and specular lighting
+    BlendedFeature = 1u << 2,           // keep the vertex/instance opacity (otherwise alpha = 1)
+    BindlessMaterialsFeature = 1u << 3, // address the material array through a bindless handle
+    WeightedOITFeature = 1u << 4        // write weighted blended OIT accumulation and revealage
+};
+
+const std::vector<std::string> ShaderFeatureNames = {
+    "TEXTURED",
+    "LIT",
+    "BLENDED",
+    "BINDLESS_MATERIALS",
+    "WEIGHTED_OIT"
+};
+
+#endif //HOMEEXAM_FEATURES_H
@@ -0,0 +1,71 @@
+#include <string>
+#ifndef HOMEEXAM_FXAA_H
+#define HOMEEXAM_FXAA_H
+
+// Present pass of the FXAA mode: a full-screen triangle built from gl_VertexID samples the
+// rendered part of the scene target (u_UVScale of it, see DynamicResolution), filters its
+// edges with FXAA (Lottes, 2009) and scales it to the viewport through linear filtering.
+const std::string VS_FXAA = R"(
+    #version 430 core
+
+    out vec2 v_UV;
+
+    void main()
+    {
+        vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        v_UV = position;
+        gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+const std::string FS_FXAA = R"(
+    #version 430 core
+    uniform sampler2D u_Color;
+    uniform vec2 u_TexelSize; // 1 / size of the scene target
+    uniform vec2 u_UVScale;   // rendered part of the scene target
+
+    in vec2 v_UV;
+    out vec4 color;
+
+    const float ReduceMin = 1.0 / 128.0;
+    const float ReduceMul = 1.0 / 8.0;
+    const float SpanMax = 8.0;
+
+    // samples outside the rendered part are clamped to its border texels
+    vec3 Fetch(vec2 uv)
+    {
+        return texture(u_Color, clamp(uv, 0.5 * u_TexelSize, u_UVScale - 0.5 * u_TexelSize)).rgb;
+    }
+
+    float Luma(vec3 rgb)
+    {
+        return dot(rgb, vec3(0.299, 0.587, 0.114));
+    }
+
+    void main()
+    {
+        vec2 uv = v_UV * u_UVScale;
+        vec3 rgbM = Fetch(uv);
+        float lumaNW = Luma(Fetch(uv + vec2(-1.0, -1.0) * u_TexelSize));
+        float lumaNE = Luma(Fetch(uv + vec2(1.0, -1.0) * u_TexelSize));
+        float lumaSW = Luma(Fetch(uv + vec2(-1.0, 1.0) * u_TexelSize));
+        float lumaSE = Luma(Fetch(uv + vec2(1.0, 1.0) * u_TexelSize));
+        float lumaM = Luma(rgbM);
+        float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+        float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+        // blur along the edge, perpendicular to the luma gradient
+        vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+        float directionReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * ReduceMul, ReduceMin);
+        float inverseDirectionMin = 1.0 / (min(abs(direction.x), abs(direction.y)) + directionReduce);
+        direction = clamp(direction * inverseDirectionMin, vec2(-SpanMax), vec2(SpanMax)) * u_TexelSize;
+
+        vec3 rgbA = 0.5 * (Fetch(uv + direction * (1.0 / 3.0 - 0.5)) + Fetch(uv + direction * (2.0 / 3.0 - 0.5)));
+        vec3 rgbB = rgbA * 0.5 + 0.25 * (Fetch(uv - direction * 0.5) + Fetch(uv + direction * 0.5));
+        float lumaB = Luma(rgbB);
+        // the wider blur crossed another edge: keep the narrow one
+        color = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+    }
+)";
+
+#endif //HOMEEXAM_FXAA_H
@@ -16,12 +16,11 @@ const std::string VS_Grid = R"(
     out vec3 FragPos;
 
     uniform mat4 u_Model;
-    uniform mat4 u_View;
-    uniform mat4 u_Projection;
+    uniform mat4 u_MVP; // projection * view * model, built on the CPU by the TransformSystem
 
     void main()
     {
-        gl_Position = u_Projection * u_View * u_Model * vec4(position, 1.0);
+        gl_Position = u_MVP * vec4(position, 1.0);
         fragTexCoords = texCoords;
         fragColor = color;
 
@@ -31,6 +30,7 @@ const std::string VS_Grid = R"(
     }
 )";
 
+// Compiled per feature set (see features.h): TEXTURED, LIT and BLENDED
 const std::string FS_Grid = R"(
     #version 430 core
 
@@ -40,17 +40,21 @@ const std::string FS_Grid = R"(
     in vec3 FragPos; 
     in vec3 Normal; 
 
+#ifdef TEXTURED
     uniform sampler2D u_Texture;
-    uniform float u_TextureState;
+#endif
+#ifdef LIT
     uniform vec3 u_LightColor;
     uniform vec3 u_LightPosition;
     uniform vec3 u_ViewPos;
     uniform float u_AmbientStrength;
+#endif
 
     out vec4 color;
     
     void main()
     {
+#ifdef LIT
         // ambient lighting
         vec3 ambient = u_AmbientStrength * u_LightColor;
 
@@ -68,20 +72,26 @@ const std::string FS_Grid = R"(
         vec3 specular = specularStrength * spec * u_LightColor;
 
         vec3 colorAfterLighting = (ambient + diffuse + specular) * fragColor.rgb;
-
-        if(u_TextureState != 0.0f) {
-            // Sample the texture using the texture coordinates
-            vec4 texColor = texture(u_Texture, fragTexCoords);
-
-            // Mix the color from the vertex attribute with the texture color
-            // Adjust the alpha value manually
-            vec4 mixedColor = mix(texColor, vec4(colorAfterLighting, fragColor.a), 0.7);
-
-            // Output the final color
-            color = mixedColor;
-        } else {
-            color = vec4(colorAfterLighting, fragColor.a);
-        }
+#else
+        vec3 colorAfterLighting = fragColor.rgb;
+#endif
+
+#ifdef BLENDED
+        float opacity = fragColor.a;
+#else
+        float opacity = 1.0;
+#endif
+
+#ifdef TEXTURED
+        // Sample the texture using the texture coordinates
+        vec4 texColor = texture(u_Texture, fragTexCoords);
+
+        // Mix the color from the vertex attribute with the texture color
+        // Adjust the alpha value manually
+        color = mix(texColor, vec4(colorAfterLighting, opacity), 0.7);
+#else
+        color = vec4(colorAfterLighting, opacity);
+#endif
     }
 )";
 
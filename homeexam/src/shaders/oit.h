@@ -0,0 +1,42 @@
+#include <string>
+#ifndef HOMEEXAM_OIT_H
+#define HOMEEXAM_OIT_H
+
+// Composite pass of the weighted blended OIT: a full-screen triangle built from gl_VertexID
+// resolves the accumulated translucent surfaces and is blended over the opaque image.
+const std::string VS_OITComposite = R"(
+    #version 430 core
+
+    void main()
+    {
+        vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+const std::string FS_OITComposite = R"(
+    #version 430 core
+    uniform sampler2D u_Accum;
+    uniform sampler2D u_Revealage;
+
+    out vec4 color;
+
+    void main()
+    {
+        ivec2 texel = ivec2(gl_FragCoord.xy);
+        float revealage = texelFetch(u_Revealage, texel, 0).r;
+        if (revealage == 1.0) {
+            discard; // no translucent surface covers this pixel
+        }
+
+        vec4 accum = texelFetch(u_Accum, texel, 0);
+        // guard against overflow of the half float sum
+        if (isinf(max(max(abs(accum.r), abs(accum.g)), abs(accum.b)))) {
+            accum.rgb = vec3(accum.a);
+        }
+        vec3 average = accum.rgb / max(accum.a, 1e-5);
+        color = vec4(average, 1.0 - revealage);
+    }
+)";
+
+#endif //HOMEEXAM_OIT_H
@@ -0,0 +1,107 @@
+#include "softwareshaders.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    glm::vec3 ReadVec3(const uint8_t* data, size_t floatOffset)
+    {
+        float values[3];
+        std::memcpy(values, data + floatOffset * sizeof(float), sizeof(values));
+        return glm::vec3(values[0], values[1], values[2]);
+    }
+
+    glm::vec4 ReadVec4(const uint8_t* data, size_t floatOffset)
+    {
+        float values[4];
+        std::memcpy(values, data + floatOffset * sizeof(float), sizeof(values));
+        return glm::vec4(values[0], values[1], values[2], values[3]);
+    }
+
+    void WriteVaryings(float* varyings, const glm::vec3& value)
+    {
+        varyings[0] = value.x;
+        varyings[1] = value.y;
+        varyings[2] = value.z;
+    }
+
+    void WriteVaryings(float* varyings, const glm::vec4& value)
+    {
+        varyings[0] = value.x;
+        varyings[1] = value.y;
+        varyings[2] = value.z;
+        varyings[3] = value.w;
+    }
+}
+
+glm::vec3 SoftwareLighting::Apply(const glm::vec3& normal, const glm::vec3& fragPos, const glm::vec3& color) const
+{
+    // ambient lighting
+    glm::vec3 ambient = ambientStrength * lightColor;
+
+    // diffuse lighting
+    glm::vec3 norm = glm::normalize(normal);
+    glm::vec3 lightDir = glm::normalize(lightPosition - fragPos);
+    float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+    glm::vec3 diffuse = diff * lightColor;
+
+    // specular lighting
+    float specularStrength = 0.5f;
+    glm::vec3 viewDir = glm::normalize(viewPosition - fragPos);
+    glm::vec3 reflectDir = glm::reflect(-lightDir, norm);
+    float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), 32.0f);
+    glm::vec3 specular = specularStrength * spec * lightColor;
+
+    return (ambient + diffuse + specular) * color;
+}
+
+void SoftwareGridShader::Prepare()
+{
+    this->Model = GetMatrix4("u_Model");
+    this->MVP = GetMatrix4("u_MVP");
+    this->Lighting = { GetFloat3("u_LightColor"), GetFloat3("u_LightPosition"), GetFloat3("u_ViewPos"), GetFloat1("u_AmbientStrength") };
+}
+
+glm::vec4 SoftwareGridShader::Vertex(const uint8_t* vertex, const uint8_t* /*instance*/, float* varyings) const
+{
+    glm::vec4 position(ReadVec3(vertex, 0), 1.0f);
+    WriteVaryings(varyings, glm::vec3(this->Model * position));
+    WriteVaryings(varyings + 3, ReadVec4(vertex, 3));
+    return this->MVP * position;
+}
+
+glm::vec4 SoftwareGridShader::Fragment(const float* varyings) const
+{
+    glm::vec3 fragPos(varyings[0], varyings[1], varyings[2]);
+    glm::vec3 color(varyings[3], varyings[4], varyings[5]);
+    return glm::vec4(this->Lighting.Apply(glm::vec3(0.0f, 0.0f, 1.0f), fragPos, color), 1.0f);
+}
+
+void SoftwareCubeShader::Prepare()
+{
+    this->ViewProjection = GetMatrix4("u_ViewProjection");
+    this->Lighting = { GetFloat3("u_LightColor"), GetFloat3("u_LightPosition"), GetFloat3("u_ViewPos"), GetFloat1("u_AmbientStrength") };
+}
+
+glm::vec4 SoftwareCubeShader::Vertex(const uint8_t* vertex, const uint8_t* instance, float* varyings) const
+{
+    // instance: translation (floats 0-2), scale (3-5), color (6-9), material
+    glm::vec3 worldPos = ReadVec3(vertex, 0) * ReadVec3(instance, 3) + ReadVec3(instance, 0);
+    WriteVaryings(varyings, worldPos);
+    WriteVaryings(varyings + 3, ReadVec3(vertex, 3));
+    WriteVaryings(varyings + 6, ReadVec4(instance, 6));
+    return this->ViewProjection * glm::vec4(worldPos, 1.0f);
+}
+
+glm::vec4 SoftwareCubeShader::Fragment(const float* varyings) const
+{
+    glm::vec3 color(varyings[6], varyings[7], varyings[8]);
+    if (this->Lit) {
+        glm::vec3 fragPos(varyings[0], varyings[1], varyings[2]);
+        glm::vec3 normal(varyings[3], varyings[4], varyings[5]);
+        color = this->Lighting.Apply(normal, fragPos, color);
+    }
+    return glm::vec4(color, this->Blended ? varyings[9] : 1.0f);
+}
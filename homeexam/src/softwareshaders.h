@@ -0,0 +1,54 @@
+#ifndef HOMEEXAM_SOFTWARESHADERS_H
+#define HOMEEXAM_SOFTWARESHADERS_H
+
+#include "SoftwareShader.h"
+
+#include <glm/glm.hpp>
+
+// C++ versions of the grid and cube shaders (shaders/grid.h, shaders/cube.h) for the
+// software backend. They take the same uniforms and read the float vertex formats of
+// GeometricTools; textures are not sampled on the CPU, so they match the untextured variants.
+
+// Lighting of the LIT variants: ambient, diffuse and specular (strength 0.5, shininess 32).
+struct SoftwareLighting {
+    glm::vec3 lightColor;
+    glm::vec3 lightPosition;
+    glm::vec3 viewPosition;
+    float ambientStrength;
+
+    glm::vec3 Apply(const glm::vec3& normal, const glm::vec3& fragPos, const glm::vec3& color) const;
+};
+
+// Grid vertex: position (3 floats), color (4 floats), texture coordinates (2 floats)
+class SoftwareGridShader : public SoftwareShader {
+public:
+    void Prepare() override;
+    int GetVaryingCount() const override { return 7; } // world position, color
+    glm::vec4 Vertex(const uint8_t* vertex, const uint8_t* instance, float* varyings) const override;
+    glm::vec4 Fragment(const float* varyings) const override;
+
+private:
+    glm::mat4 Model;
+    glm::mat4 MVP;
+    SoftwareLighting Lighting;
+};
+
+// Cube vertex: position (3 floats), normal (3 floats); instance: HomeExamApplication::CubeInstance.
+// lit = false is the sun, blended = true keeps the opacity of the instance color.
+class SoftwareCubeShader : public SoftwareShader {
+public:
+    SoftwareCubeShader(bool lit, bool blended) : Lit(lit), Blended(blended) {}
+
+    void Prepare() override;
+    int GetVaryingCount() const override { return 10; } // world position, normal, color
+    glm::vec4 Vertex(const uint8_t* vertex, const uint8_t* instance, float* varyings) const override;
+    glm::vec4 Fragment(const float* varyings) const override;
+
+private:
+    bool Lit;
+    bool Blended;
+    glm::mat4 ViewProjection;
+    SoftwareLighting Lighting;
+};
+
+#endif //HOMEEXAM_SOFTWARESHADERS_H
@@ -0,0 +1,94 @@
+// Checks the radix sort of the translucent walls against std::stable_sort on the same depths:
+// back to front order, equal depths in the order they were given (including -0 and +0),
+// negative depths, depths that only differ in one radix digit and a sorter reused across sizes.
+#include "DepthSort.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void Check(bool condition, const std::string& description)
+    {
+        if (!condition) {
+            std::cerr << "FAILED: " << description << std::endl;
+            failures++;
+        }
+    }
+
+    // deterministic values in [0, range)
+    uint32_t Random(uint32_t& state, uint32_t range)
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+
+    std::vector<uint32_t> Expected(const std::vector<float>& depths)
+    {
+        std::vector<uint32_t> order(depths.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return depths[a] > depths[b]; });
+        return order;
+    }
+
+    void TestDepths(DepthSorter& sorter, const std::vector<float>& depths, const std::string& name)
+    {
+        const std::vector<uint32_t>& order = sorter.SortBackToFront(depths.data(), depths.size());
+        Check(order == Expected(depths), name + ": the order matches std::stable_sort");
+    }
+}
+
+int main()
+{
+    DepthSorter sorter;
+
+    TestDepths(sorter, {}, "no walls");
+    TestDepths(sorter, { 2.5f }, "one wall");
+    TestDepths(sorter, { 1.0f, 3.0f, 2.0f, -4.0f, 0.5f, -0.25f }, "a few walls");
+    TestDepths(sorter, { 0.0f, -0.0f, 1.0f, -0.0f, 0.0f, -1.0f, -0.0f }, "-0 and +0 tie");
+    TestDepths(sorter, { 7.0f, 7.0f, 7.0f, 7.0f }, "all walls at the same depth");
+    TestDepths(sorter, { -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::max(),
+                         std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::denorm_min(),
+                         std::numeric_limits<float>::lowest(), std::numeric_limits<float>::infinity() },
+               "extreme depths");
+
+    // few distinct depths between -8 and 8 in steps of 1/4: many ties, both signs and both zeros
+    uint32_t state = 1;
+    std::vector<float> ties(5000);
+    for (float& depth : ties) {
+        depth = (static_cast<float>(Random(state, 65)) - 32.0f) * 0.25f;
+        if (depth == 0.0f && Random(state, 2) == 0) {
+            depth = -0.0f;
+        }
+    }
+    TestDepths(sorter, ties, "5000 walls with ties");
+
+    // neighbouring floats: the keys differ in the lowest digit only, so the upper passes are skipped
+    std::vector<float> neighbours(3000);
+    for (size_t i = 0; i < neighbours.size(); ++i) {
+        neighbours[i] = 1.0f + static_cast<float>(Random(state, 2048)) * std::numeric_limits<float>::epsilon();
+    }
+    TestDepths(sorter, neighbours, "depths that differ in the lowest digit");
+
+    // large random depths after the larger calls: the scratch buffers shrink with the count
+    std::vector<float> spread(100000);
+    for (float& depth : spread) {
+        depth = (static_cast<float>(Random(state, 1u << 20)) - static_cast<float>(1u << 19)) / 1024.0f;
+    }
+    TestDepths(sorter, spread, "100000 walls");
+    TestDepths(sorter, { -1.0f, 1.0f }, "two walls after many");
+
+    if (failures > 0) {
+        std::cerr << failures << " depth sort checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All depth sort checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+// Checks the software occlusion culler without a GPU: what an occluder hides, and that the
+// rasteriser gives the same depth buffer on one thread and split into bands.
+#include "OcclusionCuller.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+    int failures = 0;
+
+    void Check(bool condition, const char* description)
+    {
+        if (!condition) {
+            std::cerr << "FAILED: " << description << std::endl;
+            failures++;
+        }
+    }
+
+    // camera on the +z axis looking at the origin
+    glm::mat4 ViewProjection()
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return projection * view;
+    }
+
+    void TestSingleOccluder()
+    {
+        OcclusionCuller culler(128, 128, 1);
+        culler.Begin(ViewProjection());
+        culler.AddOccluder(glm::vec3(0.0f), glm::vec3(1.0f));
+        culler.Rasterize();
+
+        Check(!culler.IsVisible(glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(0.5f)), "a box directly behind the occluder is hidden");
+        Check(culler.IsVisible(glm::vec3(4.0f, 0.0f, 0.0f), glm::vec3(0.5f)), "a box beside the occluder is visible");
+        Check(culler.IsVisible(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.5f)), "a box in front of the occluder is visible");
+        Check(culler.IsVisible(glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(2.0f)), "a box larger than the occluder is visible");
+        Check(!culler.IsVisible(glm::vec3(30.0f, 0.0f, 0.0f), glm::vec3(0.5f)), "a box outside the view is culled");
+        Check(culler.IsVisible(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.5f)), "a box crossing the camera plane is visible");
+    }
+
+    void TestBandsMatchSingleThread()
+    {
+        OcclusionCuller single(128, 128, 1);
+        OcclusionCuller banded(128, 128, 4);
+        banded.SetMinTrianglesPerThread(1);
+        for (OcclusionCuller* culler : { &single, &banded }) {
+            culler->Begin(ViewProjection());
+            for (int x = -3; x <= 3; ++x) {
+                for (int y = -3; y <= 3; ++y) {
+                    culler->AddOccluder(glm::vec3(x * 1.3f, y * 1.3f, (x + y) * 0.25f), glm::vec3(0.4f, 0.45f, 0.5f));
+                }
+            }
+            culler->Rasterize();
+        }
+
+        Check(single.GetDepthBuffer() == banded.GetDepthBuffer(), "the banded depth buffer equals the single threaded one");
+        bool sameVisibility = true;
+        for (int x = -4; x <= 4; ++x) {
+            for (int y = -4; y <= 4; ++y) {
+                glm::vec3 center(x * 1.3f, y * 1.3f, -2.0f);
+                sameVisibility = sameVisibility && single.IsVisible(center, glm::vec3(0.3f)) == banded.IsVisible(center, glm::vec3(0.3f));
+            }
+        }
+        Check(sameVisibility, "the banded and single threaded buffers cull the same boxes");
+    }
+}
+
+int main()
+{
+    TestSingleOccluder();
+    TestBandsMatchSingleThread();
+    if (failures > 0) {
+        std::cerr << failures << " occlusion culler checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All occlusion culler checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
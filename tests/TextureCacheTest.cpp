@@ -0,0 +1,159 @@
+// Checks the texture cache without a GPU: texture array layers that miss the cache are handed
+// back for storing, once stored the next start finds every layer cached, and entries whose
+// level table does not match the data are rejected.
+#include "TextureManager.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void Check(bool condition, const char* description)
+    {
+        if (!condition) {
+            std::cerr << "FAILED: " << description << std::endl;
+            failures++;
+        }
+    }
+
+    // binary PPM with a gradient, read by stb_image like the PNG textures
+    std::string WriteImage(const std::filesystem::path& directory, const std::string& name, int width, int height, int seed)
+    {
+        std::string path = (directory / name).string();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "P6\n" << width << " " << height << "\n255\n";
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                unsigned char rgb[3] = { static_cast<unsigned char>(x * 30 + seed), static_cast<unsigned char>(y * 30),
+                                         static_cast<unsigned char>(seed * 7) };
+                file.write(reinterpret_cast<const char*>(rgb), sizeof(rgb));
+            }
+        }
+        return path;
+    }
+
+    std::vector<unsigned char> BaseLevel(const TextureCache::Image& image)
+    {
+        const TextureCache::MipLevel& level = image.Levels[0];
+        return std::vector<unsigned char>(level.Data, level.Data + level.Size);
+    }
+
+    void TestArrayLayersAreCachedOnTheSecondStart(const std::filesystem::path& directory)
+    {
+        std::vector<std::string> paths = { WriteImage(directory, "first.ppm", 8, 8, 1),
+                                           WriteImage(directory, "second.ppm", 4, 4, 2) };
+
+        std::vector<std::vector<unsigned char>> firstStart;
+        {
+            TextureManager::DecodedArray decoded = TextureManager::DecodeArray(paths, true, false);
+            Check(decoded.valid, "the array is decoded");
+            Check(decoded.cachedLayers == 0, "no layer is cached on the first start");
+            Check(decoded.uncached.size() == 2, "both layers are handed back for storing");
+            Check(decoded.layers.size() == 2 && decoded.layers[1].Levels[0].Width == 8 && decoded.layers[1].Levels[0].Height == 8,
+                  "the smaller layer is resampled to the size of the first");
+            Check(!decoded.layers.empty() && decoded.layers[0].Levels.size() == 4, "the layers have a mip chain");
+            for (const auto& layer : decoded.layers) {
+                firstStart.push_back(BaseLevel(layer));
+            }
+            // what UploadAndStore does once the driver compressed them
+            for (const auto& layer : decoded.uncached) {
+                Check(layer.image.Levels[0].Width == (layer.filePath == paths[0] ? 8 : 4), "layers are stored at the size of their source");
+                Check(TextureCache::Write(layer.filePath, layer.sourceHash, layer.image), "the cache entry is written");
+            }
+        }
+
+        TextureManager::DecodedArray decoded = TextureManager::DecodeArray(paths, true, false);
+        Check(decoded.valid, "the cached array is decoded");
+        Check(decoded.cachedLayers == 2, "both layers are cached on the second start");
+        Check(decoded.uncached.empty(), "nothing is stored again on the second start");
+        bool sameLayers = decoded.layers.size() == firstStart.size();
+        for (size_t i = 0; sameLayers && i < firstStart.size(); ++i) {
+            sameLayers = BaseLevel(decoded.layers[i]) == firstStart[i];
+        }
+        Check(sameLayers, "the cached layers match the decoded ones");
+
+        // editing a source invalidates its entry only
+        WriteImage(directory, "second.ppm", 4, 4, 3);
+        decoded = TextureManager::DecodeArray(paths, true, false);
+        Check(decoded.cachedLayers == 1 && decoded.uncached.size() == 1 && decoded.uncached[0].filePath == paths[1],
+              "an edited layer misses the cache");
+    }
+
+    // level table entry i of a cache file: width, height, size, offset (after the 32 byte header)
+    void PatchLevel(const std::string& cachePath, size_t level, size_t field, uint32_t value)
+    {
+        std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(32 + level * 16 + field * 4);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void TestCorruptEntriesAreRejected(const std::filesystem::path& directory)
+    {
+        std::string path = WriteImage(directory, "corrupt.ppm", 8, 4, 5);
+        std::string cachePath = path + ".texcache";
+        uint64_t hash = TextureCache::HashFile(path);
+        TextureCache::Image source;
+        Check(TextureCache::Build(path, true, source) && source.Levels.size() == 4, "the source is built with its mip chain");
+
+        auto loads = [&]() {
+            TextureCache::Image image;
+            return TextureCache::Load(path, hash, true, image);
+        };
+        auto rewrite = [&]() {
+            Check(TextureCache::Write(path, hash, source), "the cache entry is written");
+        };
+
+        rewrite();
+        Check(loads(), "an intact entry is loaded");
+
+        PatchLevel(cachePath, 0, 2, 8 * 4 * 4 + 4);
+        Check(!loads(), "a level larger than its size is rejected");
+        rewrite();
+        PatchLevel(cachePath, 0, 0, 16);
+        Check(!loads(), "a base level wider than its data is rejected");
+        rewrite();
+        PatchLevel(cachePath, 2, 0, 3);
+        PatchLevel(cachePath, 2, 2, 3 * 1 * 4);
+        Check(!loads(), "a mip level that is not half of the one before is rejected");
+        rewrite();
+        PatchLevel(cachePath, 3, 3, 1u << 30);
+        Check(!loads(), "a level past the end of the file is rejected");
+        rewrite();
+        std::filesystem::resize_file(cachePath, std::filesystem::file_size(cachePath) - 1);
+        Check(!loads(), "a truncated entry is rejected");
+
+        // the RGBA8 levels marked as BC7 blocks do not have the BC7 sizes
+        rewrite();
+        {
+            std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+            uint32_t format[2] = { GL_COMPRESSED_RGBA_BPTC_UNORM, 1 };
+            file.seekp(16);
+            file.write(reinterpret_cast<const char*>(format), sizeof(format));
+        }
+        Check(!loads(), "levels whose size does not match the format are rejected");
+    }
+}
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "texture_cache_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    TestArrayLayersAreCachedOnTheSecondStart(directory);
+    TestCorruptEntriesAreRejected(directory);
+
+    std::filesystem::remove_all(directory);
+    if (failures > 0) {
+        std::cerr << failures << " texture cache checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All texture cache checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+// Checks the vertex stream kernels against a plain glm implementation: positions, normals and
+// bounds for tightly packed (12 byte) and interleaved (28 byte) vertices, small meshes that end in
+// the tail of the SIMD loops and meshes large enough to be split into chunks on several threads.
+// The executable is built once per kernel variant (see CMakeLists.txt).
+#include "VertexStreams.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void Check(bool condition, const std::string& description)
+    {
+        if (!condition) {
+            std::cerr << "FAILED: " << description << std::endl;
+            failures++;
+        }
+    }
+
+    bool Near(const glm::vec3& value, const glm::vec3& expected)
+    {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (std::fabs(value[axis] - expected[axis]) > 1e-4f * std::max(1.0f, std::fabs(expected[axis]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // deterministic values in [-range, range]
+    float Random(uint32_t& state, float range)
+    {
+        state = state * 1664525u + 1013904223u;
+        return (static_cast<float>(state >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f) * range;
+    }
+
+    glm::vec3 Read(const std::vector<uint8_t>& vertices, size_t offset)
+    {
+        float xyz[3];
+        std::memcpy(xyz, vertices.data() + offset, sizeof(xyz));
+        return glm::vec3(xyz[0], xyz[1], xyz[2]);
+    }
+
+    // count vertices laid out by layout: positions and normals are random, every other byte is a marker
+    // that the kernels must leave alone
+    std::vector<uint8_t> MakeVertices(const BufferLayout& layout, size_t count, uint32_t seed)
+    {
+        std::vector<uint8_t> vertices(static_cast<size_t>(layout.GetStride()) * count, 0xAB);
+        for (size_t i = 0; i < count; ++i) {
+            for (const BufferAttribute& attribute : layout) {
+                if (attribute.Type != ShaderDataType::Float3) {
+                    continue;
+                }
+                float xyz[3] = { Random(seed, 50.0f), Random(seed, 50.0f), Random(seed, 50.0f) };
+                std::memcpy(vertices.data() + i * layout.GetStride() + attribute.Offset, xyz, sizeof(xyz));
+            }
+        }
+        return vertices;
+    }
+
+    void TestLayout(const BufferLayout& layout, size_t count, const std::string& name)
+    {
+        glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, -2.0f, 7.5f))
+                         * glm::rotate(glm::mat4(1.0f), 0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, -0.5f)))
+                         * glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 0.5f, 1.25f));
+        glm::mat3 normalMatrix = glm::inverse(glm::transpose(glm::mat3(matrix)));
+
+        std::vector<uint8_t> source = MakeVertices(layout, count, static_cast<uint32_t>(count));
+        std::vector<uint8_t> vertices = source;
+        Check(VertexStreams::TransformMesh(vertices.data(), count, layout, matrix), "the mesh has a position stream");
+
+        size_t positionOffset = 0, normalOffset = 0;
+        bool hasNormal = false;
+        for (const BufferAttribute& attribute : layout) {
+            if (attribute.Name == "position") positionOffset = attribute.Offset;
+            if (attribute.Name == "normal") { normalOffset = attribute.Offset; hasNormal = true; }
+        }
+
+        bool positions = true, normals = true, untouched = true;
+        glm::vec3 lower(std::numeric_limits<float>::max()), upper(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < count; ++i) {
+            size_t vertex = i * layout.GetStride();
+            glm::vec3 position = Read(vertices, vertex + positionOffset);
+            positions = positions && Near(position, glm::vec3(matrix * glm::vec4(Read(source, vertex + positionOffset), 1.0f)));
+            lower = glm::min(lower, position);
+            upper = glm::max(upper, position);
+            if (hasNormal) {
+                glm::vec3 normal = normalMatrix * Read(source, vertex + normalOffset);
+                normals = normals && Near(Read(vertices, vertex + normalOffset), glm::normalize(normal));
+            }
+            for (size_t byte = 0; byte < static_cast<size_t>(layout.GetStride()); ++byte) {
+                bool written = (byte >= positionOffset && byte < positionOffset + 12)
+                            || (hasNormal && byte >= normalOffset && byte < normalOffset + 12);
+                untouched = untouched && (written || vertices[vertex + byte] == 0xAB);
+            }
+        }
+        Check(positions, name + ": the positions match matrix * position");
+        Check(normals, name + ": the normals match the normalized inverse transpose");
+        Check(untouched, name + ": the bytes between the streams are left alone");
+
+        VertexStream stream;
+        Check(VertexStreams::GetStream(vertices.data(), count, layout, "position", stream), name + ": the position stream is found");
+        glm::vec3 min, max;
+        VertexStreams::ComputeBounds(stream, min, max);
+        Check(min == lower && max == upper, name + ": the bounds equal the brute force AABB");
+    }
+
+    void TestEmptyBounds()
+    {
+        VertexStream empty;
+        glm::vec3 min, max;
+        VertexStreams::ComputeBounds(empty, min, max);
+        Check(min.x > max.x && min.y > max.y && min.z > max.z, "an empty stream has min > max");
+    }
+}
+
+int main()
+{
+#if defined(__AVX__) && (defined(__GNUC__) || defined(__clang__))
+    if (!__builtin_cpu_supports("avx")) {
+        std::cout << "No AVX on this CPU, the AVX kernels are not checked" << std::endl;
+        return EXIT_SUCCESS;
+    }
+#endif
+    BufferLayout packed = { { ShaderDataType::Float3, "position" } };
+    BufferLayout interleaved = { { ShaderDataType::Float3, "position" },
+                                 { ShaderDataType::Float3, "normal" },
+                                 { ShaderDataType::Float, "u" } };
+    Check(packed.GetStride() == 12 && interleaved.GetStride() == 28, "the layouts have strides of 12 and 28 bytes");
+
+    // 1 and 2 vertices: only the tail; 7: a few SIMD iterations and a tail
+    for (size_t count : { size_t(1), size_t(2), size_t(7) }) {
+        TestLayout(packed, count, "packed, few vertices");
+        TestLayout(interleaved, count, "interleaved, few vertices");
+    }
+    // split into chunks whose ends are not multiples of the SIMD width
+    size_t large = 2 * VertexStreams::MinVerticesPerThread + 3;
+    if (std::thread::hardware_concurrency() < 2) {
+        std::cout << "One hardware thread, large meshes run as a single chunk" << std::endl;
+    }
+    TestLayout(packed, large, "packed, several chunks");
+    TestLayout(interleaved, large, "interleaved, several chunks");
+    TestEmptyBounds();
+
+    if (failures > 0) {
+        std::cerr << failures << " vertex stream checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All vertex stream checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}